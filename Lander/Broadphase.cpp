@@ -0,0 +1,218 @@
+#include "stdafx.h"
+#include "Broadphase.hpp"
+
+namespace Lander {
+
+namespace {
+
+/** True if both rectangles overlap or touch (unlike Rectangle::Intersects(), this also detects crossing rectangles).
+ *  Without branches: whether two colliders overlap is hard to predict, mispredicted branches took most of the time of a Query().
+ */
+bool Overlap(const Rectangle& a, const Rectangle& b) {
+  return (a.topLeft.x <= b.bottomRight.x) & (b.topLeft.x <= a.bottomRight.x)
+       & (a.topLeft.y <= b.bottomRight.y) & (b.topLeft.y <= a.bottomRight.y);
+}
+
+}
+
+Broadphase::Broadphase(float cellSize, float margin) : cellSize(cellSize), margin(margin) {
+  Rehash();
+}
+
+void Broadphase::Add(Collider& collider) {
+  assert(collider.broadphaseEntry < 0);
+  collider.broadphaseEntry = static_cast<int32_t>(entries.size());
+  entries.push_back({ &collider, Rectangle(), collider.pos, collider.size, collider.rotation });
+  Register(static_cast<uint32_t>(collider.broadphaseEntry), collider.WorldBounds());
+
+  if (2 * entries.size() > buckets.size()) {
+    Rehash();
+  }
+}
+
+void Broadphase::Update(Collider& collider) {
+  const Entry& entry = entries[static_cast<uint32_t>(collider.broadphaseEntry)];
+  if (collider.pos.x == entry.pos.x && collider.pos.y == entry.pos.y && collider.rotation == entry.rotation
+   && collider.size.width == entry.size.width && collider.size.height == entry.size.height) {
+    return; // hasn't changed since the last update (most colliders don't move at all)
+  }
+  Update(collider, collider.WorldBounds());
+}
+
+void Broadphase::Update(Collider& collider, const Rectangle& bounds) {
+  const uint32_t index = static_cast<uint32_t>(collider.broadphaseEntry);
+  assert(index < entries.size() && entries[index].collider == &collider);
+
+  Entry& entry = entries[index];
+  entry.pos = collider.pos;
+  entry.size = collider.size;
+  entry.rotation = collider.rotation;
+  if (entry.bounds.Contains(bounds)) {
+    return; // still inside the grown bounds -> nothing to do
+  }
+
+  Unregister(index);
+  Register(index, bounds);
+}
+
+const std::vector<Collider*>& Broadphase::Query(const Rectangle& bounds) {
+  foundEntries.clear();
+
+  CellRange range = Cells(bounds);
+  if (range.valid) {
+    for (auto index : largeEntries) {
+      if (Overlap(entries[index].bounds, bounds)) {
+        foundEntries.emplace_back(index, entries[index].collider);
+      }
+    }
+    for (int32_t y = range.minY; y <= range.maxY; ++y) {
+      for (int32_t x = range.minX; x <= range.maxX; ++x) {
+        // Every item is written, but only kept if it overlaps (no branch)
+        const auto& items = buckets[Bucket(x, y)];
+        size_t found = foundEntries.size();
+        foundEntries.resize(found + items.size());
+        for (auto& item : items) {
+          foundEntries[found] = { item.index, item.collider };
+          found += Overlap(item.bounds, bounds);
+        }
+        foundEntries.resize(found);
+      }
+    }
+    // Entries, which cover several of the cells, have been found several times
+    std::sort(foundEntries.begin(), foundEntries.end());
+    foundEntries.erase(std::unique(foundEntries.begin(), foundEntries.end()), foundEntries.end());
+  } else {
+    // Too large to look at the cells -> check all entries (already in order)
+    for (uint32_t index = 0; index < entries.size(); ++index) {
+      if (Overlap(entries[index].bounds, bounds)) {
+        foundEntries.emplace_back(index, entries[index].collider);
+      }
+    }
+  }
+
+  candidates.clear();
+  for (auto& found : foundEntries) {
+    candidates.push_back(found.second);
+  }
+  return candidates;
+}
+
+void Broadphase::CandidatePairs(std::vector<std::pair<Collider*, Collider*>>& pairs) const {
+  std::vector<std::pair<uint32_t, uint32_t>> indices;
+
+  for (uint32_t bucket = 0; bucket < buckets.size(); ++bucket) {
+    const auto& items = buckets[bucket];
+    for (size_t i = 0; i < items.size(); ++i) {
+      for (size_t j = i + 1; j < items.size(); ++j) {
+        if (items[i].index == items[j].index || !Overlap(items[i].bounds, items[j].bounds)) {
+          continue;
+        }
+        // Two entries share all cells their overlap covers -> only report the pair in the bucket of the overlap's top left cell
+        const Entry& a = entries[items[i].index];
+        const Entry& b = entries[items[j].index];
+        if (Bucket(std::max(a.minCellX, b.minCellX), std::max(a.minCellY, b.minCellY)) == bucket) {
+          indices.push_back(std::minmax(items[i].index, items[j].index));
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < largeEntries.size(); ++i) {
+    const Entry& large = entries[largeEntries[i]];
+    for (uint32_t index = 0; index < entries.size(); ++index) {
+      const Entry& other = entries[index];
+      // Pairs of two large entries are found from the one added first
+      if (index != largeEntries[i] && (!other.large || index > largeEntries[i]) && Overlap(large.bounds, other.bounds)) {
+        indices.push_back(std::minmax(largeEntries[i], index));
+      }
+    }
+  }
+
+  // An entry can be in a bucket several times (if some of its cells share the bucket)
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+  pairs.clear();
+  for (auto& pair : indices) {
+    pairs.emplace_back(entries[pair.first].collider, entries[pair.second].collider);
+  }
+}
+
+Broadphase::CellRange Broadphase::Cells(const Rectangle& bounds) const {
+  CellRange range = {};
+  float minX = std::floor(bounds.topLeft.x / cellSize), minY = std::floor(bounds.topLeft.y / cellSize);
+  float maxX = std::floor(bounds.bottomRight.x / cellSize), maxY = std::floor(bounds.bottomRight.y / cellSize);
+  const float LIMIT = 1e9f; // keeps the cell coordinates within int32_t
+  if (!(minX >= -LIMIT && maxX <= LIMIT && minY >= -LIMIT && maxY <= LIMIT)) { // also false for NaN
+    return range;
+  }
+
+  range.minX = static_cast<int32_t>(minX);
+  range.minY = static_cast<int32_t>(minY);
+  range.maxX = static_cast<int32_t>(maxX);
+  range.maxY = static_cast<int32_t>(maxY);
+  range.valid = (static_cast<int64_t>(range.maxX) - range.minX + 1) * (static_cast<int64_t>(range.maxY) - range.minY + 1) <= MAX_CELLS_PER_ENTRY;
+  return range;
+}
+
+uint32_t Broadphase::Bucket(int32_t x, int32_t y) const {
+  return ((static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u)) & bucketMask;
+}
+
+void Broadphase::Rehash() {
+  // About two buckets per entry to keep the chance of sharing a bucket low
+  uint32_t bucketCount = 1024;
+  while (bucketCount < 2 * entries.size()) {
+    bucketCount *= 2;
+  }
+
+  buckets.assign(bucketCount, {});
+  bucketMask = bucketCount - 1;
+  largeEntries.clear();
+  for (uint32_t index = 0; index < entries.size(); ++index) {
+    Insert(index);
+  }
+}
+
+void Broadphase::Register(uint32_t index, const Rectangle& bounds) {
+  entries[index].bounds = Rectangle(bounds.topLeft - Vector(margin, margin), bounds.bottomRight + Vector(margin, margin));
+  Insert(index);
+}
+
+void Broadphase::Insert(uint32_t index) {
+  Entry& entry = entries[index];
+  CellRange range = Cells(entry.bounds);
+  entry.large = !range.valid;
+  if (entry.large) {
+    largeEntries.push_back(index);
+    return;
+  }
+
+  entry.minCellX = range.minX;
+  entry.minCellY = range.minY;
+  entry.maxCellX = range.maxX;
+  entry.maxCellY = range.maxY;
+  for (int32_t y = range.minY; y <= range.maxY; ++y) {
+    for (int32_t x = range.minX; x <= range.maxX; ++x) {
+      buckets[Bucket(x, y)].push_back({ entry.collider, entry.bounds, index });
+    }
+  }
+}
+
+void Broadphase::Unregister(uint32_t index) {
+  Entry& entry = entries[index];
+  if (entry.large) {
+    largeEntries.erase(std::find(largeEntries.begin(), largeEntries.end(), index));
+    return;
+  }
+
+  for (int32_t y = entry.minCellY; y <= entry.maxCellY; ++y) {
+    for (int32_t x = entry.minCellX; x <= entry.maxCellX; ++x) {
+      auto& items = buckets[Bucket(x, y)];
+      // The order within a bucket doesn't matter, Query() sorts its results
+      *std::find_if(items.begin(), items.end(), [index](const BucketItem& item) { return item.index == index; }) = items.back();
+      items.pop_back();
+    }
+  }
+}
+
+}
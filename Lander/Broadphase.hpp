@@ -0,0 +1,119 @@
+#pragma once
+
+namespace Lander {
+
+class Collider;
+
+/** A uniform grid over the world bounds of all colliders (see Collider::WorldBounds()), which returns the candidates for
+ *  collisions with a given area instead of every collider of the world. Each collider is registered in all cells its bounds
+ *  overlap. The bounds are grown by a margin, so a moving collider only has to be registered again when it left them.
+ *  The grid is unbounded: the cells are hashed into a table of buckets, which grows with the number of colliders.
+ *  Colliders with unbounded or very large bounds (e.g. the Terrain) aren't put into cells, but are candidates for every query.
+ *
+ *  All candidates are returned in the order the colliders have been added, so the collision checks and thus the simulation
+ *  stay deterministic.
+ */
+class Broadphase {
+public:
+  static constexpr float DEFAULT_CELL_SIZE = 64;
+  static constexpr float DEFAULT_MARGIN = 4;
+
+  /** @param cellSize the width and height of each grid cell
+   *  @param margin the distance each collider can move before it has to be registered in the grid again
+   */
+  explicit Broadphase(float cellSize = DEFAULT_CELL_SIZE, float margin = DEFAULT_MARGIN);
+
+  Broadphase(const Broadphase&) = delete;
+  Broadphase& operator=(const Broadphase&) = delete;
+
+  /** Registers the collider with its current bounds. A collider can only be added to one broadphase.
+   */
+  void Add(Collider& collider);
+
+  /** Moves the collider in the grid, if its bounds left the bounds it has been registered with.
+   *  Must be called whenever the collider moved or changed its size or rotation.
+   */
+  void Update(Collider& collider);
+
+  /** Same as Update(collider) with the collider's current WorldBounds()
+   */
+  void Update(Collider& collider, const Rectangle& bounds);
+
+  /** Returns all colliders, whose (grown) bounds overlap the given bounds, in the order they have been added.
+   *  The returned list is only valid until the next call of Query().
+   */
+  const std::vector<Collider*>& Query(const Rectangle& bounds);
+
+  /** Collects all pairs of colliders, whose (grown) bounds overlap, each pair once, ordered by the order the colliders have been added.
+   */
+  void CandidatePairs(std::vector<std::pair<Collider*, Collider*>>& pairs) const;
+
+  /** Returns the number of registered colliders
+   */
+  size_t Size() const { return entries.size(); }
+
+private:
+  // Bounds, which cover more cells than this, are treated as unbounded (a query with them checks all entries)
+  static const int64_t MAX_CELLS_PER_ENTRY = 256;
+
+  struct Entry {
+    Collider* collider;
+    Rectangle bounds; // the collider's bounds grown by the margin when it has been registered
+
+    // The state of the collider, when it has been checked last: the bounds only change, if one of them changes
+    Vector pos;
+    Lander::Size size;
+    float rotation;
+
+    int32_t minCellX, minCellY, maxCellX, maxCellY;
+    bool large; // in largeEntries instead of the cells
+  };
+
+  // An entry in a bucket (with a copy of its bounds and collider, so a query doesn't have to look up each entry)
+  struct BucketItem {
+    Collider* collider;
+    Rectangle bounds;
+    uint32_t index;
+  };
+
+  struct CellRange {
+    int32_t minX, minY, maxX, maxY;
+    bool valid; // false if the bounds aren't finite or cover more than MAX_CELLS_PER_ENTRY cells
+  };
+
+  CellRange Cells(const Rectangle& bounds) const;
+
+  /** Returns the bucket of the given cell. Different cells may share a bucket, the queries check the bounds anyway.
+   */
+  uint32_t Bucket(int32_t x, int32_t y) const;
+
+  /** Resizes the table of buckets for the current number of entries and registers all entries again
+   */
+  void Rehash();
+
+  /** Grows the given bounds by the margin and puts the entry into the cells (or the large entries) they cover
+   */
+  void Register(uint32_t index, const Rectangle& bounds);
+
+  /** Puts the entry into the cells (or the large entries) its current bounds cover
+   */
+  void Insert(uint32_t index);
+
+  /** Removes the entry from its cells (or the large entries)
+   */
+  void Unregister(uint32_t index);
+
+  const float cellSize;
+  const float margin;
+
+  std::vector<Entry> entries; // in the order the colliders have been added
+  std::vector<std::vector<BucketItem>> buckets; // the entries in the cells of each bucket
+  uint32_t bucketMask = 0; // number of buckets - 1 (a power of 2)
+  std::vector<uint32_t> largeEntries;
+
+  // Scratch buffers of Query()
+  std::vector<std::pair<uint32_t, Collider*>> foundEntries; // index and collider
+  std::vector<Collider*> candidates;
+};
+
+}
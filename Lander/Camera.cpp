@@ -14,10 +14,11 @@ const Lander::Rectangle& Lander::Camera::GetVisibleRect() const {
   return visibleRect;
 }
 
-void Lander::Camera::TrackObject(ViewObject& object, double secondsSinceLastUpdate) {
+void Lander::Camera::TrackObject(ViewObject& object, double secondsSinceLastUpdate, float tickProgress) {
   // Try to keep the tracked object somehow in the camera's view
+  auto objectPos = object.InterpolatedPos(tickProgress);
 
-  Rectangle objectRect(object.pos, object.size);
+  Rectangle objectRect(objectPos, object.size);
 
   auto screenTopLeft10Percent = screenRect.topLeft + Vector::Down * screenRect.Size().height * 0.1f;
 
@@ -30,7 +31,7 @@ void Lander::Camera::TrackObject(ViewObject& object, double secondsSinceLastUpda
 
   // object is above upper 10% of the screen -> move camera there
   auto cameraTopLeft10Percent = visibleRect.topLeft + Vector::Down * visibleRect.Size().height * 0.1f;
-  visibleRect += Vector::Up * (cameraTopLeft10Percent - object.pos).y;
+  visibleRect += Vector::Up * (cameraTopLeft10Percent - objectPos).y;
 
 
 }
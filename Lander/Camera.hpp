@@ -22,8 +22,10 @@ public:
   const Rectangle& GetVisibleRect() const;
 
   /** The camera will track the given view object to always keep it in view.
+   *
+   * @param tickProgress passed fraction of the current physics tick to track the object's interpolated position (see ViewObject::InterpolatedPos())
    */
-  void TrackObject(ViewObject& object, double secondsSinceLastUpdate);
+  void TrackObject(ViewObject& object, double secondsSinceLastUpdate, float tickProgress = 1.0f);
 
 
  private:
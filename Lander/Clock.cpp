@@ -0,0 +1,68 @@
+#include "stdafx.h"
+#include "Clock.hpp"
+
+namespace Lander {
+
+Clock::time_point RealTimeClock::Now() const {
+  return time_point(std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()));
+}
+
+void RealTimeClock::WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) {
+  auto steadyTime = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(time.time_since_epoch()));
+  wakeup.wait_until(lock, steadyTime, stopWaiting);
+}
+
+
+FixedStepClock::FixedStepClock(duration step) : step(step), nanoSeconds(0) {}
+
+Clock::time_point FixedStepClock::Now() const {
+  return time_point(duration(nanoSeconds.load()));
+}
+
+void FixedStepClock::WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) {
+  // Register without holding the waiter's mutex to keep the lock order of NextFrame()
+  lock.unlock();
+  {
+    std::lock_guard<std::mutex> waitersLock(waitersMutex);
+    waiters.push_back({ &wakeup, lock.mutex() });
+  }
+  lock.lock();
+
+  // NextFrame() advances the time before notifying the waiters under their mutex, so no step can get lost
+  wakeup.wait(lock, [&]() { return Now() >= time || stopWaiting(); });
+
+  lock.unlock();
+  {
+    std::lock_guard<std::mutex> waitersLock(waitersMutex);
+    waiters.erase(std::find_if(waiters.begin(), waiters.end(), [&](const Waiter& waiter) { return waiter.wakeup == &wakeup; }));
+  }
+  lock.lock();
+}
+
+void FixedStepClock::NextFrame() {
+  nanoSeconds += step.count();
+
+  std::lock_guard<std::mutex> waitersLock(waitersMutex);
+  for (auto& waiter : waiters) {
+    std::lock_guard<std::mutex> lock(*waiter.mutex);
+    waiter.wakeup->notify_all();
+  }
+}
+
+
+Clock::time_point AsFastAsPossibleClock::Now() const {
+  return time_point(duration(nanoSeconds.load()));
+}
+
+void AsFastAsPossibleClock::WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) {
+  if (stopWaiting()) {
+    return;
+  }
+
+  // Jump to the requested time (the clock never goes back, if several threads wait concurrently)
+  auto target = time.time_since_epoch().count();
+  auto current = nanoSeconds.load();
+  while (current < target && !nanoSeconds.compare_exchange_weak(current, target)) {}
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Lander {
+
+/** The source of time for the game loop and the simulation thread. The game owns one clock and every part, which
+ *  measures or waits for time, uses it instead of reading std::chrono::steady_clock directly. This allows to run the
+ *  game on virtual time, e.g. to drive it with a fixed step per frame or as fast as possible in headless tests.
+ */
+class Clock {
+public:
+  using duration = std::chrono::nanoseconds;
+  using time_point = std::chrono::time_point<Clock, duration>;
+
+  virtual ~Clock() = default;
+
+  /** Returns the current time of this clock
+   */
+  virtual time_point Now() const = 0;
+
+  /** Blocks the calling thread until the clock reaches the given time or the condition variable is notified and
+   *  stopWaiting returns true (like std::condition_variable::wait_until() with a predicate).
+   *
+   * @param lock the locked lock of the mutex, which guards the state stopWaiting checks
+   */
+  virtual void WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) = 0;
+
+  /** Called by the game once at the beginning of every frame
+   */
+  virtual void NextFrame() {}
+};
+
+
+/** The wall clock (std::chrono::steady_clock)
+ */
+class RealTimeClock : public Clock {
+public:
+  virtual time_point Now() const override;
+
+  virtual void WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) override;
+};
+
+
+/** A virtual clock, which advances by a fixed step on every frame, no matter how long the frame actually took.
+ *  Threads waiting for a later time are woken up by NextFrame().
+ */
+class FixedStepClock : public Clock {
+public:
+  explicit FixedStepClock(duration step);
+
+  virtual time_point Now() const override;
+
+  virtual void WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) override;
+
+  /** Advances the clock by one step and wakes up all waiting threads
+   */
+  virtual void NextFrame() override;
+
+private:
+  struct Waiter {
+    std::condition_variable* wakeup;
+    std::mutex* mutex;
+  };
+
+  const duration step;
+  std::atomic<int64_t> nanoSeconds;
+
+  std::mutex waitersMutex; // always locked before the mutex of a waiter
+  std::vector<Waiter> waiters;
+};
+
+
+/** A virtual clock, which never waits: waiting for a later time advances the clock to that time right away.
+ *  A simulation thread using this clock runs its ticks back to back as fast as the CPU allows.
+ */
+class AsFastAsPossibleClock : public Clock {
+public:
+  virtual time_point Now() const override;
+
+  virtual void WaitUntil(time_point time, std::condition_variable& wakeup, std::unique_lock<std::mutex>& lock, const std::function<bool()>& stopWaiting) override;
+
+private:
+  std::atomic<int64_t> nanoSeconds = 0;
+};
+
+}
@@ -1,10 +1,24 @@
 #include "stdafx.h"
-#include "Game.hpp"
+#include "World.hpp"
 
 #include <array>
 
 namespace Lander {
 
+namespace {
+
+const int MAX_SWEEP_STEPS = 1024; // faster movements are sampled more coarsely
+const int BISECTION_STEPS = 16;   // the time of impact is exact to 1/65536 of a step
+
+/** True if both rectangles overlap or touch
+ */
+bool Overlap(const Rectangle& a, const Rectangle& b) {
+  return a.topLeft.x <= b.bottomRight.x && b.topLeft.x <= a.bottomRight.x
+      && a.topLeft.y <= b.bottomRight.y && b.topLeft.y <= a.bottomRight.y;
+}
+
+}
+
 /** Checks whether the given point is inside the rectangle of this object(pos, size)
  *  this check can be skipped if the point is outside this object's radius.
  */
@@ -26,31 +40,153 @@ bool Collider::IsPointInside(Vector worldPoint) const {
 }
 
 
+Rectangle Collider::WorldBounds() const {
+  Rectangle rect(Vector::Zero, size);
+  std::array<Vector, 4> corners = { rect.topLeft, rect.TopRight(), rect.BottomLeft(), rect.bottomRight };
+  TransformPoints(ObjectToWorldTransform(), corners.data(), corners.data(), corners.size());
+
+  Rectangle bounds(corners[0], corners[0]);
+  for (auto& corner : corners) {
+    bounds.topLeft = Vector(std::min(bounds.topLeft.x, corner.x), std::min(bounds.topLeft.y, corner.y));
+    bounds.bottomRight = Vector(std::max(bounds.bottomRight.x, corner.x), std::max(bounds.bottomRight.y, corner.y));
+  }
+  return bounds;
+}
+
+
+float Collider::Clearance(const Rectangle& rect, float maxDistance) const {
+  const Rectangle bounds = WorldBounds();
+  const float dx = std::max({ bounds.topLeft.x - rect.bottomRight.x, rect.topLeft.x - bounds.bottomRight.x, 0.0f });
+  const float dy = std::max({ bounds.topLeft.y - rect.bottomRight.y, rect.topLeft.y - bounds.bottomRight.y, 0.0f });
+  return std::min(std::sqrt(dx * dx + dy * dy), maxDistance);
+}
+
+
 void Collider::CheckCollisions() {
+  // This object may have moved since the last check
+  Broadphase& broadphase = world->GetBroadphase();
+  Rectangle bounds = WorldBounds();
+  broadphase.Update(*this, bounds);
+  CheckCollisions(broadphase.Query(bounds));
+}
+
+void Collider::CheckCollisions(const Motion& motion) {
+  CheckCollisions(motion, world->GetBroadphase().Query(SweptBounds(motion)));
+}
+
+void Collider::CheckCollisions(const Motion& motion, const std::vector<Collider*>& colliders) {
+  const Rectangle sweptBounds = SweptBounds(motion);
+  const float travel = motion.MaxTravel(Center().Length());
+
+  Collider* firstHit = nullptr;
+  ContactManifold firstContact;
+  ContactManifold contact;
+  for (auto collider : colliders) {
+    if (collider == this || !Overlap(sweptBounds, collider->WorldBounds())) {
+      continue;
+    }
+
+    const float thickness = std::min({ size.width, size.height, collider->size.width, collider->size.height });
+    const float steps = std::ceil(travel / (thickness / 2));
+    if (FirstContact(*collider, motion, steps >= 1 ? static_cast<int>(std::min<float>(steps, MAX_SWEEP_STEPS)) : 1, contact)) {
+      // On a tie the later collider wins like in CheckCollisions(), where the last OnCollision() call decides
+      if (!firstHit || contact.time <= firstContact.time) {
+        firstHit = collider;
+        firstContact = contact;
+      }
+    }
+  }
+
+  pos = motion.endPos;
+  rotation = motion.endRotation;
+  if (firstHit) {
+    OnCollision(*firstHit, firstContact);
+  }
+}
+
+Rectangle Collider::SweptBounds(const Motion& motion) {
+  // No point is further away from its end position than the travel distance
+  pos = motion.endPos;
+  rotation = motion.endRotation;
+  Rectangle bounds = WorldBounds();
+  const float travel = motion.MaxTravel(Center().Length());
+  bounds.topLeft -= Vector(travel, travel);
+  bounds.bottomRight += Vector(travel, travel);
+  return bounds;
+}
+
+bool Collider::FirstContact(const Collider& collider, const Motion& motion, int steps, ContactManifold& contact) {
+  auto moveTo = [this, &motion](float fraction) {
+    pos = motion.PosAt(fraction);
+    rotation = motion.RotationAt(fraction);
+  };
+
+  // The start of the movement has already been checked as the end of the last tick's movement
+  float freeFraction = 0; // the latest fraction without contact
+  for (int step = 1; step <= steps; ++step) {
+    const float fraction = static_cast<float>(step) / steps;
+    moveTo(fraction);
+    if (collider.CollidesWith(*this, contact)) {
+      float hitFraction = fraction;
+      ContactManifold bisectionContact;
+      for (int i = 0; i < BISECTION_STEPS; ++i) {
+        const float middle = (freeFraction + hitFraction) / 2;
+        moveTo(middle);
+        if (collider.CollidesWith(*this, bisectionContact)) {
+          hitFraction = middle;
+          contact = bisectionContact;
+        } else {
+          freeFraction = middle;
+        }
+      }
+      contact.time = hitFraction;
+      return true;
+    }
+    freeFraction = fraction;
+  }
+  return false;
+}
+
+bool Collider::CollidesWith(const Collider& object, ContactManifold& contact) const {
+  return WorldBox().Collide(object.WorldBox(), contact);
+}
+
+OrientedBox Collider::WorldBox() const {
+  return OrientedBox::FromTransform(ObjectToWorldTransform(), size);
+}
+
+std::array<Vector, 8> Collider::OutlinePoints() const {
   Rectangle rect(Vector::Zero, size);
 
-  std::array<Vector, 8> collisionPoints;
+  // The transformation is calculated once for all points
+  const Transform& toWorld = ObjectToWorldTransform();
+  std::array<Vector, 8> points;
+
+  points[0] = toWorld(rect.topLeft);
+  points[1] = toWorld(rect.TopCenter());
+  points[2] = toWorld(rect.TopRight());
+  points[3] = toWorld(rect.LeftCenter());
+  points[4] = toWorld(rect.RightCenter());
+  points[5] = toWorld(rect.BottomLeft());
+  points[6] = toWorld(rect.BottomCenter());
+  points[7] = toWorld(rect.bottomRight);
+  return points;
+}
 
-  collisionPoints[0] = ObjectToWorld(rect.topLeft);
-  collisionPoints[1] = ObjectToWorld(rect.TopCenter());
-  collisionPoints[2] = ObjectToWorld(rect.TopRight());
-  collisionPoints[3] = ObjectToWorld(rect.LeftCenter());
-  collisionPoints[4] = ObjectToWorld(rect.RightCenter());
-  collisionPoints[5] = ObjectToWorld(rect.BottomLeft());
-  collisionPoints[6] = ObjectToWorld(rect.BottomCenter());
-  collisionPoints[7] = ObjectToWorld(rect.bottomRight);
+void Collider::CheckCollisions(const std::vector<Collider*>& colliders) {
+  const Transform& toWorld = ObjectToWorldTransform();
+  const Vector center = toWorld(Center());
 
-  for (auto collider : Game::Instance()->GetColliders()) {
+  ContactManifold contact;
+  for (auto collider : colliders) {
     if (collider != this) { //ignore the object itself
 
-      Vector distance = ObjectToWorld(this->Center()) - ObjectToWorld(collider->Center()); // Vector connecting both objects' center
+      Vector distance = center - collider->ObjectToWorldTransform()(collider->Center()); // Vector connecting both objects' center
       float totalRadius = Center().Length() + collider->Center().Length();
 
-      if (totalRadius > distance.Length()) { // if distance is smaller than the object's radiuses: collision is possible
-        
-        // check whether one of the eight points of the rectangle is inside the other rectangle. (if so, call OnCollision())
-        if (std::any_of(collisionPoints.begin(), collisionPoints.end(), [collider](const Vector& point) { return collider->IsPointInside(point); })) {
-          OnCollision(*collider);
+      if (!useRadiusMidphase || totalRadius > distance.Length()) { // if distance is smaller than the object's radiuses: collision is possible
+        if (collider->CollidesWith(*this, contact)) {
+          OnCollision(*collider, contact);
         }
       }
     }  
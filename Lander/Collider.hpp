@@ -1,10 +1,15 @@
 #pragma once
 
+#include "OrientedBox.hpp"
+
 namespace Lander {
 
+struct Motion;
+
 /** This class represents all objects, which take place in collision detection.
   */
 class Collider : public ViewObject {
+  friend class Broadphase;
 public:
 
   /** This method can be called on any collider to check whether a given point is 
@@ -14,21 +19,83 @@ public:
    */
   virtual bool IsPointInside(Vector point) const;
 
+  /** Returns the axis aligned bounding box of this object in world coordinates. IsPointInside() must return false for
+   *  all points outside of it, because the broadphase only checks colliders, whose bounds overlap.
+   *  Colliders, which aren't limited to their rectangle, must override this. The bounds may only depend on pos, size and rotation.
+   */
+  virtual Rectangle WorldBounds() const;
+
+  /** Checks whether the given (rectangular) object overlaps this collider and fills the contact with the normal pointing
+   *  towards the object. The default implementation is an exact separating axis test of both rotated rectangles.
+   *  Colliders of a different shape must override this.
+   */
+  virtual bool CollidesWith(const Collider& object, ContactManifold& contact) const;
+
+  /** Returns a lower bound of the distance between the given rectangle and this collider (0 if they may touch), e.g. to find out
+   *  how far an object can move before it can touch this collider. Parts of the collider further away than maxDistance may be
+   *  ignored and the result is at most maxDistance. The default uses the world bounds.
+   */
+  virtual float Clearance(const Rectangle& rect, float maxDistance) const;
+
+  /** Returns this object's rectangle in world coordinates
+   */
+  OrientedBox WorldBox() const;
+
+  /** Returns the corners and the centers of the edges of this object's rectangle in world coordinates
+   */
+  std::array<Vector, 8> OutlinePoints() const;
+
 protected:
   /** Checks whether this object collides with any Collider of this game.
-   *  The check is implemented simply as checking 8 points of the bounding box to be inside
-   *  the other collider. If both objects collide, OnCollision() gets called with that collider.
-   *  This works only for objects of rectangular shape. If this object has a different shape, CheckCollision()
-   *  should be overwritten in that class.
+   *  The world's broadphase (see Broadphase) returns the colliders, whose bounds overlap this object's bounds,
+   *  and only these are checked with CollidesWith(). If both objects collide, OnCollision() gets called with
+   *  that collider and the contact. This works only for objects of rectangular shape. If this object has a different shape,
+   *  CheckCollision() should be overwritten in that class.
    */
   virtual void CheckCollisions();
 
+  /** Same check as CheckCollisions(), but against the given colliders instead of all colliders of the world.
+   */
+  void CheckCollisions(const std::vector<Collider*>& colliders);
+
+  /** Continuous version of CheckCollisions(), which checks the whole movement of a tick instead of the current position.
+   *  The movement is sampled in steps, in which no point moves further than half the thickness of the thinner object,
+   *  so thin colliders can't be skipped, and the first step with a contact is bisected to find the time of impact.
+   *  The other colliders are treated as if they didn't move during the tick and the start of the movement isn't checked,
+   *  because it is the end of the previous tick's movement.
+   *  OnCollision() gets called once with the collider, which is touched first, and the fraction of the tick in contact.time.
+   *  pos and rotation are left at the end of the movement.
+   */
+  void CheckCollisions(const Motion& motion);
+
+  /** Same check as CheckCollisions(const Motion&), but against the given colliders.
+   */
+  void CheckCollisions(const Motion& motion, const std::vector<Collider*>& colliders);
+
+  /** Whether CheckCollisions() skips colliders, whose bounding circle doesn't touch this object's bounding circle, before
+   *  running the exact test (a midphase between the broadphase and CollidesWith())
+   */
+  bool useRadiusMidphase = true;
+
 private:
+  /** Returns the bounds of this object during the whole movement
+   */
+  Rectangle SweptBounds(const Motion& motion);
+
+  /** Moves this object along the movement in the given number of steps until it touches the collider and bisects that step.
+   *
+   * @return true if both touch, contact.time is the earliest fraction of the tick found with contact
+   */
+  bool FirstContact(const Collider& collider, const Motion& motion, int steps, ContactManifold& contact);
+
   /** Gets called in CheckCollisions() for each collider, this object intersects with.
    *
    * @param collider the collider, this object intersects with.
+   * @param contact where both touch (the normal points from the collider towards this object)
    */
-  virtual void OnCollision(Collider& collider) {}
+  virtual void OnCollision(Collider& collider, const ContactManifold& contact) {}
+
+  int32_t broadphaseEntry = -1; // the index of this collider in its world's Broadphase
 };
 
 
@@ -0,0 +1,261 @@
+#include "stdafx.h"
+#include "ContactSolver.hpp"
+#include "RigidBody.hpp"
+#include "Broadphase.hpp"
+
+namespace Lander {
+
+namespace {
+
+const float TO_RADIANS = Vector::PI / 180;
+
+/** The z component of the cross product of both vectors
+ */
+float Cross(Vector a, Vector b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+/** The velocity of a point at the given offset from the center of a body, which rotates with the given angular velocity (rad/s)
+ */
+Vector Cross(float angularVelocity, Vector offset) {
+  return Vector(-angularVelocity * offset.y, angularVelocity * offset.x);
+}
+
+}
+
+
+void ContactSolver::Add(RigidBody& body) {
+  body.solverIndex = static_cast<int32_t>(bodies.size());
+  bodies.push_back(&body);
+}
+
+void ContactSolver::Solve(Broadphase& broadphase, float seconds) {
+  states.resize(bodies.size());
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    RigidBody& body = *bodies[i];
+    const bool movable = body.enabled && body.mass > 0;
+    states[i] = { &body, body.ObjectToWorldTransform()(body.Center()), body.velocity, body.angularVelocity * TO_RADIANS, Vector::Zero, 0,
+                  movable ? 1 / body.mass : 0, movable ? 1 / body.MomentOfInertia() : 0, false };
+  }
+
+  contacts.clear();
+  ContactManifold manifold;
+  for (uint32_t a = 0; a < bodies.size(); ++a) {
+    RigidBody& body = *bodies[a];
+    if (!body.enabled) {
+      continue;
+    }
+    for (auto collider : broadphase.Query(body.WorldBounds())) {
+      if (collider == &body || !collider->enabled) {
+        continue;
+      }
+      // Each pair of bodies is checked once, by the body added first
+      auto other = dynamic_cast<const RigidBody*>(collider);
+      if (other && other->solverIndex < static_cast<int32_t>(a)) {
+        continue;
+      }
+      if (collider->CollidesWith(body, manifold)) {
+        AddContact(a, *collider, other ? other->solverIndex : -1, manifold);
+      }
+    }
+  }
+
+  warmStarted = 0;
+  if (warmStarting) {
+    for (auto& contact : contacts) {
+      WarmStart(contact);
+    }
+  }
+  for (int i = 0; i < velocityIterations; ++i) {
+    for (auto& contact : contacts) {
+      SolveVelocities(contact);
+    }
+  }
+  for (int i = 0; i < positionIterations; ++i) {
+    for (auto& contact : contacts) {
+      SolvePositions(contact, seconds);
+    }
+  }
+
+  // The bodies have already moved with their old velocities during the tick -> move them by the change
+  for (auto& state : states) {
+    if (!state.inContact) {
+      continue;
+    }
+    RigidBody& body = *state.body;
+    const float angularVelocity = state.angularVelocity / TO_RADIANS;
+    body.pos += (state.velocity - body.velocity + state.pseudoVelocity) * (seconds * PhysicsObject::PIXEL_PER_METER);
+    body.rotation += (angularVelocity - body.angularVelocity + state.pseudoAngularVelocity / TO_RADIANS) * seconds;
+    body.velocity = state.velocity;
+    body.angularVelocity = angularVelocity;
+    broadphase.Update(body);
+  }
+
+  lastContacts = contacts;
+  lastContactIndex.clear();
+  for (uint32_t i = 0; i < lastContacts.size(); ++i) {
+    lastContactIndex.push_back({ { bodies[lastContacts[i].a], lastContacts[i].collider }, i });
+  }
+  std::sort(lastContactIndex.begin(), lastContactIndex.end());
+}
+
+void ContactSolver::AddContact(uint32_t a, const Collider& collider, int32_t b, const ContactManifold& manifold) {
+  const RigidBody& body = *bodies[a];
+  Body& stateA = states[a];
+  Body* stateB = b >= 0 ? &states[b] : nullptr;
+  stateA.inContact = true;
+  if (stateB) {
+    stateB->inContact = true;
+  }
+
+  Contact contact;
+  contact.a = a;
+  contact.b = b;
+  contact.collider = &collider;
+  contact.normal = manifold.normal;
+  contact.friction = stateB ? std::sqrt(body.friction * bodies[b]->friction) : body.friction;
+  contact.pointCount = manifold.pointCount;
+  const float restitution = stateB ? std::max(body.restitution, bodies[b]->restitution) : body.restitution;
+
+  // The manifold only holds the depth of the deepest point, the others are less deep by their distance along the normal
+  float deepest = -std::numeric_limits<float>::infinity();
+  for (int i = 0; i < manifold.pointCount; ++i) {
+    deepest = std::max(deepest, -(manifold.points[i] * contact.normal));
+  }
+
+  const Vector normal = contact.normal;
+  const Vector tangent = normal.Rotate90CW();
+  for (int i = 0; i < manifold.pointCount; ++i) {
+    const Vector position = manifold.points[i];
+    Point& point = contact.points[i];
+    point.anchor = body.WorldToObjectTransform()(position);
+    point.ra = (position - stateA.center) / PhysicsObject::PIXEL_PER_METER;
+    point.rb = stateB ? (position - stateB->center) / PhysicsObject::PIXEL_PER_METER : Vector::Zero;
+    point.depth = manifold.depth - (deepest + position * normal);
+
+    // The mass, which the impulse along a direction at this point moves (the inverse of the velocity change per impulse)
+    auto effectiveMass = [&](Vector direction) {
+      const float ra = Cross(point.ra, direction);
+      float inverse = stateA.inverseMass + stateA.inverseInertia * ra * ra;
+      if (stateB) {
+        const float rb = Cross(point.rb, direction);
+        inverse += stateB->inverseMass + stateB->inverseInertia * rb * rb;
+      }
+      return inverse > 0 ? 1 / inverse : 0;
+    };
+    point.normalMass = effectiveMass(normal);
+    point.tangentMass = effectiveMass(tangent);
+
+    Vector relativeVelocity = stateA.velocity + Cross(stateA.angularVelocity, point.ra);
+    if (stateB) {
+      relativeVelocity -= stateB->velocity + Cross(stateB->angularVelocity, point.rb);
+    }
+    const float approachSpeed = -(relativeVelocity * normal);
+    point.bounce = approachSpeed > BOUNCE_SPEED ? restitution * approachSpeed : 0;
+
+    point.normalImpulse = 0;
+    point.tangentImpulse = 0;
+    point.pseudoImpulse = 0;
+  }
+  contacts.push_back(contact);
+}
+
+void ContactSolver::WarmStart(Contact& contact) {
+  const std::pair<const Collider*, const Collider*> key(bodies[contact.a], contact.collider);
+  auto found = std::lower_bound(lastContactIndex.begin(), lastContactIndex.end(), std::make_pair(key, 0u));
+  if (found == lastContactIndex.end() || found->first != key) {
+    return;
+  }
+  const Contact& last = lastContacts[found->second];
+
+  const Vector tangent = contact.normal.Rotate90CW();
+  bool matched = false;
+  for (int i = 0; i < contact.pointCount; ++i) {
+    Point& point = contact.points[i];
+    // The closest point of the last tick, which hasn't moved further than MATCH_DISTANCE on the body
+    const Point* closest = nullptr;
+    float closestDistance = MATCH_DISTANCE;
+    for (int j = 0; j < last.pointCount; ++j) {
+      const float distance = (point.anchor - last.points[j].anchor).Length();
+      if (distance < closestDistance) {
+        closest = &last.points[j];
+        closestDistance = distance;
+      }
+    }
+    if (closest) {
+      point.normalImpulse = closest->normalImpulse;
+      point.tangentImpulse = closest->tangentImpulse;
+      ApplyImpulse(contact, point, contact.normal * point.normalImpulse + tangent * point.tangentImpulse);
+      matched = true;
+    }
+  }
+  if (matched) {
+    ++warmStarted;
+  }
+}
+
+void ContactSolver::ApplyImpulse(const Contact& contact, const Point& point, Vector impulse) {
+  Body& a = states[contact.a];
+  a.velocity += impulse * a.inverseMass;
+  a.angularVelocity += a.inverseInertia * Cross(point.ra, impulse);
+  if (contact.b >= 0) {
+    Body& b = states[contact.b];
+    b.velocity -= impulse * b.inverseMass;
+    b.angularVelocity -= b.inverseInertia * Cross(point.rb, impulse);
+  }
+}
+
+void ContactSolver::SolveVelocities(Contact& contact) {
+  const Body& a = states[contact.a];
+  const Body* b = contact.b >= 0 ? &states[contact.b] : nullptr;
+  auto relativeVelocity = [&](const Point& point) {
+    Vector velocity = a.velocity + Cross(a.angularVelocity, point.ra);
+    if (b) {
+      velocity -= b->velocity + Cross(b->angularVelocity, point.rb);
+    }
+    return velocity;
+  };
+
+  // Friction first, so the normal impulses, which prevent the penetration, get the last word
+  const Vector tangent = contact.normal.Rotate90CW();
+  for (int i = 0; i < contact.pointCount; ++i) {
+    Point& point = contact.points[i];
+    const float maxFriction = contact.friction * point.normalImpulse;
+    const float impulse = std::clamp(point.tangentImpulse - (relativeVelocity(point) * tangent) * point.tangentMass, -maxFriction, maxFriction);
+    ApplyImpulse(contact, point, tangent * (impulse - point.tangentImpulse));
+    point.tangentImpulse = impulse;
+  }
+
+  for (int i = 0; i < contact.pointCount; ++i) {
+    Point& point = contact.points[i];
+    // The accumulated impulse may only push the bodies apart, but single iterations may take back some of it
+    const float impulse = std::max(point.normalImpulse + (point.bounce - relativeVelocity(point) * contact.normal) * point.normalMass, 0.0f);
+    ApplyImpulse(contact, point, contact.normal * (impulse - point.normalImpulse));
+    point.normalImpulse = impulse;
+  }
+}
+
+void ContactSolver::SolvePositions(Contact& contact, float seconds) {
+  Body& a = states[contact.a];
+  Body* b = contact.b >= 0 ? &states[contact.b] : nullptr;
+  for (int i = 0; i < contact.pointCount; ++i) {
+    Point& point = contact.points[i];
+    Vector velocity = a.pseudoVelocity + Cross(a.pseudoAngularVelocity, point.ra);
+    if (b) {
+      velocity -= b->pseudoVelocity + Cross(b->pseudoAngularVelocity, point.rb);
+    }
+    const float targetSpeed = CORRECTION / seconds * std::max(point.depth - SLOP, 0.0f) / PhysicsObject::PIXEL_PER_METER;
+    const float impulse = std::max(point.pseudoImpulse + (targetSpeed - velocity * contact.normal) * point.normalMass, 0.0f);
+    const Vector change = contact.normal * (impulse - point.pseudoImpulse);
+    point.pseudoImpulse = impulse;
+
+    a.pseudoVelocity += change * a.inverseMass;
+    a.pseudoAngularVelocity += a.inverseInertia * Cross(point.ra, change);
+    if (b) {
+      b->pseudoVelocity -= change * b->inverseMass;
+      b->pseudoAngularVelocity -= b->inverseInertia * Cross(point.rb, change);
+    }
+  }
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+namespace Lander {
+
+class Broadphase;
+class RigidBody;
+
+/** Resolves the contacts of the rigid bodies of a world with sequential impulses (see World::Tick()).
+ *
+ *  After the bodies have moved, Solve() collects the contact manifolds of every body with the colliders its bounds overlap and
+ *  solves each contact point as a constraint on the velocities: the normal impulse stops the bodies from approaching (or lets them
+ *  bounce off with their restitution) and the friction impulse, limited by the friction coefficient times the normal impulse, stops
+ *  them from sliding. The impulses are applied point by point for a fixed number of iterations, so the cost per tick only grows
+ *  with the number of contacts. The penetration is removed separately with pseudo velocities, which only move the bodies and don't
+ *  add to their velocities, so resting bodies don't jitter or gain energy.
+ *
+ *  With warm starting the impulses of the last tick are applied first to the contact points, which persist, so stacks and piles
+ *  of resting bodies converge within the few iterations.
+ */
+class ContactSolver {
+public:
+  static constexpr int DEFAULT_VELOCITY_ITERATIONS = 8;
+  static constexpr int DEFAULT_POSITION_ITERATIONS = 3;
+
+  static constexpr float SLOP = 0.5f;          // px the bodies may penetrate without being pushed out (keeps the contacts alive)
+  static constexpr float CORRECTION = 0.2f;    // fraction of the remaining penetration removed per tick
+  static constexpr float BOUNCE_SPEED = 1;     // m/s the bodies have to approach with to bounce off
+  static constexpr float MATCH_DISTANCE = 2;   // px a contact point may move within a tick to keep its impulses for warm starting
+
+  /** Registers the body (called by World::AddObject()). A body can only be added to one solver.
+   */
+  void Add(RigidBody& body);
+
+  /** Returns true if no body has been added
+   */
+  bool Empty() const { return bodies.empty(); }
+
+  /** Finds the contacts of all enabled bodies, corrects their velocities and moves them out of the other colliders.
+   *  The bodies must have been moved by the given time with semi-implicit Euler (see RigidBody), so their position can be corrected
+   *  by the change of the velocity. The broadphase entries of the moved bodies are updated.
+   */
+  void Solve(Broadphase& broadphase, float seconds);
+
+  int velocityIterations = DEFAULT_VELOCITY_ITERATIONS;
+  int positionIterations = DEFAULT_POSITION_ITERATIONS;
+  bool warmStarting = true;
+
+  /** Returns the number of contacts (pairs of touching colliders) of the last Solve()
+   */
+  size_t ContactCount() const { return contacts.size(); }
+
+  /** Returns the number of contacts of the last Solve(), which started with the impulses of the tick before
+   */
+  size_t WarmStartedContactCount() const { return warmStarted; }
+
+private:
+  // The velocities of a body during Solve() (in m/s and rad/s)
+  struct Body {
+    RigidBody* body;
+    Vector center; // px
+    Vector velocity;
+    float angularVelocity;
+    Vector pseudoVelocity; // only moves the body out of the other colliders
+    float pseudoAngularVelocity;
+    float inverseMass, inverseInertia;
+    bool inContact; // whether the solver changed the velocities
+  };
+
+  struct Point {
+    Vector anchor;      // the contact point in the coordinates of body a (to find it again in the next tick)
+    Vector ra, rb;      // m from the centers of the bodies
+    float depth;        // px
+    float normalMass, tangentMass;
+    float bounce;       // m/s the bodies separate with after the impact
+    float normalImpulse, tangentImpulse, pseudoImpulse; // N*s, accumulated over the iterations
+  };
+
+  struct Contact {
+    uint32_t a;        // index of the body
+    int32_t b;         // index of the other body, -1 if the other collider isn't a rigid body
+    const Collider* collider; // the other collider
+    Vector normal;     // pointing from the other collider towards body a
+    float friction;
+    int pointCount;
+    std::array<Point, ContactManifold::MAX_POINTS> points;
+  };
+
+  /** Adds the contact of body a with the collider and prepares its points
+   */
+  void AddContact(uint32_t a, const Collider& collider, int32_t b, const ContactManifold& manifold);
+
+  /** Applies the impulses of the contact points of the last tick to the ones, which still exist
+   */
+  void WarmStart(Contact& contact);
+
+  void ApplyImpulse(const Contact& contact, const Point& point, Vector impulse);
+  void SolveVelocities(Contact& contact);
+  void SolvePositions(Contact& contact, float seconds);
+
+  std::vector<RigidBody*> bodies; // in the order they have been added
+  std::vector<Body> states;
+  std::vector<Contact> contacts;
+
+  // The contacts of the last tick sorted by their colliders for warm starting
+  std::vector<Contact> lastContacts;
+  std::vector<std::pair<std::pair<const Collider*, const Collider*>, uint32_t>> lastContactIndex;
+  size_t warmStarted = 0;
+};
+
+}
@@ -0,0 +1,209 @@
+#include "stdafx.h"
+#include "DeterministicMath.hpp"
+
+#include <cstring>
+
+// No FMA contraction in this file (GCC only supports this through -ffp-contract=off, which the CMake build sets)
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace Lander {
+namespace DeterministicMath {
+
+namespace {
+
+// Constants and polynomials of fdlibm (k_sin.c, k_cos.c, e_rem_pio2.c and e_acos.c)
+const double PI      = 3.14159265358979311600e+00;
+const double PIO4    = 7.85398163397448278999e-01;
+const double MAX_ARGUMENT = 1.12589990684262400000e+15; // 2^50, larger arguments can't be reduced with TO_INT
+const double PIO2_HI = 1.57079632679489655800e+00;
+const double PIO2_LO = 6.12323399573676603587e-17;
+
+const double TO_INT   = 6.75539944105574400000e+15; // 1.5 * 2^52: adding and subtracting it rounds to the nearest integer
+const double INV_PIO2 = 6.36619772367581382433e-01; // 2/pi
+const double PIO2_1   = 1.57079632673412561417e+00; // first 33 bits of pi/2
+const double PIO2_1T  = 6.07710050650619224932e-11; // pi/2 - PIO2_1
+const double PIO2_2   = 6.07710050630396597660e-11; // second 33 bits of pi/2
+const double PIO2_2T  = 2.02226624879595063154e-21; // pi/2 - (PIO2_1 + PIO2_2)
+const double PIO2_3   = 2.02226624871116645580e-21; // third 33 bits of pi/2
+const double PIO2_3T  = 8.47842766036889956997e-32; // pi/2 - (PIO2_1 + PIO2_2 + PIO2_3)
+
+const double S1 = -1.66666666666666324348e-01;
+const double S2 =  8.33333333332248946124e-03;
+const double S3 = -1.98412698298579493134e-04;
+const double S4 =  2.75573137070700676789e-06;
+const double S5 = -2.50507602534068634195e-08;
+const double S6 =  1.58969099521155010221e-10;
+
+const double C1 =  4.16666666666666019037e-02;
+const double C2 = -1.38888888888741095749e-03;
+const double C3 =  2.48015872894767294178e-05;
+const double C4 = -2.75573143513906633035e-07;
+const double C5 =  2.08757232129817482790e-09;
+const double C6 = -1.13596475577881948265e-11;
+
+const double PS0 =  1.66666666666666657415e-01;
+const double PS1 = -3.25565818622400915405e-01;
+const double PS2 =  2.01212532134862925881e-01;
+const double PS3 = -4.00555345006794114027e-02;
+const double PS4 =  7.91534994289814532176e-04;
+const double PS5 =  3.47933107596021167570e-05;
+const double QS1 = -2.40339491173441421878e+00;
+const double QS2 =  2.02094576023350569471e+00;
+const double QS3 = -6.88283971605453293030e-01;
+const double QS4 =  7.70381505559019352791e-02;
+
+/** Returns the biased exponent of x
+ */
+int Exponent(double x) {
+  uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return static_cast<int>((bits >> 52) & 0x7ff);
+}
+
+/** Returns x with the lower 32 bits of the mantissa cleared
+ */
+double ClearLowWord(double x) {
+  uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  bits &= 0xffffffff00000000ull;
+  std::memcpy(&x, &bits, sizeof(bits));
+  return x;
+}
+
+/** Sine on [-pi/4, pi/4] of x + tail, where tail is the part of the reduced argument, which didn't fit into x
+ */
+double KernelSin(double x, double tail, bool hasTail) {
+  double z = x * x;
+  double v = z * x;
+  double r = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+  if (!hasTail) {
+    return x + v * (S1 + z * r);
+  }
+  return x - ((z * (0.5 * tail - v * r) - tail) - v * S1);
+}
+
+/** Cosine on [-pi/4, pi/4] of x + tail
+ */
+double KernelCos(double x, double tail) {
+  double z = x * x;
+  double r = z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+  double hz = 0.5 * z;
+  double w = 1.0 - hz;
+  return w + (((1.0 - w) - hz) + (z * r - x * tail));
+}
+
+/** Reduces x to y0 + y1 in [-pi/4, pi/4] and returns the number of quarter turns, which have been subtracted (modulo 4).
+ *  This is fdlibm's reduction for medium sized arguments with pi/2 split into three parts (Cody-Waite).
+ */
+int ReducePio2(double x, double& y0, double& y1) {
+  double fn = (x * INV_PIO2 + TO_INT) - TO_INT; // round to nearest without a call to nearbyint()
+  double r = x - fn * PIO2_1; // exact for |fn| < 2^20
+  double w = fn * PIO2_1T;
+  y0 = r - w;
+
+  const int exponent = Exponent(x);
+  if (exponent - Exponent(y0) > 16) {
+    // Cancellation -> take the next 33 bits of pi/2 into account
+    double t = r;
+    w = fn * PIO2_2;
+    r = t - w;
+    w = fn * PIO2_2T - ((t - r) - w);
+    y0 = r - w;
+
+    if (exponent - Exponent(y0) > 49) {
+      t = r;
+      w = fn * PIO2_3;
+      r = t - w;
+      w = fn * PIO2_3T - ((t - r) - w);
+      y0 = r - w;
+    }
+  }
+  y1 = (r - y0) - w;
+
+  return static_cast<int>(static_cast<int64_t>(fn) & 3);
+}
+
+}
+
+
+double Sin(double x) {
+  if (std::fabs(x) <= PIO4) {
+    return KernelSin(x, 0, false);
+  }
+  if (!(std::fabs(x) < MAX_ARGUMENT)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  double y0, y1;
+  switch (ReducePio2(x, y0, y1)) {
+    case 0:  return KernelSin(y0, y1, true);
+    case 1:  return KernelCos(y0, y1);
+    case 2:  return -KernelSin(y0, y1, true);
+    default: return -KernelCos(y0, y1);
+  }
+}
+
+double Cos(double x) {
+  if (std::fabs(x) <= PIO4) {
+    return KernelCos(x, 0);
+  }
+  if (!(std::fabs(x) < MAX_ARGUMENT)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+
+  double y0, y1;
+  switch (ReducePio2(x, y0, y1)) {
+    case 0:  return KernelCos(y0, y1);
+    case 1:  return -KernelSin(y0, y1, true);
+    case 2:  return -KernelCos(y0, y1);
+    default: return KernelSin(y0, y1, true);
+  }
+}
+
+double Acos(double x) {
+  const double absX = std::fabs(x);
+  if (absX >= 1) {
+    if (x == 1) {
+      return 0;
+    }
+    if (x == -1) {
+      return PI;
+    }
+    return (x - x) / (x - x); // NaN
+  }
+
+  if (absX < 0.5) {
+    double z = x * x;
+    double p = z * (PS0 + z * (PS1 + z * (PS2 + z * (PS3 + z * (PS4 + z * PS5)))));
+    double q = 1.0 + z * (QS1 + z * (QS2 + z * (QS3 + z * QS4)));
+    double r = p / q;
+    return PIO2_HI - (x - (PIO2_LO - x * r));
+  }
+
+  if (x < 0) {
+    double z = (1.0 + x) * 0.5;
+    double p = z * (PS0 + z * (PS1 + z * (PS2 + z * (PS3 + z * (PS4 + z * PS5)))));
+    double q = 1.0 + z * (QS1 + z * (QS2 + z * (QS3 + z * QS4)));
+    double s = std::sqrt(z);
+    double r = p / q;
+    double w = r * s - PIO2_LO;
+    return PI - 2.0 * (s + w);
+  }
+
+  double z = (1.0 - x) * 0.5;
+  double s = std::sqrt(z);
+  double high = ClearLowWord(s);
+  double c = (z - high * high) / (s + high);
+  double p = z * (PS0 + z * (PS1 + z * (PS2 + z * (PS3 + z * (PS4 + z * PS5)))));
+  double q = 1.0 + z * (QS1 + z * (QS2 + z * (QS3 + z * QS4)));
+  double r = p / q;
+  double w = r * s + c;
+  return 2.0 * (high + w);
+}
+
+}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cmath>
+
+namespace Lander {
+
+/** Portable sine, cosine and arc cosine, which return bit-identical results on every platform and compiler.
+ *  They only use IEEE 754 additions, multiplications, divisions and square roots in a fixed order (the algorithms of fdlibm),
+ *  instead of the platform's libm, whose results differ in the last bit between MSVC, glibc and others.
+ *  This requires the code to be compiled without contracting multiplications and additions into FMAs
+ *  (-ffp-contract=off, /fp:precise) and without x87 excess precision.
+ */
+namespace DeterministicMath {
+
+/** Returns the sine of x (radians). Accurate to 1 ulp for |x| < 2^20 * pi/2, larger arguments are reduced less accurately
+ *  and arguments beyond 2^50 return NaN.
+ */
+double Sin(double x);
+
+/** Returns the cosine of x (radians). Same accuracy and range as Sin().
+ */
+double Cos(double x);
+
+/** Returns the arc cosine of x in radians (0-pi) or NaN if x is outside of [-1, 1].
+ */
+double Acos(double x);
+
+}
+
+
+/** The math functions the simulation uses. With LANDER_DETERMINISTIC_MATH (default in the CMake build and Lander.vcxproj)
+ *  these are the DeterministicMath functions, so replays verify identically on every platform. Without it,
+ *  they are the platform's libm functions.
+ */
+namespace SimulationMath {
+
+#ifdef LANDER_DETERMINISTIC_MATH
+inline double Sin(double x) { return DeterministicMath::Sin(x); }
+inline double Cos(double x) { return DeterministicMath::Cos(x); }
+inline double Acos(double x) { return DeterministicMath::Acos(x); }
+inline float Sin(float x) { return static_cast<float>(DeterministicMath::Sin(x)); }
+inline float Cos(float x) { return static_cast<float>(DeterministicMath::Cos(x)); }
+inline float Acos(float x) { return static_cast<float>(DeterministicMath::Acos(x)); }
+#else
+inline double Sin(double x) { return std::sin(x); }
+inline double Cos(double x) { return std::cos(x); }
+inline double Acos(double x) { return std::acos(x); }
+inline float Sin(float x) { return std::sin(x); }
+inline float Cos(float x) { return std::cos(x); }
+inline float Acos(float x) { return std::acos(x); }
+#endif
+
+}
+
+}
@@ -10,8 +10,10 @@ FPSCounter::FPSCounter() : avgFps(0), textFormat(NULL) {
 int FPSCounter::RenderPriority() const { return -100; }
 
 void FPSCounter::Draw(RenderInterface& renderInterface, const Rectangle& visibleRect, double secondsPassed) {
-  long fps = static_cast<long>(1.0 / secondsPassed);
-  avgFps = (0.9*avgFps) + (0.1*fps); //Take the average of ten frames
+  if (secondsPassed > 0) { // a virtual clock may not advance between two frames
+    long fps = static_cast<long>(1.0 / secondsPassed);
+    avgFps = (0.9*avgFps) + (0.1*fps); //Take the average of ten frames
+  }
   
   // Create the FPS text
   std::wstring fpsText(L"FPS: ");
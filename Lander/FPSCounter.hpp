@@ -6,7 +6,7 @@ class FPSCounter : public OverlayObject {
 public:
   FPSCounter();
 
-  /** Draw the FPS counter and update the FPS count
+  /** Draw the FPS counter and update the FPS count (secondsPassed is measured with the game's clock)
    */
   virtual void Draw(RenderInterface& renderInterface, const Rectangle& visibleRect, double secondsPassed) override;
 
@@ -1,13 +1,6 @@
 #include "stdafx.h"
 #include "FuelTank.hpp"
 
-namespace {
- const float p = 280.f;   // Volume of H in kg/m
- const float ls = 3830.f; // Amount of energy every kg of fuel burn provides, in Newton for a second
- const float Q = 10.714f; // Amount of fuel that is burnt every second, in m
-
-}
-
 FuelTank::FuelTank() : currentVolume(maxVolume) {}
 
   FuelTank::~FuelTank(){}
@@ -35,12 +28,20 @@ FuelTank::FuelTank() : currentVolume(maxVolume) {}
     return Q*p*ls;  // thrust per second, in Newton
   }
 
-  float FuelTank::CurrentVolume() {
+  float FuelTank::MassFlow() const {
+    return Q*p;
+  }
+
+  float FuelTank::MaxThrust() const {
+    return Q*p*ls;
+  }
+
+  float FuelTank::CurrentVolume() const {
     return currentVolume/maxVolume;
   }
 
-  void FuelTank::Refill() {
-    currentVolume = maxVolume;
+  void FuelTank::Refill(float fraction) {
+    currentVolume = maxVolume * fraction;
   }
 
   void FuelTank::Fill(float percent) {
@@ -1,6 +1,10 @@
 #pragma once
 
+namespace Lander { class RocketBatch; class Rocket; }
+
  class FuelTank {
+   friend class Lander::RocketBatch; // simulates the same tank logic for many rockets at once
+   friend class Lander::Rocket; // takes and restores snapshots of the tank
 
    public:
     FuelTank();
@@ -9,15 +13,22 @@
     float Mass() const;
     bool IsEmpty() const;
     float GetThrust(float secondsSinceLastFrame);
+    float MassFlow() const; // kg of fuel burnt per second while thrusting
+    float MaxThrust() const; // N while thrusting (unless the tank is empty)
 
     /** Returns currentVolume/maxVolume (0-1)
      */
-    float CurrentVolume();
-    void Refill(); //completely refills the tank
+    float CurrentVolume() const;
+    void Refill(float fraction = 1); //refills the tank to the fraction (0-1) of its volume, completely by default
     void Fill(float percent); //refills the tank by a percentage value
 
    private:
-    float maxVolume = 1988.23f;
+    static constexpr float p = 280.f;   // Volume of H in kg/m
+    static constexpr float ls = 3830.f; // Amount of energy every kg of fuel burn provides, in Newton for a second
+    static constexpr float Q = 10.714f; // Amount of fuel that is burnt every second, in m
+
+    static constexpr float maxVolume = 1988.23f;
+    static constexpr float emptyMass = 94064.f;  //empty mass in kg
+
     float currentVolume;
-    float emptyMass = 94064.f;  //empty mass in kg
  };
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include "stdafx.h"
 
 #include "KeyboardInput.hpp"
-#include "ReplayInput.hpp"
 #include "Camera.hpp"
 #include "Game.hpp"
 
@@ -9,10 +8,13 @@ using namespace std;
 namespace Lander {
 
 Game* Game::instance = nullptr;
-const int Game::MILLIS_PER_TICK = 5; // 5ms per physics tick (which is more than double my default rate)
 
 
-Game::Game() : hWnd(NULL), initialized(false), input(new KeyboardInput), trackObject(nullptr), gameTick(0) {
+Game::Game() : hWnd(NULL), trackObject(nullptr), level(nullptr), replaySpeedExponent(0), clock(std::make_unique<RealTimeClock>()) {
+  // The game's own world isn't simulated, it only shows the simulation thread's state
+  auto input = std::make_unique<MirrorInput>();
+  mirrorInput = input.get();
+  SetInput(std::move(input));
   Game::instance = this;
 }
 
@@ -22,15 +24,8 @@ Game* Game::Instance() {
 
 Game::~Game()
 {
-  //First clear colliders, we don't want objects to access deleted objects in Deinitialize()
-  colliders.clear();
-
-  //Deinitialize all view objects
-  for (auto viewObject : renderQueue) {
-    viewObject->Deinitialize();
-  }
-  renderQueue.clear();
-
+  // The view objects get deinitialized by the World's destructor
+  simulation.reset(); // stop simulating before anything else gets destroyed
   DiscardDeviceResources();
   
   Game::instance = nullptr;
@@ -39,8 +34,6 @@ Game::~Game()
 
 void Game::RunMessageLoop()
 {
-  simulationStartTime = std::chrono::steady_clock::now();
-
   // MessageLoop:
 	while(true)    
 	{
@@ -113,56 +106,58 @@ HRESULT Game::Initialize()
     camera.reset(new Camera(Rectangle(Vector::Zero, size)));
     gameRenderer.reset(new GameRenderer(*this, *camera, &renderTarget));
 
+    // Initialize all view objects with the size of the draw area
+    World::Initialize(size);
 
-    for (auto viewObject : renderQueue) {
-      viewObject->Initialize(size);
-    }
+    // The level is simulated on its own thread (from the same level file as the shown level)
+    simulation = std::make_unique<SimulationThread>(size, *clock, simulationInput, level ? level->File() : LevelFile::BuiltIn());
+    lastFrameTime = clock->Now();
+    ShowLatestFrame();
   }
    
-  initialized = true;
   return hr;
 }
 
-const std::vector<Collider*>& Game::GetColliders() const {
-  return colliders;
+void Game::TrackObject(ViewObject& viewObject) {
+  trackObject = &viewObject;
 }
 
-const Input& Game::GetInput() const {
-  return *input;
+void Game::AddLevel(Level& level) {
+  level.AddTo(*this);
+  this->level = &level;
 }
 
-void Game::SetInput(std::unique_ptr<Input>&& input) {
-  this->input = std::move(input);
+void Game::SetSimulationInput(SimulationThread::InputFactory inputFactory) {
+  simulationInput = inputFactory;
 }
 
-void Game::TrackObject(ViewObject& viewObject) {
-  trackObject = &viewObject;
+void Game::SetClock(std::unique_ptr<Clock>&& clock) {
+  this->clock = std::move(clock);
 }
 
-
-void Game::AddObject(ViewObject& viewObject) {
-  if (renderQueue.empty()) {
-    renderQueue.push_back(&viewObject);
-  } else { //!empty
-    if (viewObject.RenderPriority() <= renderQueue.back()->RenderPriority()) {
-      renderQueue.push_back(&viewObject);
-    } else if (viewObject.RenderPriority() >= renderQueue.front()->RenderPriority()) {
-      renderQueue.push_front(&viewObject);
-    } else { //insertion + sort
-      renderQueue.push_back(&viewObject);
-      std::stable_sort(renderQueue.begin(), renderQueue.end(), [](ViewObject* v1, ViewObject* v2) { return v1->RenderPriority() > v2->RenderPriority(); });
-    }
+void Game::SetReplaySpeed(int exponent) {
+  replaySpeedExponent = std::clamp(exponent, SimulationThread::MIN_REPLAY_SPEED_EXPONENT, SimulationThread::MAX_REPLAY_SPEED_EXPONENT);
+  if (simulation) {
+    simulation->SetReplaySpeed(replaySpeedExponent);
   }
+  UpdateWindowTitle();
+}
 
-  // Add to collider list if it is a collider
-  if (auto collider = dynamic_cast<Collider*>(&viewObject)) {
-    colliders.push_back(collider);
+void Game::SetMaxTicksPerUpdate(int maxTicks) {
+  if (simulation) {
+    simulation->SetMaxTicksPerUpdate(maxTicks);
   }
+}
 
-  // If initialization already took place, initialize the object upon insertion
-  if (initialized) {
-    viewObject.Initialize(gameRenderer->Size());
+void Game::UpdateWindowTitle() {
+  std::basic_ostringstream<TCHAR> title;
+  title << _T("Lander Game");
+  if (replaySpeedExponent > 0) {
+    title << _T(" - Replay ") << (1 << replaySpeedExponent) << _T("x");
+  } else if (replaySpeedExponent < 0) {
+    title << _T(" - Replay 1/") << (1 << -replaySpeedExponent) << _T("x");
   }
+  SetWindowText(hWnd, title.str().c_str());
 }
 
 
@@ -243,6 +238,20 @@ LRESULT CALLBACK Game::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lP
       case WM_SYSKEYUP:
         if (wParam == VK_F9) {
           game->LoadReplay(hWnd);
+        } else if (!game->simulation) {
+          // not initialized yet
+        } else if (wParam == VK_PRIOR) { // Page up -> 5 seconds back
+          game->simulation->SeekReplayBy(-5000 / MILLIS_PER_TICK);
+        } else if (wParam == VK_NEXT) { // Page down -> 5 seconds forward
+          game->simulation->SeekReplayBy(5000 / MILLIS_PER_TICK);
+        } else if (wParam == VK_HOME) {
+          game->simulation->SeekReplayTo(0);
+        } else if (wParam == VK_END) {
+          game->simulation->SeekReplayTo(std::numeric_limits<int>::max());
+        } else if (wParam == VK_ADD || wParam == VK_OEM_PLUS) { // + -> double replay speed
+          game->SetReplaySpeed(game->replaySpeedExponent + 1);
+        } else if (wParam == VK_SUBTRACT || wParam == VK_OEM_MINUS) { // - -> half replay speed
+          game->SetReplaySpeed(game->replaySpeedExponent - 1);
         }
         return 0;
 
@@ -304,11 +313,10 @@ void Game::LoadReplay(HWND dialogOwner) {
   if (GetOpenFileName(&params)) {
     // User selected a .sav file -> load it into the replayinput
     try {
-      SetInput(std::make_unique<ReplayInput>(fileNameBuffer));
-
-      // reset the game time and ticks to not JUMP into the recording
-      simulationStartTime = std::chrono::steady_clock::now();
-      gameTick = 0;
+      auto replay = std::make_unique<ReplayInput>(fileNameBuffer);
+      if (simulation) {
+        simulation->LoadReplay(std::move(replay));
+      }
     } catch (std::exception&) {
       MessageBox(hWnd, _T("Failed to open replay file"), _T("Error"), MB_ICONERROR);
     }
@@ -317,40 +325,43 @@ void Game::LoadReplay(HWND dialogOwner) {
   SetCurrentDirectory(currentDirectory);
 }
 
+void Game::ShowLatestFrame() {
+  if (!simulation->ConsumeFrame()) {
+    return; // nothing changed since the last frame
+  }
+
+  auto& frame = simulation->CurrentFrame();
+  gameTick = frame.world.gameTick;
+  mirrorInput->SetActiveInputs(frame.activeInputs);
+  if (level) {
+    level->Mirror(frame.level);
+  }
+}
+
 HRESULT Game::OnRender()
 {
   using namespace D2D1;
-  static chrono::steady_clock::time_point lastFrameUpdate = chrono::steady_clock::now();
-  static const double SECONDS_PER_TICK = MILLIS_PER_TICK / 1000.0;
 
   // Create device resources if not already done
   HRESULT res = CreateDeviceResources();
   if (SUCCEEDED(res)) {
     // Get the time since the last frame
-    auto now = chrono::steady_clock::now();
-    auto secondsSinceLastDraw = chrono::duration<double>(now-lastFrameUpdate).count();
-    lastFrameUpdate = now;
-
-
-    // Run the required amount of physics steps let the physics simulation catch up to the current frame time
-    auto millisSinceGameStart = chrono::duration_cast<std::chrono::milliseconds>(now - simulationStartTime).count();
-    int expectedTicksSinceGameStart = millisSinceGameStart / MILLIS_PER_TICK; // simply round down for now
-    for (; gameTick < expectedTicksSinceGameStart; ++gameTick) {
-      // Give objects time to update positions (takes ~25 microseconds in Debug)
-      input->Tick();
-      for (auto viewObject : renderQueue) {
-        if (viewObject->enabled) {
-          // update physics at a constant tick rate to make the simulation deterministic
-          viewObject->Update(SECONDS_PER_TICK);
-        }
-      }
-    }
+    clock->NextFrame();
+    auto now = clock->Now();
+    auto secondsSinceLastDraw = chrono::duration<double>(now-lastFrameTime).count();
+    lastFrameTime = now;
+
+
+    // The simulation thread reads the keys polled here and we show its latest state (the physics ticks run on the simulation thread)
+    KeyboardInput::Poll();
+    ShowLatestFrame();
+    float tickProgress = simulation->TickProgress(now);
     
 
 
     if (trackObject) {
       // Let camera tack the given object
-      camera->TrackObject(*trackObject, secondsSinceLastDraw);
+      camera->TrackObject(*trackObject, secondsSinceLastDraw, tickProgress);
     }
 
 
@@ -361,7 +372,7 @@ HRESULT Game::OnRender()
 
     // Render each object of the render queue
     for (auto viewObject : renderQueue) {
-      gameRenderer->DrawObject(viewObject, secondsSinceLastDraw);
+      gameRenderer->DrawObject(viewObject, secondsSinceLastDraw, tickProgress);
     }
 
     res = renderTarget->EndDraw(); // This single call takes ~14.7ms (on my machine) and effectively determines the frame rate
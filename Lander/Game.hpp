@@ -1,13 +1,14 @@
 #pragma once
 
-#include "Input.hpp"
+#include "World.hpp"
 #include "GameRenderer.hpp"
-
-#include <chrono>
+#include "SimulationThread.hpp"
+#include "MirrorInput.hpp"
+#include "Clock.hpp"
 
 namespace Lander {
 
-class Game
+class Game : public World
 {
 public:
     friend class GameRenderer;
@@ -15,10 +16,6 @@ public:
     Game();
     ~Game();
 
-    // This will be the size of the game window
-    static const int WINDOW_HEIGHT = 960;
-    static const int WINDOW_WIDTH = 1280;
-
     // Register the window class and call methods for instantiating drawing resources
     HRESULT Initialize();
 
@@ -29,30 +26,30 @@ public:
      */
     static Game* Instance();
 
-    /** Adds a view object to the game's render queue. The view objects's Initialize() gets called
-     *  after the game initializes. If the object is added after the game's initialization, Initialize() is called immediately.
-     *
-     * @param viewObject the viewObject to add. The Game doesn't take ownership of this object and the object has to make sure, it 
-     *                   exists at least until Deinitialize() gets called.
+    /** Enables camera tracking for the given view object
      */
-    void AddObject(ViewObject& viewObject);
+    void TrackObject(ViewObject& viewObject);
 
-    /** Returns the internal list of colliders for collision checks.
+    /** Adds all objects of the level to the game. The level itself is simulated by the SimulationThread (built from the
+     *  same level file) and the given level mirrors the simulated level's state to draw it.
      */
-    const std::vector<Collider*>& GetColliders() const;
+    void AddLevel(Level& level);
 
-    /** Returns a reference to the currently active input instance
+    /** Sets the input of the simulated level (a KeyboardInput by default). Must be called before Initialize().
      */
-    const Input& GetInput() const;
+    void SetSimulationInput(SimulationThread::InputFactory inputFactory);
 
-    /** Sets a new input device as the currently active and deletes the old input device
+    /** Sets the clock, which drives the frames and the simulation (a RealTimeClock by default). Must be called before Initialize().
      */
-    void SetInput(std::unique_ptr<Input>&& input);
+    void SetClock(std::unique_ptr<Clock>&& clock);
 
+    /** Sets the replay playback speed to 2^exponent (see SimulationThread::SetReplaySpeed())
+     */
+    void SetReplaySpeed(int exponent);
 
-    /** Enables camera tracking for the given view object
+    /** Limits the number of physics ticks, which are run at once (see SimulationThread::SetMaxTicksPerUpdate())
      */
-    void TrackObject(ViewObject& viewObject);
+    void SetMaxTicksPerUpdate(int maxTicks);
 private:
     /** Returns a (possibly new) brush for the given color. Used by Rendersurface
      */
@@ -85,6 +82,14 @@ private:
     // Opens a dialog to select a replay and loads it
     void LoadReplay(HWND dialogOwner);
 
+    /** Mirrors the simulation thread's latest frame into the game's objects
+     */
+    void ShowLatestFrame();
+
+    /** Shows the replay speed in the window title
+     */
+    void UpdateWindowTitle();
+
     // The current game instance
     static Game* instance;
 
@@ -93,26 +98,22 @@ private:
     Resource<ID2D1HwndRenderTarget> renderTarget;
     std::unique_ptr<GameRenderer> gameRenderer;
     std::unique_ptr<Camera> camera; // unique_ptr because we need to initialize it later (after the window has been created and the client area size is known)
-    bool initialized;
     
 
-    std::chrono::steady_clock::time_point simulationStartTime; // Basically the time when first calling OnRender()
-    /** Fixed phyics tick duration for the simulation. We hold it as int milliseconds per tick instead of 
-     *  a double seconds per tick to avoid imprecision when calculating expectedTicks=elapsedTime/SECONDS_PER_TICK,
-     *  which would get more and more inprecise the larger elapsed time becomes.
-     */
-    static const int MILLIS_PER_TICK; 
-    int gameTick; // The current game tick (used to control physics simulation speed)
-
-    // The currently active input instance
-    std::unique_ptr<Input> input;
+    int replaySpeedExponent; // replay speed = 2^replaySpeedExponent (as last set by the user)
 
     std::unordered_map<D2D1::ColorF::Enum, Resource<ID2D1Brush>> brushMap; // map of color -> brush
 
-    std::deque<ViewObject*> renderQueue; // List of objects, which get rendered on each draw
-    std::vector<Collider*> colliders; // List of colliders for faster direct access
-
     /** optional object, which should be tracked by the camera */
     ViewObject* trackObject;
+
+    Level* level; // the level added by AddLevel(), which shows the simulated level
+    MirrorInput* mirrorInput; // the game's input, which shows the simulated world's inputs (owned by the World)
+
+    std::unique_ptr<Clock> clock; // the time source of the frames and the simulation thread
+    Clock::time_point lastFrameTime;
+
+    SimulationThread::InputFactory simulationInput;
+    std::unique_ptr<SimulationThread> simulation; // created in Initialize() once the size of the game field is known
 };
 }
\ No newline at end of file
@@ -8,7 +8,7 @@
 
 namespace Lander {
 
-GameRenderer::GameRenderer(Game& game, Camera& camera, ID2D1HwndRenderTarget** ppRenderTarget) : game(game), camera(camera), ppRenderTarget(ppRenderTarget), viewObject(nullptr) {}
+GameRenderer::GameRenderer(Game& game, Camera& camera, ID2D1HwndRenderTarget** ppRenderTarget) : game(game), camera(camera), ppRenderTarget(ppRenderTarget), viewObject(nullptr), drawRotation(0) {}
 
 GameRenderer::~GameRenderer() {
   // cleanup
@@ -94,7 +94,7 @@ void GameRenderer::DrawImage(int resourceId, Rectangle targetRectangle) {
 void GameRenderer::DrawImage(int resourceId, Rectangle targetRectangle, float rotationAngle, bool rotateCenter) {
   D2D1::Matrix3x2F originalTransform;
   RenderTarget().GetTransform(&originalTransform);
-  auto rotationPoint = camera.WorldToScreen(viewObject->pos) + targetRectangle.topLeft;
+  auto rotationPoint = camera.WorldToScreen(drawPos) + targetRectangle.topLeft;
   if (rotateCenter) {
     rotationPoint += (targetRectangle.bottomRight - targetRectangle.topLeft) / 2; //rotation around center
   }
@@ -218,16 +218,19 @@ ID2D1RenderTarget& GameRenderer::RenderTarget() {
 }
 
 D2D1::Matrix3x2F GameRenderer::TranslationMatrix() const {
-  auto position = viewObject->GetScreenPosition(camera);
-  return D2D1::Matrix3x2F::Translation(position.x, position.y);
+  auto position = viewObject->GetScreenPosition(camera) + (drawPos - viewObject->pos); // the screen transformation is a pure translation
+  return Transform::Translation(position);
 }
 
 D2D1::Matrix3x2F GameRenderer::RotationMatrix() const {
-  return D2D1::Matrix3x2F::Rotation(viewObject->rotation, RotationCenter());
+  // Same rotation as used by ViewObject::ObjectToWorld() (Direct2D's Rotation() may round differently)
+  return Transform::Rotation(drawRotation, RotationCenter());
 }
 
-void GameRenderer::DrawObject(ViewObject* currentObject, double secondsPassed) {
+void GameRenderer::DrawObject(ViewObject* currentObject, double secondsPassed, float tickProgress) {
   viewObject = currentObject;
+  drawPos = viewObject->InterpolatedPos(tickProgress);
+  drawRotation = viewObject->InterpolatedRotation(tickProgress);
 
   // Set the object's translation to have object relative coordinates
   RenderTarget().SetTransform(TranslationMatrix() * RotationMatrix());
@@ -246,7 +249,7 @@ void GameRenderer::DrawObject(ViewObject* currentObject, double secondsPassed) {
 }
 
 Vector GameRenderer::RotationCenter() const {
-  return camera.WorldToScreen(viewObject->pos) + (viewObject->size.height/2 * Vector::Down) + (viewObject->size.width/2 * Vector::Right);
+  return camera.WorldToScreen(drawPos) + (viewObject->size.height/2 * Vector::Down) + (viewObject->size.width/2 * Vector::Right);
 }
 
 GameRenderer::FONT_ENTRY::FONT_ENTRY(const wchar_t* fontName, float fontSize, IDWriteTextFormat* format) : fontName(fontName), fontSize(fontSize), textFormat(format) {}
@@ -55,8 +55,10 @@ class GameRenderer : public RenderInterface {
   virtual ID2D1RenderTarget& RenderTarget() override;
 
   /** Sets the given object as current view object, draws the bounding box and calls Draw() upon it.
+   *
+   * @param tickProgress passed fraction of the current physics tick to draw the object at its interpolated position (see ViewObject::InterpolatedPos())
    */
-  void DrawObject(ViewObject* viewObject, double secondsPassed);
+  void DrawObject(ViewObject* viewObject, double secondsPassed, float tickProgress = 1.0f);
 
 private:  
 
@@ -110,6 +112,8 @@ private:
   
   
   ViewObject* viewObject; //the currently drawn view object
+  Vector drawPos;         //the interpolated position of the currently drawn view object
+  float drawRotation;     //the interpolated rotation of the currently drawn view object
 
 };
 
@@ -0,0 +1,197 @@
+#include "stdafx.h"
+#include "GravitySolver.hpp"
+#include "PhysicsObject.hpp"
+
+namespace Lander {
+
+namespace {
+
+const int LEVELS = 16; // bits per coordinate of the Z-order codes
+
+/** Spreads the lower 16 bits of the value to the even bits
+ */
+uint32_t SpreadBits(uint32_t value) {
+  value = (value | (value << 8)) & 0x00ff00ffu;
+  value = (value | (value << 4)) & 0x0f0f0f0fu;
+  value = (value | (value << 2)) & 0x33333333u;
+  value = (value | (value << 1)) & 0x55555555u;
+  return value;
+}
+
+}
+
+
+void GravitySolver::Add(PhysicsObject& body) {
+  bodies.push_back(&body);
+}
+
+void GravitySolver::AddWell(Vector position, float mass) {
+  wellPositions.push_back(position);
+  wellMasses.push_back(mass);
+}
+
+void GravitySolver::Apply() {
+  targets.clear();
+  pointX.clear();
+  pointY.clear();
+  pointMass.clear();
+  for (auto body : bodies) {
+    if (body->enabled) {
+      const Vector center = body->pos + body->Center();
+      targets.push_back(body);
+      pointX.push_back(center.x);
+      pointY.push_back(center.y);
+      pointMass.push_back(body->mass);
+    }
+  }
+  for (size_t i = 0; i < wellPositions.size(); ++i) {
+    pointX.push_back(wellPositions[i].x);
+    pointY.push_back(wellPositions[i].y);
+    pointMass.push_back(wellMasses[i]);
+  }
+  if (targets.empty()) {
+    return;
+  }
+
+  accelerationX.resize(pointX.size());
+  accelerationY.resize(pointX.size());
+  Solve(pointX.data(), pointY.data(), pointMass.data(), pointX.size(), accelerationX.data(), accelerationY.data());
+  for (size_t i = 0; i < targets.size(); ++i) {
+    targets[i]->ApplyAcceleration(Vector(accelerationX[i], accelerationY[i]));
+  }
+}
+
+void GravitySolver::Build(const float* x, const float* y, const float* mass, size_t count) {
+  float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+  for (size_t i = 1; i < count; ++i) {
+    minX = std::min(minX, x[i]);
+    maxX = std::max(maxX, x[i]);
+    minY = std::min(minY, y[i]);
+    maxY = std::max(maxY, y[i]);
+  }
+  const float size = std::max(std::max(maxX - minX, maxY - minY), 1.0f) * 1.001f; // so the largest coordinate stays below 2^LEVELS
+  const float scale = (1 << LEVELS) / size;
+
+  codes.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t cellX = std::min(static_cast<uint32_t>((x[i] - minX) * scale), (1u << LEVELS) - 1);
+    const uint32_t cellY = std::min(static_cast<uint32_t>((y[i] - minY) * scale), (1u << LEVELS) - 1);
+    codes[i] = static_cast<uint64_t>(SpreadBits(cellX) | (SpreadBits(cellY) << 1)) << 32 | i;
+  }
+  std::sort(codes.begin(), codes.end());
+
+  // Points, which are close to each other, now lie next to each other
+  const float massScale = G * PhysicsObject::PIXEL_PER_METER * PhysicsObject::PIXEL_PER_METER;
+  sortedX.resize(count);
+  sortedY.resize(count);
+  sortedMass.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t index = static_cast<uint32_t>(codes[i]);
+    sortedX[i] = x[index];
+    sortedY[i] = y[index];
+    sortedMass[i] = mass[index] * massScale;
+  }
+
+  nodes.clear();
+  BuildNode(0, static_cast<uint32_t>(count), LEVELS - 1, size);
+}
+
+void GravitySolver::BuildNode(uint32_t begin, uint32_t end, int level, float size) {
+  const uint32_t index = static_cast<uint32_t>(nodes.size());
+  nodes.push_back({ 0, 0, 0, size, begin, end, 0 });
+
+  float mass = 0, momentX = 0, momentY = 0;
+  if (end - begin <= LEAF_SIZE || level < 0) { // level < 0: all points are in the same cell of the finest grid
+    for (uint32_t i = begin; i < end; ++i) {
+      mass += sortedMass[i];
+      momentX += sortedMass[i] * sortedX[i];
+      momentY += sortedMass[i] * sortedY[i];
+    }
+  } else {
+    // The codes of the node share all bits above the level, so its quadrants are consecutive ranges
+    const int shift = 32 + 2 * level;
+    uint32_t quadrantBegin = begin;
+    for (uint64_t quadrant = 0; quadrant < 4 && quadrantBegin < end; ++quadrant) {
+      const uint32_t quadrantEnd = static_cast<uint32_t>(std::partition_point(codes.begin() + quadrantBegin, codes.begin() + end,
+        [shift, quadrant](uint64_t code) { return ((code >> shift) & 3) <= quadrant; }) - codes.begin());
+      if (quadrantEnd > quadrantBegin) {
+        const uint32_t child = static_cast<uint32_t>(nodes.size());
+        BuildNode(quadrantBegin, quadrantEnd, level - 1, size / 2);
+        mass += nodes[child].mass;
+        momentX += nodes[child].mass * nodes[child].x;
+        momentY += nodes[child].mass * nodes[child].y;
+      }
+      quadrantBegin = quadrantEnd;
+    }
+  }
+
+  Node& node = nodes[index];
+  node.mass = mass;
+  node.x = mass > 0 ? momentX / mass : sortedX[begin];
+  node.y = mass > 0 ? momentY / mass : sortedY[begin];
+  node.next = static_cast<uint32_t>(nodes.size());
+}
+
+void GravitySolver::Solve(const float* x, const float* y, const float* mass, size_t count, float* accelerationX, float* accelerationY) {
+  interactions = 0;
+  if (count == 0) {
+    return;
+  }
+  Build(x, y, mass, count);
+
+  const float openingAngle2 = openingAngle * openingAngle;
+  const float softening2 = softening * softening;
+  const uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+  sortedAccelerationX.resize(count);
+  sortedAccelerationY.resize(count);
+  uint64_t totalInteractions = 0;
+
+  // a = G * m * d / |d|³ in meters = G * m * PIXEL_PER_METER² * d / |d|³ in px (the masses are already scaled)
+  for (uint32_t target = 0; target < count; ++target) {
+    const float targetX = sortedX[target];
+    const float targetY = sortedY[target];
+    float sumX = 0, sumY = 0;
+    uint32_t i = 0;
+    while (i < nodeCount) {
+      const Node& node = nodes[i];
+      const float dx = node.x - targetX;
+      const float dy = node.y - targetY;
+      const float distance2 = dx * dx + dy * dy;
+      const bool contains = target >= node.begin && target < node.end; // a node is never approximated for its own points
+      if (!contains && node.size * node.size < openingAngle2 * distance2) {
+        const float r2 = distance2 + softening2;
+        const float strength = node.mass / (r2 * std::sqrt(r2));
+        sumX += dx * strength;
+        sumY += dy * strength;
+        ++totalInteractions;
+        i = node.next;
+      } else if (node.next == i + 1) {
+        for (uint32_t j = node.begin; j < node.end; ++j) {
+          if (j != target) {
+            const float pointDx = sortedX[j] - targetX;
+            const float pointDy = sortedY[j] - targetY;
+            const float r2 = pointDx * pointDx + pointDy * pointDy + softening2;
+            const float strength = sortedMass[j] / (r2 * std::sqrt(r2));
+            sumX += pointDx * strength;
+            sumY += pointDy * strength;
+          }
+        }
+        totalInteractions += node.end - node.begin;
+        i = node.next;
+      } else {
+        ++i; // open the node: its first child follows it
+      }
+    }
+    sortedAccelerationX[target] = sumX;
+    sortedAccelerationY[target] = sumY;
+  }
+  interactions = totalInteractions;
+
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t index = static_cast<uint32_t>(codes[i]);
+    accelerationX[index] = sortedAccelerationX[i];
+    accelerationY[index] = sortedAccelerationY[i];
+  }
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+namespace Lander {
+
+class PhysicsObject;
+
+/** Calculates the gravity, with which many bodies attract each other, with the Barnes-Hut algorithm (see World::Tick()).
+ *
+ *  The bodies are sorted along a Z-order curve and put into a quadtree, whose nodes hold the total mass and the center of mass of
+ *  the bodies below them. A node, which looks small from a body (size/distance < openingAngle), attracts the body with its total mass
+ *  at its center of mass. Only the closer nodes are opened, so each body interacts with O(log n) nodes instead of all other bodies and
+ *  a whole pass costs O(n log n) instead of O(n^2). An opening angle of 0 opens every node (exact), larger angles are faster and less
+ *  accurate. The nodes are stored in depth first order together with the index of the node after their subtree, so the tree is walked
+ *  without a stack and the bodies of a leaf lie next to each other in memory.
+ *
+ *  Besides the bodies, fixed gravity wells (planets, moons, ...) attract the bodies without being moved themselves.
+ */
+class GravitySolver {
+public:
+  static constexpr float G = 6.674e-11f;               // m³/(kg*s²)
+  static constexpr float DEFAULT_OPENING_ANGLE = 0.5f;
+  static constexpr float DEFAULT_SOFTENING = 5;        // px
+  static constexpr uint32_t LEAF_SIZE = 8;             // bodies, up to which a node isn't split
+
+  /** Registers a body, which attracts the other bodies with its mass and is attracted by them and the wells. Its center is its
+   *  position. Unlike the contact solver's bodies, the gravity's bodies are registered explicitly, because most objects of a world
+   *  only fall in the uniform gravity (see PhysicsObject::ApplyGravity()).
+   */
+  void Add(PhysicsObject& body);
+
+  /** Adds a fixed gravity well with the given center (px) and mass (kg)
+   */
+  void AddWell(Vector position, float mass);
+
+  /** Returns true if no body has been added
+   */
+  bool Empty() const { return bodies.empty(); }
+
+  /** Applies the gravity of all enabled bodies and the wells at their current positions to the enabled bodies (called by World::Tick()
+   *  before the objects are updated, see PhysicsObject::ApplyAcceleration())
+   */
+  void Apply();
+
+  /** Calculates the accelerations (m/s²), with which the given points attract each other (a point doesn't attract itself).
+   *
+   * @param x, y the positions of the points (px)
+   * @param mass the masses of the points (kg)
+   * @param accelerationX, accelerationY receive the accelerations of the points
+   */
+  void Solve(const float* x, const float* y, const float* mass, size_t count, float* accelerationX, float* accelerationY);
+
+  float openingAngle = DEFAULT_OPENING_ANGLE;
+  float softening = DEFAULT_SOFTENING; // px added to all distances, so close bodies don't get arbitrarily large accelerations
+
+  /** Returns the number of nodes of the quadtree of the last Solve()
+   */
+  size_t NodeCount() const { return nodes.size(); }
+
+  /** Returns the number of interactions (of a point with a node or another point) of the last Solve()
+   */
+  uint64_t InteractionCount() const { return interactions; }
+
+private:
+  // A node of the quadtree. The points below it are sortedX/Y/Mass[begin, end). A leaf is followed directly by the next node
+  // (next == its index + 1), the children of an inner node follow it.
+  struct Node {
+    float x, y;    // center of mass (px)
+    float mass;    // total mass times G * PIXEL_PER_METER² (see Solve())
+    float size;    // edge length (px)
+    uint32_t begin, end;
+    uint32_t next; // the index of the node after the subtree
+  };
+
+  /** Sorts the points along the Z-order curve and builds the tree
+   */
+  void Build(const float* x, const float* y, const float* mass, size_t count);
+
+  /** Appends the node with the points [begin, end) of the sorted codes, whose quadrant is given by the bits at level, and its subtree
+   */
+  void BuildNode(uint32_t begin, uint32_t end, int level, float size);
+
+  std::vector<PhysicsObject*> bodies;
+  std::vector<Vector> wellPositions;
+  std::vector<float> wellMasses;
+
+  // The tree of the last Solve()
+  std::vector<uint64_t> codes; // Z-order code << 32 | index of the point, sorted
+  std::vector<float> sortedX, sortedY, sortedMass;
+  std::vector<Node> nodes;
+  std::vector<float> sortedAccelerationX, sortedAccelerationY;
+  uint64_t interactions = 0;
+
+  // The points of Apply() (bodies first, then the wells)
+  std::vector<PhysicsObject*> targets;
+  std::vector<float> pointX, pointY, pointMass, accelerationX, accelerationY;
+};
+
+}
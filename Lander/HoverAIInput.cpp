@@ -1,7 +1,6 @@
 #include "stdafx.h"
 #include "HoverAIInput.hpp"
-
-extern bool KeyPressed(int key);
+#include "KeyboardInput.hpp"
 
 namespace Lander {
 
@@ -22,7 +21,7 @@ bool HoverAIInput::IsActive(Type type) const {
   }
 
   if (type == Type::Reset) {
-    return KeyPressed(VK_ESCAPE);
+    return KeyboardInput().IsActive(Type::Reset);
   }
 
   return false;
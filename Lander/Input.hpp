@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 namespace Lander {
 
 /** Basic input interface abstracting away concrete key presses into input
@@ -25,6 +27,46 @@ public:
    */
   virtual void Tick() {};
 
+  /** Returns true if the input can't provide any inputs for the upcoming ticks anymore (e.g. a completely played back replay).
+   *  Inputs, which are controlled by the user never finish.
+   */
+  virtual bool IsFinished() const { return false; }
+
+  /** Returns for how many of the upcoming ticks (at least 1) the inputs are known to stay the same as in the next tick,
+   *  so they can be simulated at once (see World::Tick())
+   */
+  virtual int UnchangedTicks() const { return 1; }
+
+  /** Returns the integrator the inputs have been recorded with (see Recorder::SaveReplay()). The rocket switches to it on every reset.
+   */
+  virtual Integrator RecordedIntegrator() const { return Integrator::AverageVelocity; }
+
+  /** Returns the seed of the wind field the inputs have been recorded with (see Recorder::SaveReplay()) or nothing, if the inputs
+   *  aren't recorded and the level's wind should blow. The rocket switches to it on every reset.
+   */
+  virtual std::optional<uint32_t> RecordedWindSeed() const { return std::nullopt; }
+
+  /** Returns the identity of the level the inputs have been recorded in (see LevelFile::Identity()) or nothing, if it isn't known
+   */
+  virtual std::optional<uint32_t> RecordedLevel() const { return std::nullopt; }
+
+  /** The playback position of inputs, which replay a prerecorded input sequence
+   */
+  struct Snapshot {
+    int32_t position; // index of the current entry
+    int32_t tick;     // tick within the current entry
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  /** Returns the current playback position. Inputs without a playback position (like the keyboard) return an empty snapshot.
+   */
+  virtual Snapshot TakeSnapshot() const { return { 0, 0 }; }
+
+  /** Moves the playback position back to the given snapshot
+   */
+  virtual void Restore(const Snapshot& snapshot) {}
+
   /** Returns a combination of all currently made inputs in a single number.
    *  Use the Input::Type values to check for single inputs.
    */
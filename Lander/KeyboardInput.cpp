@@ -1,32 +1,56 @@
 #include "stdafx.h"
 #include "KeyboardInput.hpp"
 
+#include <atomic>
 
+namespace {
+
+// Combination of Input::Type values, which were active during the last Poll()
+std::atomic<int> polledInputs = 0;
+
+}
+
+
+#ifdef _WIN32
 bool KeyPressed(int key) {
   // Don't know why, but GetAsyncKeyState() doesn't work correctly when called too often
   return (GetKeyState(key) & (1 << 7)) != 0;
 }
 
 
-bool Lander::KeyboardInput::IsActive(Type input) const {
-  switch (input) {
-    case Type::Reset:
-      return KeyPressed(VK_ESCAPE);
-      
-    case Type::Thrust:
-      return KeyPressed(VK_SPACE) || KeyPressed(VK_UP);
+void Lander::KeyboardInput::Poll() {
+  int inputs = 0;
 
-    case Type::RollLeft:
-      return KeyPressed(VK_LEFT) && !KeyPressed(VK_RIGHT);
+  if (KeyPressed(VK_ESCAPE)) {
+    inputs |= Type::Reset;
+  }
 
-    case Type::RollRight:
-      return KeyPressed(VK_RIGHT) && !KeyPressed(VK_LEFT);
+  if (KeyPressed(VK_SPACE) || KeyPressed(VK_UP)) {
+    inputs |= Type::Thrust;
+  }
 
-    case Type::SaveReplay:
-      return KeyPressed(VK_F5);
+  if (KeyPressed(VK_LEFT) && !KeyPressed(VK_RIGHT)) {
+    inputs |= Type::RollLeft;
   }
 
-  // only for unsupported inputs (which shouldn't exist)
-  return false;
+  if (KeyPressed(VK_RIGHT) && !KeyPressed(VK_LEFT)) {
+    inputs |= Type::RollRight;
+  }
+
+  if (KeyPressed(VK_F5)) {
+    inputs |= Type::SaveReplay;
+  }
+
+  polledInputs.store(inputs, std::memory_order_relaxed);
+}
+#else
+void Lander::KeyboardInput::Poll() {
+  // Headless builds have no keyboard
+}
+#endif
+
+
+bool Lander::KeyboardInput::IsActive(Type input) const {
+  return (polledInputs.load(std::memory_order_relaxed) & input) != 0;
 }
 
@@ -6,10 +6,17 @@ namespace Lander {
 
 /** Implements the input interface by checking keyboard key press states
  *  ESC, UP, SPACE, LEFT, RIGHT
+ *
+ *  The key states can only be read by the thread, which owns the window, so that thread has to call Poll() regularly.
+ *  IsActive() returns the key states of the last Poll() and may be called from any thread.
  */
 class KeyboardInput : public Input {
 public:
   virtual bool IsActive(Type type) const override;
+
+  /** Reads the current key states. Must be called from the window's thread.
+   */
+  static void Poll();
 };
 
 
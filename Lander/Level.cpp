@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "Level.hpp"
+
+namespace Lander {
+
+Level::Level(const LevelFile& file) :
+  file(file),
+  terrain(static_cast<Terrain::Interpolation>(file.GetHeader().interpolation), file.GetHeader().sampleSpacing, file.GetHeader().terrainSeed),
+  startPlatform(terrain, file.GetHeader().startPlatformX),
+  landingPlatform(terrain, file.GetHeader().landingPlatformX),
+  rocket(startPlatform, landingPlatform, screenText, timeCounter) {
+  const LevelFile::Header& header = file.GetHeader();
+  if (file.Heights()) {
+    terrain.SetHeights(file.Heights(), header.heightCount, header.firstHeightX, header.heightSpacing);
+  }
+  rocket.gravity = header.gravity;
+  rocket.spawnOffset = Vector(header.spawnOffsetX, header.spawnOffsetY);
+  rocket.refuelRate = header.refuelRate;
+  rocket.SetStartFuel(header.startFuel);
+  rocket.SetWindSeed(header.windSeed);
+  rocket.levelIdentity = file.Identity();
+}
+
+void Level::AddTo(World& world) {
+  world.AddObject(terrain);
+  world.AddObject(startPlatform);
+  world.AddObject(landingPlatform);
+  world.AddObject(screenText);
+  world.AddObject(timeCounter);
+  world.AddObject(rocket);
+}
+
+Level::Snapshot Level::TakeSnapshot() const {
+  return { rocket.TakeSnapshot(), timeCounter.TakeSnapshot(), screenText.TakeSnapshot(), terrain.TakeSnapshot() };
+}
+
+void Level::Mirror(const Snapshot& snapshot) {
+  timeCounter.Restore(snapshot.timeCounter);
+  screenText.Restore(snapshot.screenText);
+  terrain.Mirror(snapshot.terrain);
+  rocket.Mirror(snapshot.rocket);
+}
+
+bool Level::Restore(const Snapshot& snapshot) {
+  timeCounter.Restore(snapshot.timeCounter);
+  screenText.Restore(snapshot.screenText);
+  terrain.Restore(snapshot.terrain);
+  return rocket.Restore(snapshot.rocket);
+}
+
+}
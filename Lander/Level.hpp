@@ -0,0 +1,65 @@
+#pragma once
+
+#include "World.hpp"
+#include "Terrain.hpp"
+#include "Platform.hpp"
+#include "Rocket.hpp"
+#include "LevelFile.hpp"
+
+namespace Lander {
+
+/** The objects of the game's level: the terrain, both platforms, the rocket and the rocket's screen text and time counter.
+ *  The level is shared by the game (main.cpp) and the headless Simulation to make sure both simulate exactly the same level.
+ *  Its layout comes from a level file (see LevelFile).
+ */
+class Level {
+public:
+  /** Builds the level stored in the given file, which must outlive the level
+   */
+  explicit Level(const LevelFile& file = LevelFile::BuiltIn());
+
+  /** Returns the file the level has been built from
+   */
+  const LevelFile& File() const { return file; }
+
+  /** Adds all level objects to the given world. The update order of the objects is the insertion order, so this
+   *  must be called at the same point for every world, which should simulate the level identically.
+   */
+  void AddTo(World& world);
+
+  /** The state of all level objects, which change during the simulation (see Rocket::Snapshot and Terrain::Snapshot)
+   */
+  struct Snapshot {
+    Rocket::Snapshot rocket;
+    TimeCounter::Snapshot timeCounter;
+    ScreenText::Snapshot screenText;
+    Terrain::Snapshot terrain;
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  Snapshot TakeSnapshot() const;
+
+  /** Restores all level objects to the given snapshot without allocating (unless a crater has to be carved again).
+   *
+   * @return false if the rocket's input recording couldn't be restored (see Recorder::Restore())
+   */
+  bool Restore(const Snapshot& snapshot);
+
+  /** Shows the state of a level, which is simulated somewhere else (see Rocket::Mirror())
+   */
+  void Mirror(const Snapshot& snapshot);
+
+private:
+  const LevelFile& file; // initialized before the level objects, which are built from it
+
+public:
+  Terrain terrain;
+  Platform startPlatform;
+  Platform landingPlatform;
+  ScreenText screenText;
+  TimeCounter timeCounter;
+  Rocket rocket;
+};
+
+}
@@ -0,0 +1,241 @@
+#include "stdafx.h"
+#include "LevelFile.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Lander {
+
+namespace {
+
+[[noreturn]] void Invalid(const char* reason) {
+  throw std::runtime_error(std::string("Invalid level file: ") + reason);
+}
+
+bool IsFinite(float value) {
+  return std::isfinite(value);
+}
+
+}
+
+
+LevelFile::LevelFile(const std::filesystem::path& file) {
+#ifdef _WIN32
+  HANDLE handle = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to open the level file");
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+    CloseHandle(handle);
+    Invalid("empty");
+  }
+  mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(handle); // the mapping keeps the file open
+  if (!mapping) {
+    throw std::runtime_error("Failed to map the level file");
+  }
+  mappedData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!mappedData) {
+    CloseHandle(mapping);
+    throw std::runtime_error("Failed to map the level file");
+  }
+  mappedSize = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open the level file");
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size == 0) {
+    close(fd);
+    Invalid("empty");
+  }
+  void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Failed to map the level file");
+  }
+  mappedData = data;
+  mappedSize = static_cast<size_t>(status.st_size);
+#endif
+
+  try {
+    Attach(mappedData, mappedSize);
+  } catch (...) {
+    Unmap();
+    throw;
+  }
+}
+
+LevelFile::LevelFile(const void* data, size_t size) {
+  Attach(data, size);
+}
+
+LevelFile::~LevelFile() {
+  Unmap();
+}
+
+LevelFile::LevelFile(LevelFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+LevelFile& LevelFile::operator=(LevelFile&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    header = std::exchange(other.header, nullptr);
+    heights = std::exchange(other.heights, nullptr);
+    identity = other.identity.exchange(0);
+    mappedData = std::exchange(other.mappedData, nullptr);
+    mappedSize = std::exchange(other.mappedSize, 0);
+#ifdef _WIN32
+    mapping = std::exchange(other.mapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+void LevelFile::Unmap() {
+  if (!mappedData) {
+    return;
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(mappedData);
+  CloseHandle(mapping);
+  mapping = nullptr;
+#else
+  munmap(const_cast<void*>(mappedData), mappedSize);
+#endif
+  mappedData = nullptr;
+  mappedSize = 0;
+}
+
+void LevelFile::Attach(const void* data, size_t size) {
+  if constexpr (std::endian::native != std::endian::little) {
+    Invalid("only little endian machines can use level files in place");
+  }
+  if (reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0) {
+    Invalid("not aligned");
+  }
+  // The fields every version has
+  const size_t versionedSize = offsetof(Header, fileSize);
+  if (size < versionedSize || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+    Invalid("not a level file");
+  }
+  const Header& candidate = *static_cast<const Header*>(data);
+  if (candidate.version == 0 || candidate.version > VERSION) {
+    Invalid("unknown version");
+  }
+  if (candidate.headerSize < sizeof(Header) || size < candidate.headerSize) {
+    Invalid("truncated header");
+  }
+  if (candidate.fileSize != size) {
+    Invalid("truncated file");
+  }
+
+  const float* candidateHeights = nullptr;
+  switch (static_cast<TerrainKind>(candidate.terrainKind)) {
+    case TerrainKind::Profile:
+      break;
+    case TerrainKind::Heights:
+      if (candidate.heightCount < 2 || !(candidate.heightSpacing > 0) || !IsFinite(candidate.heightSpacing) || !IsFinite(candidate.firstHeightX)) {
+        Invalid("bad heights");
+      }
+      if (candidate.heightsOffset % alignof(float) != 0 || candidate.heightsOffset > size
+          || (size - candidate.heightsOffset) / sizeof(float) < candidate.heightCount) {
+        Invalid("heights out of bounds");
+      }
+      candidateHeights = reinterpret_cast<const float*>(static_cast<const char*>(data) + candidate.heightsOffset);
+      break;
+    default:
+      Invalid("unknown terrain kind");
+  }
+  if (candidate.interpolation > 1 || !(candidate.sampleSpacing > 0) || !IsFinite(candidate.sampleSpacing)) {
+    Invalid("bad terrain sampling");
+  }
+  for (float value : { candidate.startPlatformX, candidate.landingPlatformX, candidate.spawnOffsetX, candidate.spawnOffsetY, candidate.gravity }) {
+    if (!IsFinite(value)) {
+      Invalid("bad rocket or platform settings");
+    }
+  }
+  if (!(candidate.startFuel >= 0 && candidate.startFuel <= 1) || !(candidate.refuelRate >= 0) || !IsFinite(candidate.refuelRate)) {
+    Invalid("bad fuel settings");
+  }
+
+  header = &candidate;
+  heights = candidateHeights;
+}
+
+uint32_t LevelFile::Identity() const {
+  uint32_t hash = identity.load(std::memory_order_relaxed);
+  if (hash == 0) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(header);
+    hash = 2166136261u;
+    for (uint64_t i = 0; i < header->fileSize; ++i) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    hash = std::max(hash, 1u); // 0 stands for not calculated yet
+    identity.store(hash, std::memory_order_relaxed);
+  }
+  return hash;
+}
+
+LevelFile::Header LevelFile::DefaultHeader() {
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.headerSize = sizeof(Header);
+  header.fileSize = sizeof(Header);
+  header.terrainSeed = 0;
+  header.terrainKind = static_cast<uint32_t>(TerrainKind::Profile);
+  header.interpolation = 0; // Terrain::Interpolation::Linear
+  header.sampleSpacing = 1;
+  header.startPlatformX = 162;
+  header.landingPlatformX = 835;
+  header.spawnOffsetX = 0;
+  header.spawnOffsetY = 0;
+  header.gravity = PhysicsObject::GRAVITY;
+  header.startFuel = 1;
+  header.refuelRate = 30;
+  header.windSeed = 0;
+  return header;
+}
+
+const LevelFile& LevelFile::BuiltIn() {
+  static const Header header = DefaultHeader();
+  static const LevelFile builtIn(&header, sizeof(header));
+  return builtIn;
+}
+
+void LevelFile::Write(const std::filesystem::path& file, Header header, const float* heights) {
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.headerSize = sizeof(Header);
+  const bool hasHeights = static_cast<TerrainKind>(header.terrainKind) == TerrainKind::Heights;
+  if (!hasHeights) {
+    header.heightCount = 0;
+  }
+  header.heightsOffset = hasHeights ? sizeof(Header) : 0;
+  header.fileSize = sizeof(Header) + header.heightCount * sizeof(float);
+
+  std::ofstream stream(file, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (hasHeights) {
+    stream.write(reinterpret_cast<const char*>(heights), header.heightCount * sizeof(float));
+  }
+  if (!stream) {
+    throw std::runtime_error("Failed to write the level file");
+  }
+}
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+
+namespace Lander {
+
+/** A level stored in a binary file (.lvl). The file is mapped into memory and used in place: opening it only checks the header
+ *  and the bounds of the height array, nothing is parsed or copied, so a level can be opened thousands of times per second.
+ *
+ *  The file starts with the Header. All numbers are little endian and the offsets are counted from the start of the file.
+ *  A terrain of the kind Heights stores its height profile as heightCount floats at heightsOffset (4 byte aligned).
+ */
+class LevelFile {
+public:
+  static constexpr uint32_t VERSION = 1;
+  static constexpr char MAGIC[8] = { 'L', 'A', 'N', 'D', 'L', 'V', 'L', '\0' };
+
+  enum class TerrainKind : uint32_t {
+    Profile = 0, // the sum of sine curves (see Terrain), the classic one or one generated from terrainSeed
+    Heights = 1  // the stored heights, linearly interpolated
+  };
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;      // sizeof(Header) of the writing version (later versions append fields)
+    uint64_t fileSize;
+
+    // Terrain
+    uint64_t terrainSeed;     // Profile: 0 for the classic terrain
+    uint32_t terrainKind;     // TerrainKind
+    uint32_t interpolation;   // Terrain::Interpolation
+    float sampleSpacing;      // px between the samples of the terrain (see Terrain)
+    float heightSpacing;      // Heights: px between the stored heights
+    float firstHeightX;       // Heights: x of the first stored height
+    uint32_t heightCount;
+    uint64_t heightsOffset;
+
+    // Platforms (x of their centers)
+    float startPlatformX;
+    float landingPlatformX;
+
+    // Rocket
+    float spawnOffsetX;       // px from the rocket's position centered 1 px above the start platform
+    float spawnOffsetY;
+    float gravity;            // m/s²
+    float startFuel;          // 0-1, the tank's fill at the start and after a reset
+    float refuelRate;         // %/s while landed on the start platform
+    uint32_t windSeed;        // the rocket's WindField, 0 for no atmosphere (always 0 in files written before the wind)
+  };
+
+  /** Maps the level file into memory
+   *
+   * @throws std::runtime_error if the file can't be opened or isn't a valid level file of this or an earlier version
+   */
+  explicit LevelFile(const std::filesystem::path& file);
+
+  /** Uses a level file, which is already in memory (8 byte aligned, must outlive the LevelFile)
+   *
+   * @throws std::runtime_error if the data isn't a valid level file
+   */
+  LevelFile(const void* data, size_t size);
+
+  ~LevelFile();
+
+  LevelFile(LevelFile&& other) noexcept;
+  LevelFile& operator=(LevelFile&& other) noexcept;
+  LevelFile(const LevelFile&) = delete;
+  LevelFile& operator=(const LevelFile&) = delete;
+
+  const Header& GetHeader() const { return *header; }
+
+  /** Returns the stored heights of a Heights terrain (heightCount floats), nullptr for a Profile terrain
+   */
+  const float* Heights() const { return heights; }
+
+  /** Returns a hash (FNV-1a) of the whole file, which identifies the level (never 0). Saved replays record it (see Recorder::SaveReplay()),
+   *  so a Simulation refuses to replay them in a different level. Calculated upon the first call, so opening a level stays cheap.
+   */
+  uint32_t Identity() const;
+
+  /** The built-in level (the classic terrain and platforms)
+   */
+  static const LevelFile& BuiltIn();
+
+  /** Returns the header of the built-in level, which can be changed and written with Write()
+   */
+  static Header DefaultHeader();
+
+  /** Writes a level file. The version, sizes and offsets of the header are filled in.
+   *
+   * @param heights the heights of a Heights terrain (header.heightCount floats), ignored for a Profile terrain
+   * @throws std::runtime_error if the file can't be written
+   */
+  static void Write(const std::filesystem::path& file, Header header, const float* heights = nullptr);
+
+private:
+  /** Checks the header and fixes up the pointers into the data
+   */
+  void Attach(const void* data, size_t size);
+
+  void Unmap();
+
+  const Header* header = nullptr;
+  const float* heights = nullptr;
+  mutable std::atomic<uint32_t> identity{ 0 }; // 0 until Identity() has been called (the built-in level is used by several threads)
+
+  // The mapping of a file opened by the LevelFile (unmapped by the destructor)
+  const void* mappedData = nullptr;
+  size_t mappedSize = 0;
+#ifdef _WIN32
+  HANDLE mapping = nullptr;
+#endif
+};
+
+static_assert(sizeof(LevelFile::Header) == 96, "the header layout is part of the file format");
+
+}
@@ -0,0 +1,14 @@
+#include "stdafx.h"
+#include "MirrorInput.hpp"
+
+namespace Lander {
+
+bool MirrorInput::IsActive(Type type) const {
+  return (activeInputs & type) != 0;
+}
+
+void MirrorInput::SetActiveInputs(int inputs) {
+  activeInputs = inputs;
+}
+
+}
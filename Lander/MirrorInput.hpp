@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Input.hpp"
+
+namespace Lander {
+
+/** An input, which just returns the inputs it has been given. It is used to show the inputs of a world, which is simulated
+ *  somewhere else (see SimulationThread), e.g. to draw the rocket's thrust.
+ */
+class MirrorInput : public Input {
+public:
+  virtual bool IsActive(Type type) const override;
+
+  /** Sets the inputs, which should be active (combination of Input::Type values)
+   */
+  void SetActiveInputs(int inputs);
+
+private:
+  int activeInputs = 0;
+};
+
+}
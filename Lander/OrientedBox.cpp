@@ -0,0 +1,128 @@
+#include "stdafx.h"
+#include "OrientedBox.hpp"
+
+namespace Lander {
+
+namespace {
+
+/** A face of a box: the center of the face, its outward normal, the direction along the face and half of its length
+ */
+struct Face {
+  Vector center;
+  Vector normal;
+  Vector tangent;
+  float halfLength;
+};
+
+/** Returns the face of the box, whose outward normal is most parallel to the given direction
+ */
+Face SupportFace(const OrientedBox& box, Vector direction) {
+  float alongX = box.axisX * direction;
+  float alongY = box.axisY * direction;
+  if (std::abs(alongX) >= std::abs(alongY)) {
+    Vector normal = alongX >= 0 ? box.axisX : box.axisX * -1;
+    return { box.center + normal * box.halfSize.width, normal, box.axisY, box.halfSize.height };
+  }
+  Vector normal = alongY >= 0 ? box.axisY : box.axisY * -1;
+  return { box.center + normal * box.halfSize.height, normal, box.axisX, box.halfSize.width };
+}
+
+/** Clips the segment to the half plane (point * normal) <= offset
+ *
+ * @return the number of points left (0-2)
+ */
+int ClipSegment(std::array<Vector, 2>& segment, Vector normal, float offset) {
+  float distance0 = segment[0] * normal - offset;
+  float distance1 = segment[1] * normal - offset;
+
+  std::array<Vector, 2> clipped;
+  int count = 0;
+  if (distance0 <= 0) {
+    clipped[count++] = segment[0];
+  }
+  if (distance1 <= 0) {
+    clipped[count++] = segment[1];
+  }
+  if (distance0 * distance1 < 0) {
+    // The end points are on different sides -> add the intersection point
+    clipped[count++] = segment[0] + (segment[1] - segment[0]) * (distance0 / (distance0 - distance1));
+  }
+
+  segment = clipped;
+  return count;
+}
+
+}
+
+
+OrientedBox OrientedBox::FromTransform(const Transform& toWorld, Size size) {
+  OrientedBox box;
+  box.halfSize = Size(size.width / 2, size.height / 2);
+  box.center = toWorld(Vector(box.halfSize.width, box.halfSize.height));
+  box.axisX = Vector(toWorld.m11, toWorld.m21);
+  box.axisY = Vector(toWorld.m12, toWorld.m22);
+  return box;
+}
+
+float OrientedBox::ProjectedRadius(Vector axis) const {
+  return halfSize.width * std::abs(axisX * axis) + halfSize.height * std::abs(axisY * axis);
+}
+
+bool OrientedBox::Collide(const OrientedBox& other, ContactManifold& contact) const {
+  const Vector offset = other.center - center;
+  const std::array<Vector, 4> axes = { axisX, axisY, other.axisX, other.axisY };
+  // A box's projection onto its own axes is simply half its width or height
+  const std::array<float, 4> ownRadii = { halfSize.width, halfSize.height, other.halfSize.width, other.halfSize.height };
+
+  float minOverlap = std::numeric_limits<float>::infinity();
+  int minAxis = 0;
+  Vector normal;
+  for (int i = 0; i < 4; ++i) {
+    float distance = offset * axes[i];
+    float overlap = ownRadii[i] + (i < 2 ? other : *this).ProjectedRadius(axes[i]) - std::abs(distance);
+    if (overlap < 0) {
+      return false; // separating axis
+    }
+    if (overlap < minOverlap) { // ties keep the axes of this box
+      minOverlap = overlap;
+      minAxis = i;
+      normal = distance < 0 ? axes[i] * -1 : axes[i];
+    }
+  }
+
+  contact.normal = normal;
+  contact.depth = minOverlap;
+
+  // The box, whose axis separates least, provides the reference face. The contact points are the points of the
+  // other box's face (the incident face) clipped to the sides of the reference face, which lie behind it.
+  const bool ownAxis = minAxis < 2;
+  const OrientedBox& reference = ownAxis ? *this : other;
+  const OrientedBox& incident = ownAxis ? other : *this;
+  const Vector referenceNormal = ownAxis ? normal : normal * -1; // pointing out of the reference box towards the incident box
+  Face referenceFace = SupportFace(reference, referenceNormal);
+  Face incidentFace = SupportFace(incident, referenceNormal * -1);
+
+  std::array<Vector, 2> segment = { incidentFace.center + incidentFace.tangent * incidentFace.halfLength,
+                                    incidentFace.center - incidentFace.tangent * incidentFace.halfLength };
+  const float sideOffset = referenceFace.tangent * referenceFace.center;
+  int count = ClipSegment(segment, referenceFace.tangent, sideOffset + referenceFace.halfLength);
+  if (count == 2) {
+    count = ClipSegment(segment, referenceFace.tangent * -1, -sideOffset + referenceFace.halfLength);
+  }
+
+  contact.pointCount = 0;
+  const float faceOffset = referenceFace.normal * referenceFace.center;
+  for (int i = 0; i < count; ++i) {
+    if (segment[i] * referenceFace.normal - faceOffset <= 0) {
+      contact.points[contact.pointCount++] = segment[i];
+    }
+  }
+  if (contact.pointCount == 0) {
+    // Only possible through rounding with barely touching boxes -> take the center of the incident face
+    contact.points[contact.pointCount++] = incidentFace.center;
+  }
+
+  return true;
+}
+
+}
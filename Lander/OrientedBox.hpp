@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+
+namespace Lander {
+
+/** Where two colliders touch (see Collider::OnCollision())
+ */
+struct ContactManifold {
+  static const int MAX_POINTS = 2;
+
+  Vector normal; // unit vector pointing from the collider, which has been hit, towards the colliding object (the direction to push it out)
+  float depth = 0; // penetration depth along the normal
+  std::array<Vector, MAX_POINTS> points; // contact points in world coordinates
+  int pointCount = 0;
+  float time = 1; // fraction of the tick, at which both started to touch (see Collider::CheckCollisions(const Motion&)), 1 if only the end of the tick has been checked
+};
+
+/** A rotated rectangle in world coordinates
+ */
+class OrientedBox {
+public:
+  /** Returns the box of a rectangle of the given size at (0,0), which the given transformation maps into world coordinates
+   *  (see ViewObject::ObjectToWorldTransform())
+   */
+  static OrientedBox FromTransform(const Transform& toWorld, Size size);
+
+  /** Separating axis test of both boxes. Two rectangles are disjoint if and only if their projections onto one of the
+   *  four edge directions don't overlap, so only 4 axes have to be checked, which need no sine or cosine. Unlike checking
+   *  points of the outline, it finds every overlap. It costs about as much as checking 8 points, mostly for the contact manifold.
+   *
+   * @param contact filled with the axis of the least penetration as normal (pointing from this box towards other), the penetration
+   *                depth and the points of the incident edge, which lie inside the reference box, if both overlap
+   * @return true if both boxes overlap or touch
+   */
+  bool Collide(const OrientedBox& other, ContactManifold& contact) const;
+
+  /** Returns half the length of the projection of this box onto the given unit vector
+   */
+  float ProjectedRadius(Vector axis) const;
+
+  Vector center;
+  Vector axisX, axisY; // unit vectors along the rectangle's width and height
+  Size halfSize;
+};
+
+}
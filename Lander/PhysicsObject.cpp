@@ -5,31 +5,142 @@ namespace Lander {
 
 // The average rocket is 50m height, ours is 100px height...
 const float PhysicsObject::PIXEL_PER_METER = 2;
+const float PhysicsObject::GRAVITY = 9.81f;
 
 
-PhysicsObject::PhysicsObject() : angularVelocity(0), angularAcceleration(0), mass(0) {}
+PhysicsObject::PhysicsObject() : angularVelocity(0), angularAcceleration(0), mass(0), previousRotation(0) {}
 
 
 void PhysicsObject::Update(double secondsSinceLastFrame) {
+  previousPos = pos;
+  previousRotation = rotation;
+
   PhysicsUpdate(secondsSinceLastFrame);
   const float secondsPassed = static_cast<float>(secondsSinceLastFrame);
-  
-  // Apply acceleration (calculate velocities at end of frame)
-  velocity += acceleration * secondsPassed;
-  angularVelocity += angularAcceleration * secondsPassed;
-
-  // To update the position correctly we must calculate the average velocity of this frame
-  // and not just take the updated velocity because we just reached that velocity at the end of the frame.
-  auto avgVelocity = velocity - (acceleration * (secondsPassed / 2));
-  auto avgAngularVelocity = angularVelocity - (angularAcceleration * (secondsPassed / 2));
-
-  // Apply velocity
-  pos += avgVelocity * secondsPassed * PIXEL_PER_METER;
-  rotation += avgAngularVelocity * secondsPassed;
+  motion = { pos, pos, rotation, rotation, velocity, acceleration, angularVelocity, angularAcceleration, secondsPassed };
+
+  Integrate(secondsPassed);
+
+  if (continuousCollisions) {
+    motion.endPos = pos;
+    motion.endRotation = rotation;
+    CheckCollisions(motion);
+  }
   
   // Reset acceleration values
   acceleration = Vector::Zero;
   angularAcceleration = 0;
+  dragFactor = 0;
+}
+
+void PhysicsObject::Integrate(float secondsPassed) {
+  const float h = secondsPassed;
+  switch (integrator) {
+    case Integrator::AverageVelocity: {
+      // Apply acceleration (calculate velocities at end of frame)
+      velocity += acceleration * secondsPassed;
+      angularVelocity += angularAcceleration * secondsPassed;
+
+      // To update the position correctly we must calculate the average velocity of this frame
+      // and not just take the updated velocity because we just reached that velocity at the end of the frame.
+      auto avgVelocity = velocity - (acceleration * (secondsPassed / 2));
+      auto avgAngularVelocity = angularVelocity - (angularAcceleration * (secondsPassed / 2));
+
+      // Apply velocity
+      pos += avgVelocity * secondsPassed * PIXEL_PER_METER;
+      rotation += avgAngularVelocity * secondsPassed;
+      break;
+    }
+
+    case Integrator::SemiImplicitEuler:
+      velocity += acceleration * h;
+      angularVelocity += angularAcceleration * h;
+      pos += velocity * h * PIXEL_PER_METER;
+      rotation += angularVelocity * h;
+      break;
+
+    case Integrator::VelocityVerlet: {
+      pos += (velocity + acceleration * (h / 2)) * h * PIXEL_PER_METER;
+      rotation += (angularVelocity + angularAcceleration * (h / 2)) * h;
+      const Vector endAcceleration = AccelerationAt(h, velocity + acceleration * h, rotation);
+      velocity += (acceleration + endAcceleration) * (h / 2);
+      angularVelocity += angularAcceleration * h;
+      break;
+    }
+
+    case Integrator::RungeKutta4: {
+      // The angular acceleration is constant within a tick, so only the linear acceleration needs to be evaluated
+      const Vector v1 = velocity;
+      const float w1 = angularVelocity;
+      const Vector a1 = acceleration;
+      const Vector v2 = velocity + a1 * (h / 2);
+      const float w2 = angularVelocity + angularAcceleration * (h / 2);
+      const Vector a2 = AccelerationAt(h / 2, v2, rotation + w1 * (h / 2));
+      const Vector v3 = velocity + a2 * (h / 2);
+      const Vector a3 = AccelerationAt(h / 2, v3, rotation + w2 * (h / 2));
+      const Vector v4 = velocity + a3 * h;
+      const float w4 = angularVelocity + angularAcceleration * h;
+      const Vector a4 = AccelerationAt(h, v4, rotation + w2 * h);
+
+      pos += (v1 + (v2 + v3) * 2 + v4) * (h / 6 * PIXEL_PER_METER);
+      rotation += (w1 + w2 * 4 + w4) * (h / 6);
+      velocity += (a1 + (a2 + a3) * 2 + a4) * (h / 6);
+      angularVelocity = w4;
+      break;
+    }
+  }
+}
+
+Vector PhysicsObject::AccelerationAt(float seconds, Vector velocity, float rotation) const {
+  if (dragFactor == 0) {
+    return acceleration;
+  }
+  return acceleration - dragAcceleration + DragAcceleration(velocity);
+}
+
+Vector PhysicsObject::DragAcceleration(Vector velocity) const {
+  const Vector airspeed = velocity - dragWind;
+  return airspeed * -(dragFactor * airspeed.Length());
+}
+
+Vector Motion::PosAt(float fraction) const {
+  if (fraction >= 1) {
+    return endPos; // Update() calculates the end position a bit differently
+  }
+  const float t = seconds * fraction;
+  return startPos + (velocity * t + acceleration * (t * t / 2)) * PhysicsObject::PIXEL_PER_METER;
+}
+
+float Motion::RotationAt(float fraction) const {
+  if (fraction >= 1) {
+    return endRotation;
+  }
+  const float t = seconds * fraction;
+  return startRotation + angularVelocity * t + angularAcceleration * (t * t / 2);
+}
+
+Vector Motion::VelocityAt(float fraction) const {
+  return velocity + acceleration * (seconds * fraction);
+}
+
+float Motion::AngularVelocityAt(float fraction) const {
+  return angularVelocity + angularAcceleration * (seconds * fraction);
+}
+
+float Motion::MaxTravel(float radius) const {
+  // The distance along the path is at most |v|*t + |a|*t^2/2 (the same for the arc, on which the rotation moves a point)
+  const float translation = (velocity.Length() * seconds + acceleration.Length() * (seconds * seconds / 2)) * PhysicsObject::PIXEL_PER_METER;
+  const float turn = std::abs(angularVelocity) * seconds + std::abs(angularAcceleration) * (seconds * seconds / 2);
+  return translation + radius * turn * Vector::PI / 180;
+}
+
+
+Vector PhysicsObject::InterpolatedPos(float tickProgress) const {
+  return previousPos + (pos - previousPos) * tickProgress;
+}
+
+float PhysicsObject::InterpolatedRotation(float tickProgress) const {
+  return previousRotation + (rotation - previousRotation) * tickProgress;
 }
 
 void PhysicsObject::Stop() {
@@ -53,8 +164,22 @@ void PhysicsObject::ApplyForce(Vector force) {
   acceleration += force / mass; // F = m*a;  a = F/m
 }
 
-void PhysicsObject::ApplyGravity(Vector direction) {
-  this->acceleration += direction * 9.81f;
+void PhysicsObject::ApplyGravity(Vector direction, float gravity) {
+  this->acceleration += direction * gravity;
+}
+
+void PhysicsObject::ApplyDrag(Vector wind, float density, float dragArea) {
+  assert(mass != 0); // The drag is a force
+  dragWind = wind;
+  dragFactor = 0.5f * density * dragArea / mass;
+  dragAcceleration = DragAcceleration(velocity);
+  acceleration += dragAcceleration;
+}
+
+float PhysicsObject::MomentOfInertia() const {
+  const float width = size.width / PIXEL_PER_METER;
+  const float height = size.height / PIXEL_PER_METER;
+  return mass * (width * width + height * height) / 12;
 }
 
 
@@ -2,6 +2,47 @@
 
 namespace Lander {
 
+/** The movement of a physics object during one tick with constant accelerations (see PhysicsObject::Update())
+ */
+struct Motion {
+  Vector startPos, endPos;            // px
+  float startRotation, endRotation;   // °
+  Vector velocity;                    // m/s at the start of the tick
+  Vector acceleration;                // m/s²
+  float angularVelocity;              // °/s at the start of the tick
+  float angularAcceleration;          // °/s²
+  float seconds;                      // duration of the tick
+
+  /** Returns the position after the given fraction of the tick (0-1). The position at 1 is exactly endPos.
+   */
+  Vector PosAt(float fraction) const;
+
+  /** Returns the rotation after the given fraction of the tick (see PosAt())
+   */
+  float RotationAt(float fraction) const;
+
+  /** Returns the velocity (m/s) after the given fraction of the tick
+   */
+  Vector VelocityAt(float fraction) const;
+
+  /** Returns the angular velocity (°/s) after the given fraction of the tick
+   */
+  float AngularVelocityAt(float fraction) const;
+
+  /** Returns the longest distance (px), which a point within the given radius around the object's center travels during the tick
+   */
+  float MaxTravel(float radius) const;
+};
+
+/** How PhysicsObject::Update() advances the position and velocity over a tick. The values are stored in replays, so they must never change.
+ */
+enum class Integrator : uint8_t {
+  AverageVelocity = 0,   // moves with the average of the start and end velocity under the acceleration at the start of the tick (exact for constant accelerations)
+  SemiImplicitEuler = 1, // updates the velocity first and moves with the end velocity
+  VelocityVerlet = 2,    // moves like AverageVelocity and averages the accelerations at the start and at the end of the tick for the velocity
+  RungeKutta4 = 3        // classic 4th order Runge-Kutta (evaluates the acceleration at the start, twice in the middle and at the end of the tick)
+};
+
 /** This class implements an extended view object, which has a mass, a linear and angular velocitiy to which
  *  accelerations and forces can be applied.
  */
@@ -13,6 +54,10 @@ public:
    */
   static const float PIXEL_PER_METER;
 
+  /** The default gravitational acceleration (m/s²)
+   */
+  static const float GRAVITY;
+
   /** This method applies the defined accelerations to the current velocities 
    *  and applies the velocities to the current position of the object.
    *  The method is declared final to not override this behavior. To implement an
@@ -57,7 +102,29 @@ public:
    */
   void ApplyForce(Vector force);
 
-  void ApplyGravity(Vector direction = Vector::Down);
+  void ApplyGravity(Vector direction = Vector::Down, float gravity = GRAVITY);
+
+  /** Applies the air drag 0.5*density*dragArea*|v-wind|*(v-wind) of the object's velocity v relative to the wind (see WindField).
+   *  The drag is calculated for the velocity at the start of the tick. Integrators, which evaluate the acceleration again
+   *  within the tick, recalculate it for their velocities (see AccelerationAt()). Requires a non zero mass.
+   *
+   * @param wind the velocity of the air (m/s)
+   * @param density the density of the air (kg/m³)
+   * @param dragArea the drag coefficient times the reference area of the object (m²)
+   */
+  void ApplyDrag(Vector wind, float density, float dragArea);
+
+  /** Returns the moment of inertia (kg*m^2) of a solid rectangle of this object's size and mass around its center
+   */
+  float MomentOfInertia() const;
+
+  /** Blends between the position before and after the last Update()
+   */
+  virtual Vector InterpolatedPos(float tickProgress) const override;
+
+  /** Blends between the rotation before and after the last Update()
+   */
+  virtual float InterpolatedRotation(float tickProgress) const override;
 
 
   /////
@@ -70,6 +137,42 @@ public:
   float  angularAcceleration; // m/s²
 
   float mass; // kg
+
+  Integrator integrator = Integrator::AverageVelocity; // how Update() advances the object
+
+  // The position and rotation at the beginning of the last Update() (only used for drawing)
+  Vector previousPos;
+  float previousRotation;
+
+protected:
+  /** Returns the acceleration (m/s²) the given time (s) into the current tick with the given velocity and rotation. Integrators, which
+   *  evaluate the acceleration more than once per tick, call this. The acceleration at the start of the tick is always the one applied
+   *  in PhysicsUpdate(), so the default (that one for the whole tick) is right for all objects, whose forces don't change within a tick.
+   */
+  virtual Vector AccelerationAt(float seconds, Vector velocity, float rotation) const;
+
+  /** Returns the acceleration (m/s²) of the drag applied in this tick (see ApplyDrag()) at the given velocity
+   */
+  Vector DragAcceleration(Vector velocity) const;
+
+  /** If true, Update() checks the whole movement of the tick for collisions after moving the object (see Collider::CheckCollisions(const Motion&)),
+   *  so OnCollision() gets called with the time of impact and fast objects can't pass through thin colliders.
+   */
+  bool continuousCollisions = false;
+
+  /** The movement of the last Update() (only valid while continuousCollisions is set, e.g. to go back to the time of impact in OnCollision())
+   */
+  Motion motion = {};
+
+private:
+  /** Advances position, rotation and velocities by the given time with the selected integrator
+   */
+  void Integrate(float secondsPassed);
+
+  // The drag of the current tick (see ApplyDrag())
+  Vector dragWind;
+  float dragFactor = 0; // 0.5*density*dragArea/mass
+  Vector dragAcceleration;
 };
 
 }
@@ -31,7 +31,7 @@ void Recorder::StartRecording() {
     ticks = 0;
     lastInputs = 0;
     stopped = false;
-    recording.clear();
+    length = 0;
   }
 }
 
@@ -46,30 +46,83 @@ void Recorder::StopRecording() {
 
 void Recorder::RecordEntry() {
   if (ticks > 0) {
-    recording.push_back({ static_cast<uint8_t>(ticks), static_cast<uint8_t>(lastInputs) });
-    assert(recording.back().inputs != 0xFF);
+    Entry entry = { static_cast<uint8_t>(ticks), static_cast<uint8_t>(lastInputs) };
+    assert(entry.inputs != HEADER_INPUTS);
+
+    if (length < recording.size() && recording[length] != entry) {
+      // We took a different branch than before the last Restore() -> the old entries aren't part of this recording anymore
+      recording.resize(length);
+      stamps.resize(length);
+    }
+    if (length == recording.size()) {
+      recording.push_back(entry);
+      stamps.push_back(nextStamp++);
+    }
+    ++length;
+    ticks = 0;
+  }
+}
+
+
+Recorder::Snapshot Recorder::TakeSnapshot() const {
+  return { length, length > 0 ? stamps[length - 1] : 0, ticks, lastInputs, stopped };
+}
+
+bool Recorder::Restore(const Snapshot& snapshot) {
+  ticks = snapshot.ticks;
+  lastInputs = snapshot.lastInputs;
+  stopped = snapshot.stopped;
+
+  if (snapshot.length > recording.size() || (snapshot.length > 0 && stamps[snapshot.length - 1] != snapshot.lastStamp)) {
+    length = 0;
     ticks = 0;
+    stopped = true;
+    return false;
   }
+
+  length = snapshot.length;
+  return true;
 }
 
 
 
-void Recorder::SaveReplay() {
-  if (!stopped || recording.empty()) {
+void Recorder::SaveReplay(Integrator integrator, uint32_t windSeed, uint32_t level) {
+  if (!stopped || length == 0) {
     return; // nothing to save
   }
   auto now = std::chrono::system_clock::now();
   auto tt = std::chrono::system_clock::to_time_t(now);
   tm tmBuf;
+#ifdef _WIN32
   localtime_s(&tmBuf, &tt);
+#else
+  localtime_r(&tt, &tmBuf);
+#endif
   std::ostringstream filename;
-  filename << std::put_time(&tmBuf, "saves\\%FT%H%M%S.sav");
-  CreateDirectory(_T("saves"), nullptr); // create the saves directory unless it already exists
+  filename << std::put_time(&tmBuf, "%FT%H%M%S.sav");
+  std::filesystem::create_directory("saves"); // create the saves directory unless it already exists
+
+  WriteReplay(std::filesystem::path("saves") / filename.str(), recording.data(), length, integrator, windSeed, level);
+}
+
+bool Recorder::WriteReplay(const std::filesystem::path& file, const Entry* entries, size_t count, Integrator integrator, uint32_t windSeed,
+                           uint32_t level) {
+  std::vector<Entry> header = { { static_cast<uint8_t>(integrator), HEADER_INPUTS } };
+  if (windSeed != 0) {
+    for (int i = 0; i < 4; ++i) {
+      header.push_back({ static_cast<uint8_t>(windSeed >> (8 * i)), WIND_INPUTS });
+    }
+  }
+  if (level != 0) {
+    for (int i = 0; i < 4; ++i) {
+      header.push_back({ static_cast<uint8_t>(level >> (8 * i)), LEVEL_INPUTS });
+    }
+  }
 
-  std::ofstream file(filename.str().c_str(), std::ios::binary);
-  std::vector<Entry> copy(recording.begin(), recording.end());
-  file.write(reinterpret_cast<char*>(copy.data()), copy.size() * sizeof(Entry));
-  file.close();
+  std::ofstream stream(file, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(Entry));
+  stream.write(reinterpret_cast<const char*>(entries), count * sizeof(Entry));
+  return static_cast<bool>(stream);
 }
 
 }
\ No newline at end of file
@@ -13,13 +13,58 @@ public:
   void StartRecording();
   void StopRecording();
 
-  void SaveReplay();
+  /** Saves the recording into a new file in the saves folder. The file starts with a header entry (inputs HEADER_INPUTS, which no real
+   *  entry has), whose ticks hold the integrator the recording has been simulated with. Files without it are from before the
+   *  integrator could be selected and use Integrator::AverageVelocity. A recording with wind (seed not 0, see WindField) continues
+   *  with four entries with the inputs WIND_INPUTS, whose ticks hold the bytes of the seed (least significant first). Files without
+   *  them have been recorded without atmosphere. The identity of the level (see LevelFile::Identity()) follows in four entries with
+   *  the inputs LEVEL_INPUTS in the same way. Files without them have been recorded before the levels were identified.
+   */
+  void SaveReplay(Integrator integrator, uint32_t windSeed, uint32_t level);
 
   struct Entry {
     uint8_t ticks; // for how many ticks was the given input held down
     uint8_t inputs; // all keys fit into one byte
+
+    bool operator==(const Entry& other) const = default;
+  };
+
+  static constexpr uint8_t HEADER_INPUTS = 0xFF; // see SaveReplay()
+  static constexpr uint8_t WIND_INPUTS = 0xFE;
+  static constexpr uint8_t LEVEL_INPUTS = 0xFD;
+
+  /** Writes the given entries with the header of SaveReplay() into the given file
+   *
+   * @param level the identity of the level, 0 to leave it out
+   * @return false if the file couldn't be written
+   */
+  static bool WriteReplay(const std::filesystem::path& file, const Entry* entries, size_t count, Integrator integrator, uint32_t windSeed,
+                          uint32_t level);
+
+  /** The recorder's state without the recorded entries themselves. Entries are only ever appended, so the snapshot
+   *  just remembers how many entries have been recorded and the stamp of the last one to detect if it has been overwritten since.
+   */
+  struct Snapshot {
+    uint32_t length;    // number of recorded entries
+    uint32_t lastStamp; // write stamp of the entry at length-1 (0 if length is 0)
+    int32_t ticks;
+    int32_t lastInputs;
+    bool stopped;
+
+    bool operator==(const Snapshot& other) const = default;
   };
 
+  Snapshot TakeSnapshot() const;
+
+  /** Restores the recorder to the given snapshot without allocating. Entries recorded after the snapshot are kept until
+   *  a different entry is recorded at their position, so a snapshot can also be restored after restoring an earlier one
+   *  (e.g. when seeking back and forth in a replay).
+   *
+   * @return false if the snapshot's entries have been overwritten by a different branch since. In this case the recording
+   *         is discarded and the recorder is stopped.
+   */
+  bool Restore(const Snapshot& snapshot);
+
 private:
   /** Adds a new recording entry for the current input and ticks and resets the ticks value accordingly
    */
@@ -29,7 +74,12 @@ private:
   int ticks = 0; // for how many ticks have the last inputs been held down
   int lastInputs = 0; // the last held down inputs
 
-  std::list<Entry> recording;
+  // The recording consists of the first `length` entries. Entries beyond that are left over from before the last
+  // Restore() and are reused if the same inputs get recorded again.
+  std::vector<Entry> recording;
+  std::vector<uint32_t> stamps; // unique write stamp of each entry
+  uint32_t length = 0;
+  uint32_t nextStamp = 1;
 };
 
-}
\ No newline at end of file
+}
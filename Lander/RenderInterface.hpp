@@ -3,11 +3,39 @@
 // undef winapi macro to be able to jump to the correct definition for DrawText()
 #undef DrawText
 
+#ifndef _WIN32
+struct ID2D1RenderTarget; // only available on windows
+#endif
+
 namespace Lander {
 
+#ifdef _WIN32
 /** Typedef for simpler access to colors
  */
 typedef D2D1::ColorF::Enum Color;
+#else
+/** Headless builds have no Direct2D, so we mirror the colors of D2D1::ColorF::Enum, which are used by the game objects.
+ */
+struct ColorF {
+  enum Enum {
+    Black                = 0x000000,
+    White                = 0xFFFFFF,
+    Red                  = 0xFF0000,
+    Yellow               = 0xFFFF00,
+    Magenta              = 0xFF00FF,
+    Cyan                 = 0x00FFFF,
+    DarkRed              = 0x8B0000,
+    DarkGreen            = 0x006400,
+    DeepSkyBlue          = 0x00BFFF,
+    LightGray            = 0xD3D3D3,
+    LightGreen           = 0x90EE90,
+    LightSlateGray       = 0x778899,
+    LightGoldenrodYellow = 0xFAFAD2,
+    YellowGreen          = 0x9ACD32
+  };
+};
+typedef ColorF::Enum Color;
+#endif
 
 /** This objects of this class can be used by ViewObjects to draw themselves. They are
  *  only valid within the current Render() function.
@@ -24,7 +52,7 @@ public:
 
   /** Returns the size of the render target.
    */
-  virtual Size Size() = 0;
+  virtual Lander::Size Size() = 0;
 
   /** Creates a new text format with the given arguments, or returns an already existing format, which has been created with the same parameters.
    *  If a font resource file has been registered for this fontName, the font should be loaded from the resource file. Otherwise the
@@ -0,0 +1,49 @@
+#include "stdafx.h"
+#include "ReplayIndex.hpp"
+
+namespace Lander {
+
+ReplayIndex::ReplayIndex(World& world, Level& level, int interval) : world(world), level(level), interval(interval) {
+  assert(interval > 0);
+  const int firstTick = world.GameTick();
+
+  while (true) {
+    if ((world.GameTick() - firstTick) % interval == 0) {
+      keyframes.push_back({ world.TakeSnapshot(), level.TakeSnapshot() });
+    }
+    if (world.GetInput().IsFinished()) {
+      break;
+    }
+    world.Tick();
+  }
+
+  lastTick = world.GameTick();
+  Seek(firstTick);
+}
+
+int ReplayIndex::FirstTick() const {
+  return keyframes.front().world.gameTick;
+}
+
+int ReplayIndex::LastTick() const {
+  return lastTick;
+}
+
+int ReplayIndex::Seek(int tick) {
+  tick = std::clamp(tick, FirstTick(), LastTick());
+
+  // Only restore the keyframe if we can't get there faster by simply simulating forward from the current tick
+  const auto& keyframe = keyframes[(tick - FirstTick()) / interval];
+  if (world.GameTick() > tick || world.GameTick() < keyframe.world.gameTick) {
+    world.Restore(keyframe.world);
+    level.Restore(keyframe.level);
+  }
+
+  while (world.GameTick() < tick) {
+    world.Tick();
+  }
+
+  return tick;
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Level.hpp"
+
+namespace Lander {
+
+/** Allows jumping to any tick of a replay. Upon creation the replay is simulated once as fast as possible and a keyframe
+ *  (snapshot of the world and the level) is stored every few ticks. Seeking restores the closest keyframe before the
+ *  requested tick and simulates the remaining ticks from there, so a seek costs at most one keyframe interval of ticks
+ *  regardless of the replay's length.
+ */
+class ReplayIndex {
+public:
+  static const int DEFAULT_INTERVAL = 200; // one keyframe per simulated second
+
+  /** Simulates the world's current input until it is finished and stores a keyframe every interval ticks.
+   *  Afterwards the world is back at the tick it was in when calling the constructor.
+   *
+   * @param world a world, whose input is a freshly loaded ReplayInput
+   * @param level the level, which has been added to the world
+   * @param interval number of ticks between two keyframes
+   */
+  ReplayIndex(World& world, Level& level, int interval = DEFAULT_INTERVAL);
+
+  /** The tick the replay started at
+   */
+  int FirstTick() const;
+
+  /** The tick, in which the replay finished
+   */
+  int LastTick() const;
+
+  /** Brings the world and the level into the state they had in the given tick (clamped to [FirstTick(), LastTick()]).
+   *
+   * @return the tick, which has been seeked to
+   */
+  int Seek(int tick);
+
+private:
+  struct Keyframe {
+    World::Snapshot world;
+    Level::Snapshot level;
+  };
+
+  World& world;
+  Level& level;
+  const int interval;
+  int lastTick;
+  std::vector<Keyframe> keyframes; // keyframes[i] is the state in tick FirstTick() + i*interval
+};
+
+}
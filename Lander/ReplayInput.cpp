@@ -5,7 +5,7 @@
 
 namespace Lander {
 
-ReplayInput::ReplayInput(TCHAR* filePath) {
+ReplayInput::ReplayInput(const std::filesystem::path& filePath) {
   std::ifstream file(filePath, std::ios::binary);
   if (file) {
     file.seekg(0, std::ios::end);
@@ -13,9 +13,43 @@ ReplayInput::ReplayInput(TCHAR* filePath) {
     file.seekg(0, std::ios::beg);
 
     recording.resize((fileSize / sizeof(Recorder::Entry)) + 1);
-    file.read(reinterpret_cast<char*>(recording.data()+1), recording.size()*sizeof(Recorder::Entry));
+    file.read(reinterpret_cast<char*>(recording.data()+1), (recording.size()-1)*sizeof(Recorder::Entry));
     file.close();
 
+    if (recording.size() > 1 && recording[1].inputs == Recorder::HEADER_INPUTS) {
+      if (recording[1].ticks > static_cast<uint8_t>(Integrator::RungeKutta4)) {
+        throw std::runtime_error("The replay has been recorded with an unknown integrator");
+      }
+      integrator = static_cast<Integrator>(recording[1].ticks);
+      recording.erase(recording.begin() + 1);
+
+      // The bytes of the wind seed
+      size_t windBytes = 0;
+      while (windBytes < 4 && windBytes + 1 < recording.size() && recording[windBytes + 1].inputs == Recorder::WIND_INPUTS) {
+        windSeed |= static_cast<uint32_t>(recording[windBytes + 1].ticks) << (8 * windBytes);
+        ++windBytes;
+      }
+      if (windBytes != 0 && windBytes != 4) {
+        throw std::runtime_error("The replay has an incomplete wind seed");
+      }
+      recording.erase(recording.begin() + 1, recording.begin() + 1 + windBytes);
+
+      // The bytes of the level's identity
+      size_t levelBytes = 0;
+      uint32_t levelIdentity = 0;
+      while (levelBytes < 4 && levelBytes + 1 < recording.size() && recording[levelBytes + 1].inputs == Recorder::LEVEL_INPUTS) {
+        levelIdentity |= static_cast<uint32_t>(recording[levelBytes + 1].ticks) << (8 * levelBytes);
+        ++levelBytes;
+      }
+      if (levelBytes != 0 && levelBytes != 4) {
+        throw std::runtime_error("The replay has an incomplete level identity");
+      }
+      if (levelBytes == 4) {
+        level = levelIdentity;
+      }
+      recording.erase(recording.begin() + 1, recording.begin() + 1 + levelBytes);
+    }
+
     // Always start each recording with a reset input
     recording[0].inputs = static_cast<uint8_t>(Input::Reset);
     recording[0].ticks = 1;
@@ -23,7 +57,7 @@ ReplayInput::ReplayInput(TCHAR* filePath) {
     recordingPos = recording.data();
     recordingEnd = recordingPos + recording.size();
   } else {
-    throw std::exception("Failed to open the file");
+    throw std::runtime_error("Failed to open the file");
   }
 }
 
@@ -51,7 +85,7 @@ void ReplayInput::Tick() {
   }
   
   ++tick;
-  if (tick == recordingPos->ticks) {
+  if (tick >= recordingPos->ticks) { // >= to not get stuck on corrupted entries with 0 ticks
     // read next input
     ++recordingPos;
     tick = 0;
@@ -59,4 +93,51 @@ void ReplayInput::Tick() {
 }
 
 
+bool ReplayInput::IsFinished() const {
+  if (recordingPos == recordingEnd) {
+    return true;
+  }
+
+  // The last entry is finished once its ticks have been played back
+  return (recordingPos + 1 == recordingEnd) && (tick + 1 >= recordingPos->ticks);
+}
+
+
+int ReplayInput::UnchangedTicks() const {
+  if (recordingPos == recordingEnd) {
+    return 1;
+  }
+  if (tick + 1 < recordingPos->ticks) {
+    return recordingPos->ticks - (tick + 1); // the next tick stays in the current entry
+  }
+  if (recordingPos + 1 == recordingEnd) {
+    return 1; // the keyboard takes over
+  }
+  return std::max<int>(recordingPos[1].ticks, 1);
+}
+
+Integrator ReplayInput::RecordedIntegrator() const {
+  return recordingPos == recordingEnd ? KeyboardInput::RecordedIntegrator() : integrator;
+}
+
+std::optional<uint32_t> ReplayInput::RecordedWindSeed() const {
+  return recordingPos == recordingEnd ? KeyboardInput::RecordedWindSeed() : windSeed;
+}
+
+std::optional<uint32_t> ReplayInput::RecordedLevel() const {
+  return level;
+}
+
+
+Input::Snapshot ReplayInput::TakeSnapshot() const {
+  return { static_cast<int32_t>(recordingPos - recording.data()), tick };
+}
+
+void ReplayInput::Restore(const Snapshot& snapshot) {
+  assert(snapshot.position >= 0 && snapshot.position <= static_cast<int32_t>(recording.size()));
+  recordingPos = recording.data() + snapshot.position;
+  tick = snapshot.tick;
+}
+
+
 }
\ No newline at end of file
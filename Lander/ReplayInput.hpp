@@ -11,17 +11,48 @@ namespace Lander {
    */
   class ReplayInput : public KeyboardInput {
   public:
-    ReplayInput(TCHAR* filePath);
+    /** Loads the recording from the given save file
+     *
+     * @throws std::runtime_error if the file couldn't be opened, has been recorded with an unknown integrator or has a broken header
+     */
+    ReplayInput(const std::filesystem::path& filePath);
 
     virtual bool IsActive(Type type) const override;
 
     virtual void Tick() override;
 
+    /** Returns true if the next Tick() would move past the last recorded input
+     */
+    virtual bool IsFinished() const override;
+
+    /** Returns the remaining ticks of the entry, which the next Tick() moves to
+     */
+    virtual int UnchangedTicks() const override;
+
+    /** Returns the integrator from the file's header (see Recorder::SaveReplay()) until the replay has been aborted or finished
+     */
+    virtual Integrator RecordedIntegrator() const override;
+
+    /** Returns the wind seed from the file's header (0 for replays without wind) until the replay has been aborted or finished
+     */
+    virtual std::optional<uint32_t> RecordedWindSeed() const override;
+
+    /** Returns the level identity from the file's header (nothing for replays recorded before the levels were identified)
+     */
+    virtual std::optional<uint32_t> RecordedLevel() const override;
+
+    virtual Snapshot TakeSnapshot() const override;
+
+    virtual void Restore(const Snapshot& snapshot) override;
+
   private:
     int tick = -1;
     std::vector<Recorder::Entry> recording;
     Recorder::Entry* recordingPos = nullptr;
     Recorder::Entry* recordingEnd = nullptr;
+    Integrator integrator = Integrator::AverageVelocity;
+    uint32_t windSeed = 0;
+    std::optional<uint32_t> level;
   };
 
 
@@ -0,0 +1,26 @@
+#include "stdafx.h"
+#include "RigidBody.hpp"
+
+namespace Lander {
+
+
+RigidBody::RigidBody(Size size, float mass, float friction, float restitution) : friction(friction), restitution(restitution) {
+  this->size = size;
+  this->mass = mass;
+  // The contact solver corrects the velocity at the end of the tick and moves the body by the correction, which is exact for this integrator
+  integrator = Integrator::SemiImplicitEuler;
+}
+
+
+void RigidBody::PhysicsUpdate(double secondsSinceLastFrame) {
+  if (gravity) {
+    ApplyGravity();
+  }
+}
+
+void RigidBody::Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) {
+  renderTarget.FillRectangle(Rectangle(Vector::Zero, size), Color::LightSlateGray);
+}
+
+
+}
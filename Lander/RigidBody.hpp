@@ -0,0 +1,33 @@
+#pragma once
+
+namespace Lander {
+
+class ContactSolver;
+
+/** A rectangular physics object (e.g. debris), which falls with gravity and bounces, slides and comes to rest on the other colliders.
+ *  It doesn't check collisions itself: the world's ContactSolver finds its contacts after each tick and applies the impulses, which
+ *  push it out of the other colliders. Colliders, which aren't rigid bodies, are treated as immovable.
+ */
+class RigidBody : public PhysicsObject {
+  friend class ContactSolver;
+public:
+  /** @param size the size of the body (px)
+   *  @param mass the mass of the body (kg), 0 for a body, which can't be moved by contacts
+   *  @param friction the Coulomb friction coefficient
+   *  @param restitution the fraction of the speed, with which the body bounces off after an impact (0 = no bounce, 1 = elastic)
+   */
+  RigidBody(Size size, float mass, float friction = 0.5f, float restitution = 0.2f);
+
+  virtual void PhysicsUpdate(double secondsSinceLastFrame) override;
+
+  virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override;
+
+  float friction;
+  float restitution;
+  bool gravity = true; // whether PhysicsUpdate() applies the gravity
+
+private:
+  int32_t solverIndex = -1; // the index of this body in its world's ContactSolver
+};
+
+}
@@ -1,7 +1,8 @@
 #include "stdafx.h"
 #include "Rocket.hpp"
 #include "Platform.hpp"
-#include "Game.hpp"
+#include "Terrain.hpp"
+#include "World.hpp"
 
 namespace Lander {
 Rocket::Rocket(const Platform& startPlatform, const Platform& landingPlatform, ScreenText& screenText, TimeCounter& timeCounter) : startPlatform(startPlatform), landingPlatform(landingPlatform), screenText(screenText), timeCounter(timeCounter) {
@@ -9,9 +10,14 @@ Rocket::Rocket(const Platform& startPlatform, const Platform& landingPlatform, S
 }
 
 
+void Rocket::Initialize(Size size) {
+  wind.Generate(wind.Seed(), size.height);
+}
+
 void Rocket::Reposition() {
   pos = startPlatform.pos + Vector::Up * (size.height+1); // Calculate top position of rocket
   pos += Vector::Right * (startPlatform.size.width - size.width) / 2; // Center rocket on start platform
+  pos += spawnOffset;
 
   rotation = 0;
   Stop();
@@ -20,22 +26,35 @@ void Rocket::Reposition() {
 
 void Rocket::PhysicsUpdate(double secondsSinceLastFrame) {
   mass = baseMass + Tank.Mass();
+  updateTicks = std::max(1, static_cast<int>(std::lround(secondsSinceLastFrame / World::SECONDS_PER_TICK))); // see World::Tick()
 
-  auto& input = Game::Instance()->GetInput();
+  auto& input = world->GetInput();
 
   if (input.IsActive(Input::Reset)) {
     Reposition();
     state = STATE::UNSTARTED;
-    Tank.Refill();
+    Tank.Refill(startFuel);
+    integrator = input.RecordedIntegrator(); // a replay always starts with a reset
+    const uint32_t windSeed = input.RecordedWindSeed().value_or(levelWindSeed);
+    if (windSeed != wind.Seed()) {
+      wind.Generate(windSeed, wind.GroundY());
+    }
     timeCounter.ResetCount();
     recorder.StopRecording();
+    // The craters of earlier flights go away with the reset (the replays don't record them)
+    for (auto collider : world->GetColliders()) {
+      if (auto terrain = dynamic_cast<Terrain*>(collider)) {
+        terrain->RemoveCraters(0);
+      }
+    }
   }
 
   if (input.IsActive(Input::SaveReplay)) {
-    recorder.SaveReplay(); // only works if the recorder is stopped
+    recorder.SaveReplay(integrator, wind.Seed(), levelIdentity); // only works if the recorder is stopped
   }
 
 
+  thrust = 0;
   switch (state) {
 
     case STATE::CRASHED:
@@ -53,7 +72,7 @@ void Rocket::PhysicsUpdate(double secondsSinceLastFrame) {
       break;
 
     case STATE::LANDED:
-      Tank.Fill(static_cast<float>(2*secondsSinceLastAnimation));
+      Tank.Fill(static_cast<float>(refuelRate*secondsSinceLastFrame));
       [[fallthrough]];
 
     case STATE::UNSTARTED:
@@ -67,9 +86,10 @@ void Rocket::PhysicsUpdate(double secondsSinceLastFrame) {
       break;
 
     case STATE::STARTED:
-      CheckCollisions();
       if (input.IsActive(Input::Thrust)) {
-        ApplyForce((Vector::Up * Tank.GetThrust(static_cast<float>(secondsSinceLastFrame))).Rotate(rotation));
+        thrust = Tank.GetThrust(static_cast<float>(secondsSinceLastFrame));
+        thrustAcceleration = (Vector::Up * thrust).Rotate(rotation) / mass; // F = m*a;  a = F/m
+        ApplyAcceleration(thrustAcceleration);
       }
 
       if (input.IsActive(Input::RollLeft)) {
@@ -80,12 +100,24 @@ void Rocket::PhysicsUpdate(double secondsSinceLastFrame) {
         ApplyAngularAcceleration(angularAcceleration);
       }
 
-      ApplyGravity();  //pull rocket towards the ground with 9.81 m/s
+      ApplyGravity(Vector::Down, gravity);  //pull rocket towards the ground with 9.81 m/s
+
+      if (!wind.IsCalm()) {
+        // The wind and the air at the rocket's center, where the gusts have drifted to in this tick
+        const Vector center = pos + Center();
+        const WindField::Sample air = wind.At(center.x, center.y, wind.Offset(world->GameTick()));
+        ApplyDrag(air.wind, air.density, dragArea);
+      }
       break;
 
   }
 
-  recorder.RecordInput(input);
+  // Only a flying rocket collides. Update() checks the movement of the tick, so the rocket touches down at the exact time of impact.
+  continuousCollisions = (state == STATE::STARTED);
+
+  for (int i = 0; i < updateTicks; ++i) {
+    recorder.RecordInput(input);
+  }
 }
 
 void Rocket::Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) {
@@ -121,7 +153,7 @@ void Rocket::Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, d
   // Don't draw thrust animations if we had a collision
   if (state != STATE::CRASHED) {    
 
-    auto& input = Game::Instance()->GetInput();
+    auto& input = world->GetInput();
 
     ///
     // Main thrust (animated)
@@ -158,7 +190,61 @@ void Rocket::Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, d
   }
 }
 
-void Rocket::OnCollision(Collider& collider) {
+float Rocket::MaxAcceleration(float seconds) const {
+  const float airspeed = velocity.Length() + wind.MaxSpeed();
+  const float drag = wind.IsCalm() ? 0 : 0.5f * WindField::GROUND_DENSITY * dragArea * airspeed * airspeed;
+  if (Tank.IsEmpty()) {
+    return gravity + drag / (baseMass + Tank.Mass());
+  }
+  // The thrust accelerates the rocket more, the more fuel it burns
+  const float lightest = std::max(baseMass + Tank.Mass() - Tank.MassFlow() * seconds, baseMass);
+  return gravity + (Tank.MaxThrust() + drag) / lightest;
+}
+
+void Rocket::SetStartFuel(float fraction) {
+  startFuel = fraction;
+  Tank.Refill(startFuel);
+}
+
+void Rocket::SetWindSeed(uint32_t seed) {
+  levelWindSeed = seed;
+  wind.Generate(seed, wind.GroundY());
+}
+
+const WindField& Rocket::GetWind() const {
+  return wind;
+}
+
+Vector Rocket::AccelerationAt(float seconds, Vector velocity, float rotation) const {
+  const Vector withDrag = PhysicsObject::AccelerationAt(seconds, velocity, rotation);
+  if (thrust == 0) {
+    return withDrag;
+  }
+  return withDrag - thrustAcceleration + (Vector::Up * thrust).Rotate(rotation) / (mass - Tank.MassFlow() * seconds);
+}
+
+void Rocket::OnCollision(Collider& collider, const ContactManifold& contact) {
+  // Go back to the time of impact
+  pos = motion.PosAt(contact.time);
+  rotation = motion.RotationAt(contact.time);
+  velocity = motion.VelocityAt(contact.time);
+  angularVelocity = motion.AngularVelocityAt(contact.time);
+
+  state = CollisionOutcome(collider, velocity, rotation);
+  if (state == STATE::CRASHED || state == STATE::SUCCESS) {
+    timeCounter.StopCountAt(updateTicks == 1 ? contact.time : contact.time * updateTicks);
+  }
+
+  // A crash into the terrain leaves a crater below the rocket's center, which grows with the impact speed
+  Terrain* terrain = dynamic_cast<Terrain*>(&collider);
+  if (state == STATE::CRASHED && terrain) {
+    const Vector impact = terrain->GetTerrainPos(ObjectToWorldTransform()(Center()).x);
+    const float radius = std::min(craterRadius + craterRadiusPerSpeed * velocity.Length(), maxCraterRadius);
+    terrain->AddCrater({ impact.x, impact.y, radius, radius * craterDepth });
+  }
+}
+
+Rocket::STATE Rocket::CollisionOutcome(const Collider& collider, Vector velocity, float rotation) const {
   float rotationValue = rotation;
 
   while (rotationValue >= 357) {
@@ -172,16 +258,72 @@ void Rocket::OnCollision(Collider& collider) {
   // 8 m/s seems achievable, 1 m/s does not    
   // Rotation has to be between 3 and -3
   if ((velocity.Length() < 8) && (rotationValue <= 3 && rotationValue >= -3) && (&collider == &startPlatform)) {
-    state = STATE::LANDED;
-    return;
+    return STATE::LANDED;
   }
 
   if ((velocity.Length() < 8) && (rotationValue <= 3 && rotationValue >= -3) && (&collider == &landingPlatform)) {
-    state = STATE::SUCCESS;
-    return;
+    return STATE::SUCCESS;
   }
 
-  state = STATE::CRASHED;
+  return STATE::CRASHED;
+}
+
+Rocket::STATE Rocket::GetState() const {
+  return state;
+}
+
+const FuelTank& Rocket::GetTank() const {
+  return Tank;
+}
+
+Rocket::Snapshot Rocket::TakeSnapshot() const {
+  Snapshot snapshot;
+  snapshot.posX = pos.x;
+  snapshot.posY = pos.y;
+  snapshot.rotation = rotation;
+  snapshot.previousPosX = previousPos.x;
+  snapshot.previousPosY = previousPos.y;
+  snapshot.previousRotation = previousRotation;
+  snapshot.velocityX = velocity.x;
+  snapshot.velocityY = velocity.y;
+  snapshot.angularVelocity = angularVelocity;
+  snapshot.accelerationX = acceleration.x;
+  snapshot.accelerationY = acceleration.y;
+  snapshot.angularAcceleration = PhysicsObject::angularAcceleration; // hidden by the rocket's RCS acceleration
+  snapshot.mass = mass;
+  snapshot.fuelVolume = Tank.currentVolume;
+  snapshot.secondsSinceLastAnimation = secondsSinceLastAnimation;
+  snapshot.trailIndex = trailIndex;
+  snapshot.state = state;
+  snapshot.integrator = integrator;
+  snapshot.windSeed = wind.Seed();
+  snapshot.recorder = recorder.TakeSnapshot();
+  return snapshot;
+}
+
+void Rocket::Mirror(const Snapshot& snapshot) {
+  pos = Vector(snapshot.posX, snapshot.posY);
+  rotation = snapshot.rotation;
+  previousPos = Vector(snapshot.previousPosX, snapshot.previousPosY);
+  previousRotation = snapshot.previousRotation;
+  velocity = Vector(snapshot.velocityX, snapshot.velocityY);
+  angularVelocity = snapshot.angularVelocity;
+  acceleration = Vector(snapshot.accelerationX, snapshot.accelerationY);
+  PhysicsObject::angularAcceleration = snapshot.angularAcceleration;
+  mass = snapshot.mass;
+  Tank.currentVolume = snapshot.fuelVolume;
+  state = snapshot.state;
+  integrator = snapshot.integrator;
+  if (snapshot.windSeed != wind.Seed()) {
+    wind.Generate(snapshot.windSeed, wind.GroundY());
+  }
+}
+
+bool Rocket::Restore(const Snapshot& snapshot) {
+  Mirror(snapshot);
+  secondsSinceLastAnimation = snapshot.secondsSinceLastAnimation;
+  trailIndex = snapshot.trailIndex;
+  return recorder.Restore(snapshot.recorder);
 }
 
 
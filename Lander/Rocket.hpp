@@ -3,13 +3,19 @@
 #include "ScreenText.hpp"
 #include "TimeCounter.hpp"
 #include "Recorder.hpp"
+#include "WindField.hpp"
 
 namespace Lander {
 class Platform;
 class Rocket : public PhysicsObject {
+  friend class RocketBatch; // simulates the same flight logic for many rockets at once
 public:
   Rocket(const Platform& startPlatform, const Platform& landingPlatform, ScreenText& screenText, TimeCounter& timeCounter);
 
+  /** Puts the ground of the wind field at the bottom of the game field
+   */
+  virtual void Initialize(Size size) override;
+
   /** Update method used to adapt own position to the platforms's position if it changes.
    *  This is only necessary until the rocket receives it's first user input (thrust)
    */
@@ -17,10 +23,88 @@ public:
 
   virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override;
 
+  enum class STATE {UNSTARTED, STARTED, CRASHED, LANDED, SUCCESS};
+
+  STATE GetState() const;
+
+  const FuelTank& GetTank() const;
+
+  /** Returns an upper bound of the rocket's acceleration (m/s²) during the given time from now (gravity, full thrust and the drag
+   *  in the densest air against the strongest wind)
+   */
+  float MaxAcceleration(float seconds) const;
+
+  /** The complete simulation state of the rocket including its fuel tank and input recorder as plain data,
+   *  which can be copied around freely (the rocket's platforms, screen text and time counter are not included).
+   */
+  struct Snapshot {
+    float posX, posY;
+    float rotation;
+    float previousPosX, previousPosY; // see PhysicsObject::previousPos
+    float previousRotation;
+    float velocityX, velocityY;
+    float angularVelocity;
+    float accelerationX, accelerationY;
+    float angularAcceleration;
+    float mass;
+    float fuelVolume; // FuelTank::currentVolume
+    double secondsSinceLastAnimation;
+    int32_t trailIndex;
+    STATE state;
+    Integrator integrator;
+    uint32_t windSeed; // see WindField
+    Recorder::Snapshot recorder;
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  Snapshot TakeSnapshot() const;
+
+  /** Restores the rocket to the given snapshot without allocating.
+   *
+   * @return false if the recording couldn't be restored (see Recorder::Restore())
+   */
+  bool Restore(const Snapshot& snapshot);
+
+  /** Shows the state of a rocket, which is simulated somewhere else (see SimulationThread). Unlike Restore() this leaves
+   *  the input recorder and the thrust animation untouched, because the rocket isn't simulated itself and the animation
+   *  is advanced while drawing.
+   */
+  void Mirror(const Snapshot& snapshot);
+
+  /** Fills the tank to the given fraction (0-1) now and whenever the rocket is reset (see LevelFile)
+   */
+  void SetStartFuel(float fraction);
+
+  /** Lets the wind of the given seed (0 for no atmosphere) blow now and whenever the rocket is reset by an input, which hasn't been
+   *  recorded with its own wind (see Input::RecordedWindSeed())
+   */
+  void SetWindSeed(uint32_t seed);
+
+  /** Returns the wind field the rocket currently flies through
+   */
+  const WindField& GetWind() const;
+
+  // The level's settings (see LevelFile)
+  float gravity = PhysicsObject::GRAVITY; // m/s²
+  Vector spawnOffset;                     // px from the position centered 1 px above the start platform
+  float refuelRate = 30;                  // %/s while landed on the start platform
+  uint32_t levelIdentity = 0;             // of the level the rocket flies in, recorded by the saved replays (see LevelFile::Identity())
+
+protected:
+  /** While thrusting, the thrust turns with the rocket and the rocket gets lighter as it burns fuel within the tick.
+   *  The drag follows the velocity (see PhysicsObject::AccelerationAt()).
+   */
+  virtual Vector AccelerationAt(float seconds, Vector velocity, float rotation) const override;
+
 private:
-  /** Handle collisions
+  /** Handle collisions: the rocket goes back to the time of impact and lands or crashes with the velocity it had at that time
    */
-  virtual void OnCollision(Collider& collider) override;
+  virtual void OnCollision(Collider& collider, const ContactManifold& contact) override;
+
+  /** Returns the state the rocket ends up in, when colliding with the given collider with the given velocity and rotation.
+   */
+  STATE CollisionOutcome(const Collider& collider, Vector velocity, float rotation) const;
 
   /** Moves the rocket to it's start position
    */
@@ -39,9 +123,26 @@ private:
 
   const float baseMass = 14109.6f; //kg - The rocket's base mass without the mass of the fuel tanks and the fuel itself.
 
+  // The crater of a crash into the terrain (see OnCollision())
+  const float craterRadius = 25;         // px at 0 m/s
+  const float craterRadiusPerSpeed = 1;  // px per m/s of the impact speed
+  const float maxCraterRadius = 70;      // px
+  const float craterDepth = 0.5f;        // depth per radius
+
+  const float dragArea = 60; // m² - drag coefficient times the reference area (see PhysicsObject::ApplyDrag())
+
   FuelTank Tank;
+  float startFuel = 1; // see SetStartFuel()
+
+  WindField wind;
+  uint32_t levelWindSeed = 0; // see SetWindSeed()
+
+  int updateTicks = 1; // the number of ticks the current update runs (see World::Tick())
+
+  // The thrust (N) of the current tick and the acceleration it caused at the start of the tick (see AccelerationAt())
+  float thrust = 0;
+  Vector thrustAcceleration;
 
-  enum class STATE {UNSTARTED, STARTED, CRASHED, LANDED, SUCCESS};
   STATE state = STATE::UNSTARTED;
 
   Recorder recorder; // input recorder
@@ -0,0 +1,493 @@
+#include "stdafx.h"
+#include "RocketBatch.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if defined(LANDER_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(LANDER_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// No FMA contraction in this file, the SIMD lanes must round like the scalar operations
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+namespace Lander {
+
+namespace {
+
+/** A collider with the shape of the rocket, which is moved along each lane's movement to run the same collision check
+ *  as the Rocket's Update() for the lane.
+ */
+class LaneProbe : public Collider {
+public:
+  /** Runs the collision check and returns the collider, which has been hit first (or nullptr)
+   */
+  Collider* Check(const Motion& motion, const std::vector<Collider*>& colliders) {
+    lastHit = nullptr;
+    CheckCollisions(motion, colliders);
+    return lastHit;
+  }
+
+  ContactManifold lastContact;
+
+  virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override {}
+
+private:
+  virtual void OnCollision(Collider& collider, const ContactManifold& contact) override {
+    lastHit = &collider;
+    lastContact = contact;
+  }
+
+  Collider* lastHit = nullptr;
+};
+
+bool BitEquals(float a, float b) {
+  return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+/** Returns all bits set if the condition is true, otherwise 0
+ */
+uint32_t Mask(bool condition) {
+  return 0u - static_cast<uint32_t>(condition);
+}
+
+/** Returns a if all bits of the mask are set and b if none is set. Unlike the ?: operator, both values are always calculated
+ *  and the bits are picked with integer operations, so the compiler can't turn the select into a branch, which would keep
+ *  the loop from being vectorized.
+ */
+float Select(uint32_t mask, float a, float b) {
+  return std::bit_cast<float>((std::bit_cast<uint32_t>(a) & mask) | (std::bit_cast<uint32_t>(b) & ~mask));
+}
+
+/** The constants of a tick of the flight kernel
+ */
+struct FlightConstants {
+  float secondsPassed, halfSecondsPassed;
+  float burntFuel;
+  float baseMass;
+  float emptyTankMass, fuelDensity; // FuelTank::emptyMass and FuelTank::p
+  float rcsAcceleration;
+  float gravityX, gravityY;
+  float pixelPerMeter;
+  float dragArea;
+  uint32_t windy; // Mask(), whether the drag is applied
+};
+
+/** Runs the flight logic of a tick for all lanes. All operations mirror Rocket::PhysicsUpdate(), FuelTank::GetThrust() and
+ *  PhysicsObject::Update() in exactly the same order to get bit-identical results.
+ *
+ *  Four lanes at a time are run with SSE2 or NEON, which don't depend on the compiler's auto-vectorization. The remaining lanes
+ *  (and all lanes without SIMD) run in the scalar loop, which has no calls and only masked selects instead of branches, so it can be
+ *  vectorized as well. The arrays are parameters, because the compiler only relies on __restrict for parameters.
+ */
+void FlightKernel(size_t lanes, FlightConstants constants, const int32_t* __restrict isActive, const int32_t* __restrict input,
+                  const float* __restrict forceX, const float* __restrict forceY, const float* __restrict airX, const float* __restrict airY,
+                  const float* __restrict density, float* __restrict px, float* __restrict py, float* __restrict vx, float* __restrict vy,
+                  float* __restrict rot, float* __restrict av, float* __restrict fuel, float* __restrict accX, float* __restrict accY,
+                  float* __restrict angularAcc) {
+  size_t i = 0;
+#if defined(LANDER_SIMD_SSE2)
+  const __m128i zeroBits = _mm_setzero_si128();
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 signBit = _mm_set1_ps(-0.0f);
+  const __m128i thrustBit = _mm_set1_epi32(Input::Thrust);
+  const __m128i rollLeftBit = _mm_set1_epi32(Input::RollLeft);
+  const __m128i rollRightBit = _mm_set1_epi32(Input::RollRight);
+  const __m128 secondsPassed = _mm_set1_ps(constants.secondsPassed);
+  const __m128 halfSecondsPassed = _mm_set1_ps(constants.halfSecondsPassed);
+  const __m128 burntFuel = _mm_set1_ps(constants.burntFuel);
+  const __m128 baseMass = _mm_set1_ps(constants.baseMass);
+  const __m128 emptyTankMass = _mm_set1_ps(constants.emptyTankMass);
+  const __m128 fuelDensity = _mm_set1_ps(constants.fuelDensity);
+  const __m128 rcsLeft = _mm_add_ps(zero, _mm_set1_ps(-constants.rcsAcceleration));
+  const __m128 rcsAcceleration = _mm_set1_ps(constants.rcsAcceleration);
+  const __m128 gravityX = _mm_set1_ps(constants.gravityX);
+  const __m128 gravityY = _mm_set1_ps(constants.gravityY);
+  const __m128 pixelPerMeter = _mm_set1_ps(constants.pixelPerMeter);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 dragArea = _mm_set1_ps(constants.dragArea);
+  const __m128 one = _mm_set1_ps(1.0f);
+  auto select = [](__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+  auto isSet = [zeroBits](__m128i bits) { return _mm_castsi128_ps(_mm_xor_si128(_mm_cmpeq_epi32(bits, zeroBits), _mm_set1_epi32(-1))); };
+
+  for (; i + 4 <= lanes; i += 4) {
+    const __m128i inputs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    const __m128 started = isSet(_mm_loadu_si128(reinterpret_cast<const __m128i*>(isActive + i)));
+    __m128 laneFuel = _mm_loadu_ps(fuel + i);
+    const __m128 mass = _mm_add_ps(baseMass, _mm_add_ps(emptyTankMass, _mm_mul_ps(laneFuel, fuelDensity)));
+    const __m128 thrusting = _mm_andnot_ps(_mm_cmple_ps(laneFuel, zero), _mm_and_ps(started, isSet(_mm_and_si128(inputs, thrustBit))));
+    const __m128 rollLeft = isSet(_mm_and_si128(inputs, rollLeftBit));
+    const __m128 rollRight = isSet(_mm_and_si128(inputs, rollRightBit));
+
+    laneFuel = select(thrusting, _mm_sub_ps(laneFuel, burntFuel), laneFuel);
+    _mm_storeu_ps(fuel + i, laneFuel);
+
+    const __m128 inverseMass = _mm_div_ps(one, mass);
+    __m128 ax = _mm_and_ps(thrusting, _mm_add_ps(zero, _mm_mul_ps(_mm_loadu_ps(forceX + i), inverseMass)));
+    __m128 ay = _mm_and_ps(thrusting, _mm_add_ps(zero, _mm_mul_ps(_mm_loadu_ps(forceY + i), inverseMass)));
+    __m128 angularAcceleration = _mm_and_ps(rollLeft, rcsLeft);
+    angularAcceleration = select(rollRight, _mm_add_ps(angularAcceleration, rcsAcceleration), angularAcceleration);
+    ax = _mm_add_ps(ax, gravityX);
+    ay = _mm_add_ps(ay, gravityY);
+
+    const __m128 startVx = _mm_loadu_ps(vx + i);
+    const __m128 startVy = _mm_loadu_ps(vy + i);
+    if (constants.windy) {
+      const __m128 dragFactor = _mm_div_ps(_mm_mul_ps(_mm_mul_ps(half, _mm_loadu_ps(density + i)), dragArea), mass);
+      const __m128 airspeedX = _mm_sub_ps(startVx, _mm_loadu_ps(airX + i));
+      const __m128 airspeedY = _mm_sub_ps(startVy, _mm_loadu_ps(airY + i));
+      const __m128 airspeed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(airspeedX, airspeedX), _mm_mul_ps(airspeedY, airspeedY)));
+      const __m128 dragScale = _mm_xor_ps(_mm_mul_ps(dragFactor, airspeed), signBit);
+      ax = _mm_add_ps(ax, _mm_mul_ps(airspeedX, dragScale));
+      ay = _mm_add_ps(ay, _mm_mul_ps(airspeedY, dragScale));
+    }
+
+    _mm_storeu_ps(accX + i, ax);
+    _mm_storeu_ps(accY + i, ay);
+    _mm_storeu_ps(angularAcc + i, angularAcceleration);
+
+    const __m128 startAv = _mm_loadu_ps(av + i);
+    const __m128 newVx = _mm_add_ps(startVx, _mm_mul_ps(ax, secondsPassed));
+    const __m128 newVy = _mm_add_ps(startVy, _mm_mul_ps(ay, secondsPassed));
+    const __m128 newAv = _mm_add_ps(startAv, _mm_mul_ps(angularAcceleration, secondsPassed));
+
+    const __m128 avgVx = _mm_sub_ps(newVx, _mm_mul_ps(ax, halfSecondsPassed));
+    const __m128 avgVy = _mm_sub_ps(newVy, _mm_mul_ps(ay, halfSecondsPassed));
+    const __m128 avgAv = _mm_sub_ps(newAv, _mm_mul_ps(angularAcceleration, halfSecondsPassed));
+
+    const __m128 startPx = _mm_loadu_ps(px + i);
+    const __m128 startPy = _mm_loadu_ps(py + i);
+    const __m128 startRot = _mm_loadu_ps(rot + i);
+    _mm_storeu_ps(px + i, select(started, _mm_add_ps(startPx, _mm_mul_ps(_mm_mul_ps(avgVx, secondsPassed), pixelPerMeter)), startPx));
+    _mm_storeu_ps(py + i, select(started, _mm_add_ps(startPy, _mm_mul_ps(_mm_mul_ps(avgVy, secondsPassed), pixelPerMeter)), startPy));
+    _mm_storeu_ps(rot + i, select(started, _mm_add_ps(startRot, _mm_mul_ps(avgAv, secondsPassed)), startRot));
+
+    _mm_storeu_ps(vx + i, _mm_and_ps(started, newVx));
+    _mm_storeu_ps(vy + i, _mm_and_ps(started, newVy));
+    _mm_storeu_ps(av + i, _mm_and_ps(started, newAv));
+  }
+#elif defined(LANDER_SIMD_NEON)
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const int32x4_t thrustBit = vdupq_n_s32(Input::Thrust);
+  const int32x4_t rollLeftBit = vdupq_n_s32(Input::RollLeft);
+  const int32x4_t rollRightBit = vdupq_n_s32(Input::RollRight);
+  const float32x4_t secondsPassed = vdupq_n_f32(constants.secondsPassed);
+  const float32x4_t halfSecondsPassed = vdupq_n_f32(constants.halfSecondsPassed);
+  const float32x4_t burntFuel = vdupq_n_f32(constants.burntFuel);
+  const float32x4_t baseMass = vdupq_n_f32(constants.baseMass);
+  const float32x4_t emptyTankMass = vdupq_n_f32(constants.emptyTankMass);
+  const float32x4_t fuelDensity = vdupq_n_f32(constants.fuelDensity);
+  const float32x4_t rcsLeft = vaddq_f32(zero, vdupq_n_f32(-constants.rcsAcceleration));
+  const float32x4_t rcsAcceleration = vdupq_n_f32(constants.rcsAcceleration);
+  const float32x4_t gravityX = vdupq_n_f32(constants.gravityX);
+  const float32x4_t gravityY = vdupq_n_f32(constants.gravityY);
+  const float32x4_t pixelPerMeter = vdupq_n_f32(constants.pixelPerMeter);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const float32x4_t dragArea = vdupq_n_f32(constants.dragArea);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+
+  // Separate multiplications and additions (vmlaq/vfmaq would round differently)
+  for (; i + 4 <= lanes; i += 4) {
+    const int32x4_t inputs = vld1q_s32(input + i);
+    const uint32x4_t started = vtstq_s32(vld1q_s32(isActive + i), vld1q_s32(isActive + i));
+    float32x4_t laneFuel = vld1q_f32(fuel + i);
+    const float32x4_t mass = vaddq_f32(baseMass, vaddq_f32(emptyTankMass, vmulq_f32(laneFuel, fuelDensity)));
+    const uint32x4_t thrusting = vbicq_u32(vandq_u32(started, vtstq_s32(inputs, thrustBit)), vcleq_f32(laneFuel, zero));
+    const uint32x4_t rollLeft = vtstq_s32(inputs, rollLeftBit);
+    const uint32x4_t rollRight = vtstq_s32(inputs, rollRightBit);
+
+    laneFuel = vbslq_f32(thrusting, vsubq_f32(laneFuel, burntFuel), laneFuel);
+    vst1q_f32(fuel + i, laneFuel);
+
+    const float32x4_t inverseMass = vdivq_f32(one, mass);
+    float32x4_t ax = vbslq_f32(thrusting, vaddq_f32(zero, vmulq_f32(vld1q_f32(forceX + i), inverseMass)), zero);
+    float32x4_t ay = vbslq_f32(thrusting, vaddq_f32(zero, vmulq_f32(vld1q_f32(forceY + i), inverseMass)), zero);
+    float32x4_t angularAcceleration = vbslq_f32(rollLeft, rcsLeft, zero);
+    angularAcceleration = vbslq_f32(rollRight, vaddq_f32(angularAcceleration, rcsAcceleration), angularAcceleration);
+    ax = vaddq_f32(ax, gravityX);
+    ay = vaddq_f32(ay, gravityY);
+
+    const float32x4_t startVx = vld1q_f32(vx + i);
+    const float32x4_t startVy = vld1q_f32(vy + i);
+    if (constants.windy) {
+      const float32x4_t dragFactor = vdivq_f32(vmulq_f32(vmulq_f32(half, vld1q_f32(density + i)), dragArea), mass);
+      const float32x4_t airspeedX = vsubq_f32(startVx, vld1q_f32(airX + i));
+      const float32x4_t airspeedY = vsubq_f32(startVy, vld1q_f32(airY + i));
+      const float32x4_t airspeed = vsqrtq_f32(vaddq_f32(vmulq_f32(airspeedX, airspeedX), vmulq_f32(airspeedY, airspeedY)));
+      const float32x4_t dragScale = vnegq_f32(vmulq_f32(dragFactor, airspeed));
+      ax = vaddq_f32(ax, vmulq_f32(airspeedX, dragScale));
+      ay = vaddq_f32(ay, vmulq_f32(airspeedY, dragScale));
+    }
+
+    vst1q_f32(accX + i, ax);
+    vst1q_f32(accY + i, ay);
+    vst1q_f32(angularAcc + i, angularAcceleration);
+
+    const float32x4_t startAv = vld1q_f32(av + i);
+    const float32x4_t newVx = vaddq_f32(startVx, vmulq_f32(ax, secondsPassed));
+    const float32x4_t newVy = vaddq_f32(startVy, vmulq_f32(ay, secondsPassed));
+    const float32x4_t newAv = vaddq_f32(startAv, vmulq_f32(angularAcceleration, secondsPassed));
+
+    const float32x4_t avgVx = vsubq_f32(newVx, vmulq_f32(ax, halfSecondsPassed));
+    const float32x4_t avgVy = vsubq_f32(newVy, vmulq_f32(ay, halfSecondsPassed));
+    const float32x4_t avgAv = vsubq_f32(newAv, vmulq_f32(angularAcceleration, halfSecondsPassed));
+
+    const float32x4_t startPx = vld1q_f32(px + i);
+    const float32x4_t startPy = vld1q_f32(py + i);
+    const float32x4_t startRot = vld1q_f32(rot + i);
+    vst1q_f32(px + i, vbslq_f32(started, vaddq_f32(startPx, vmulq_f32(vmulq_f32(avgVx, secondsPassed), pixelPerMeter)), startPx));
+    vst1q_f32(py + i, vbslq_f32(started, vaddq_f32(startPy, vmulq_f32(vmulq_f32(avgVy, secondsPassed), pixelPerMeter)), startPy));
+    vst1q_f32(rot + i, vbslq_f32(started, vaddq_f32(startRot, vmulq_f32(avgAv, secondsPassed)), startRot));
+
+    vst1q_f32(vx + i, vbslq_f32(started, newVx, zero));
+    vst1q_f32(vy + i, vbslq_f32(started, newVy, zero));
+    vst1q_f32(av + i, vbslq_f32(started, newAv, zero));
+  }
+#endif
+  for (; i < lanes; ++i) {
+    const uint32_t started = Mask(isActive[i] != 0);
+    const float mass = constants.baseMass + (constants.emptyTankMass + (fuel[i] * constants.fuelDensity));
+    const uint32_t thrusting = started & Mask((input[i] & Input::Thrust) != 0) & Mask(!(fuel[i] <= 0));
+    const uint32_t rollLeft = Mask((input[i] & Input::RollLeft) != 0);
+    const uint32_t rollRight = Mask((input[i] & Input::RollRight) != 0);
+
+    // Fuel consumption (FuelTank::GetThrust())
+    fuel[i] = Select(thrusting, fuel[i] - constants.burntFuel, fuel[i]);
+
+    // Accelerations (ApplyForce(), ApplyAngularAcceleration(), ApplyGravity())
+    const float inverseMass = 1 / mass;
+    float ax = Select(thrusting, 0.0f + (forceX[i] * inverseMass), 0.0f);
+    float ay = Select(thrusting, 0.0f + (forceY[i] * inverseMass), 0.0f);
+    float angularAcceleration = 0.0f;
+    angularAcceleration = Select(rollLeft, angularAcceleration + (-constants.rcsAcceleration), angularAcceleration);
+    angularAcceleration = Select(rollRight, angularAcceleration + constants.rcsAcceleration, angularAcceleration);
+    ax += constants.gravityX;
+    ay += constants.gravityY;
+
+    // Drag (ApplyDrag()) with the velocity relative to the wind. The file is compiled without errno for the math functions
+    // (see CMakeLists.txt), so the square root is a single instruction instead of a libm call.
+    const float dragFactor = 0.5f * density[i] * constants.dragArea / mass;
+    const float airspeedX = vx[i] - airX[i];
+    const float airspeedY = vy[i] - airY[i];
+    const float dragScale = -(dragFactor * std::sqrt(airspeedX * airspeedX + airspeedY * airspeedY));
+    ax = Select(constants.windy, ax + (airspeedX * dragScale), ax);
+    ay = Select(constants.windy, ay + (airspeedY * dragScale), ay);
+
+    accX[i] = ax;
+    accY[i] = ay;
+    angularAcc[i] = angularAcceleration;
+
+    // Integration (PhysicsObject::Update())
+    const float newVx = vx[i] + (ax * constants.secondsPassed);
+    const float newVy = vy[i] + (ay * constants.secondsPassed);
+    const float newAv = av[i] + (angularAcceleration * constants.secondsPassed);
+
+    const float avgVx = newVx - (ax * constants.halfSecondsPassed);
+    const float avgVy = newVy - (ay * constants.halfSecondsPassed);
+    const float avgAv = newAv - (angularAcceleration * constants.halfSecondsPassed);
+
+    px[i] = Select(started, px[i] + ((avgVx * constants.secondsPassed) * constants.pixelPerMeter), px[i]);
+    py[i] = Select(started, py[i] + ((avgVy * constants.secondsPassed) * constants.pixelPerMeter), py[i]);
+    rot[i] = Select(started, rot[i] + (avgAv * constants.secondsPassed), rot[i]);
+
+    // Stopped rockets (crashed, landed, ...) don't move anymore
+    vx[i] = Select(started, newVx, 0.0f);
+    vy[i] = Select(started, newVy, 0.0f);
+    av[i] = Select(started, newAv, 0.0f);
+  }
+}
+
+}
+
+
+RocketBatch::RocketBatch(const Rocket& prototype, bool checkCollisions) : prototype(prototype) {
+  if (checkCollisions) {
+    for (auto collider : prototype.world->GetColliders()) {
+      if (collider != &prototype) {
+        colliders.push_back(collider);
+      }
+    }
+  }
+}
+
+size_t RocketBatch::AddLane(const Rocket& rocket) {
+  posX.push_back(0);
+  posY.push_back(0);
+  velocityX.push_back(0);
+  velocityY.push_back(0);
+  rotation.push_back(0);
+  angularVelocity.push_back(0);
+  fuelVolume.push_back(0);
+  state.push_back(Rocket::STATE::UNSTARTED);
+
+  active.push_back(0);
+  laneInputs.push_back(0);
+  for (auto scratch : { &startX, &startY, &startRotation, &startVelocityX, &startVelocityY, &startAngularVelocity, &accelerationX, &accelerationY, &angularAcceleration }) {
+    scratch->push_back(0);
+  }
+  thrustX.push_back(0);
+  thrustY.push_back(0);
+  thrustRotation.push_back(std::numeric_limits<float>::quiet_NaN()); // never equal to any rotation -> calculated upon first use
+  windX.push_back(0);
+  windY.push_back(0);
+  airDensity.push_back(0);
+
+  size_t lane = Size() - 1;
+  SetLane(lane, rocket);
+  return lane;
+}
+
+void RocketBatch::SetLane(size_t lane, const Rocket& rocket) {
+  posX[lane] = rocket.pos.x;
+  posY[lane] = rocket.pos.y;
+  velocityX[lane] = rocket.velocity.x;
+  velocityY[lane] = rocket.velocity.y;
+  rotation[lane] = rocket.rotation;
+  angularVelocity[lane] = rocket.angularVelocity;
+  fuelVolume[lane] = rocket.Tank.currentVolume;
+  state[lane] = rocket.state;
+}
+
+bool RocketBatch::LaneEquals(size_t lane, const Rocket& rocket) const {
+  return BitEquals(posX[lane], rocket.pos.x)
+      && BitEquals(posY[lane], rocket.pos.y)
+      && BitEquals(velocityX[lane], rocket.velocity.x)
+      && BitEquals(velocityY[lane], rocket.velocity.y)
+      && BitEquals(rotation[lane], rocket.rotation)
+      && BitEquals(angularVelocity[lane], rocket.angularVelocity)
+      && BitEquals(fuelVolume[lane], rocket.Tank.currentVolume)
+      && state[lane] == rocket.state;
+}
+
+size_t RocketBatch::Size() const {
+  return state.size();
+}
+
+const char* RocketBatch::KernelName() {
+#if defined(LANDER_SIMD_SSE2)
+  return "SSE2";
+#elif defined(LANDER_SIMD_NEON)
+  return "NEON";
+#else
+  return "scalar";
+#endif
+}
+
+
+void RocketBatch::Tick(const uint8_t* inputs, double secondsPassed) {
+  const size_t lanes = Size();
+
+  for (size_t i = 0; i < lanes; ++i) {
+    active[i] = (state[i] == Rocket::STATE::STARTED) ? 1 : 0;
+    laneInputs[i] = inputs[i];
+  }
+
+  UpdateThrustVectors();
+
+  const bool windy = !prototype.wind.IsCalm();
+  if (windy) {
+    SampleWind();
+  }
+
+  const float secondsPassedF = static_cast<float>(secondsPassed);
+  FlightConstants constants;
+  constants.secondsPassed = secondsPassedF;
+  constants.halfSecondsPassed = secondsPassedF / 2;
+  constants.burntFuel = FuelTank::Q * secondsPassedF;
+  constants.baseMass = prototype.baseMass;
+  constants.emptyTankMass = FuelTank::emptyMass;
+  constants.fuelDensity = FuelTank::p;
+  constants.rcsAcceleration = prototype.angularAcceleration;
+  constants.gravityX = Vector::Down.x * prototype.gravity;
+  constants.gravityY = Vector::Down.y * prototype.gravity;
+  constants.pixelPerMeter = PhysicsObject::PIXEL_PER_METER;
+  constants.dragArea = prototype.dragArea;
+  constants.windy = Mask(windy);
+
+  // The movement for the collision check starts at the current state (the kernel stores the accelerations)
+  std::copy(posX.begin(), posX.end(), startX.begin());
+  std::copy(posY.begin(), posY.end(), startY.begin());
+  std::copy(rotation.begin(), rotation.end(), startRotation.begin());
+  std::copy(velocityX.begin(), velocityX.end(), startVelocityX.begin());
+  std::copy(velocityY.begin(), velocityY.end(), startVelocityY.begin());
+  std::copy(angularVelocity.begin(), angularVelocity.end(), startAngularVelocity.begin());
+
+  FlightKernel(lanes, constants, active.data(), laneInputs.data(), thrustX.data(), thrustY.data(), windX.data(), windY.data(), airDensity.data(),
+               posX.data(), posY.data(), velocityX.data(), velocityY.data(), rotation.data(), angularVelocity.data(), fuelVolume.data(),
+               accelerationX.data(), accelerationY.data(), angularAcceleration.data());
+
+  CheckCollisions(secondsPassedF);
+  gameTick += std::max(1, static_cast<int>(std::lround(secondsPassed / World::SECONDS_PER_TICK))); // see Rocket::PhysicsUpdate()
+}
+
+
+void RocketBatch::CheckCollisions(float secondsPassed) {
+  if (colliders.empty()) {
+    return;
+  }
+
+  LaneProbe probe;
+  probe.size = prototype.size;
+
+  for (size_t i = 0; i < Size(); ++i) {
+    if (!active[i]) {
+      continue;
+    }
+
+    // Same movement as the one PhysicsObject::Update() passes to the collision check
+    const Motion motion = { Vector(startX[i], startY[i]), Vector(posX[i], posY[i]), startRotation[i], rotation[i],
+                            Vector(startVelocityX[i], startVelocityY[i]), Vector(accelerationX[i], accelerationY[i]),
+                            startAngularVelocity[i], angularAcceleration[i], secondsPassed };
+    if (auto hit = probe.Check(motion, colliders)) {
+      const float time = probe.lastContact.time;
+      const Vector impactPos = motion.PosAt(time);
+      const Vector impactVelocity = motion.VelocityAt(time);
+      posX[i] = impactPos.x;
+      posY[i] = impactPos.y;
+      rotation[i] = motion.RotationAt(time);
+      velocityX[i] = impactVelocity.x;
+      velocityY[i] = impactVelocity.y;
+      angularVelocity[i] = motion.AngularVelocityAt(time);
+      state[i] = prototype.CollisionOutcome(*hit, impactVelocity, rotation[i]);
+    }
+  }
+}
+
+
+void RocketBatch::SampleWind() {
+  const WindField& wind = prototype.wind;
+  const float offset = wind.Offset(gameTick);
+  const Vector center = prototype.Center();
+
+  // Same sample as in Rocket::PhysicsUpdate(). Lanes, which don't fly, don't use theirs.
+  for (size_t i = 0; i < Size(); ++i) {
+    const WindField::Sample air = wind.At(posX[i] + center.x, posY[i] + center.y, offset);
+    windX[i] = air.wind.x;
+    windY[i] = air.wind.y;
+    airDensity[i] = air.density;
+  }
+}
+
+
+void RocketBatch::UpdateThrustVectors() {
+  const float thrust = FuelTank::Q * FuelTank::p * FuelTank::ls;
+
+  for (size_t i = 0; i < Size(); ++i) {
+    bool thrusting = active[i] && (laneInputs[i] & Input::Thrust) != 0 && !(fuelVolume[i] <= 0);
+    if (thrusting && rotation[i] != thrustRotation[i]) {
+      // Same calculation as in Rocket::PhysicsUpdate()
+      Vector force = (Vector::Up * thrust).Rotate(rotation[i]);
+      thrustX[i] = force.x;
+      thrustY[i] = force.y;
+      thrustRotation[i] = rotation[i];
+    }
+  }
+}
+
+}
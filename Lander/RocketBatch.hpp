@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Rocket.hpp"
+#include "World.hpp"
+
+namespace Lander {
+
+/** Simulates the flight of many rockets in lockstep. Instead of one Rocket object per rocket, the state of all rockets
+ *  is held in parallel arrays (one lane per rocket), so a tick is a few tight loops over these arrays. The flight logic runs four
+ *  lanes at a time with explicit SSE2 or NEON instructions (see KernelName()). The flight logic is the same as in Rocket::PhysicsUpdate() (thrust, RCS, gravity, drag and fuel consumption)
+ *  followed by PhysicsObject::Update() and produces bit-identical results to a Rocket receiving the same inputs, which uses the
+ *  default integrator (Integrator::AverageVelocity).
+ *
+ *  Only the flight phase is simulated: lanes, which are not in the STARTED state, are frozen and a lane leaves the STARTED state
+ *  by colliding with the terrain or a platform, where it stops at the time of impact like the Rocket. The Reset and SaveReplay inputs are ignored.
+ */
+class RocketBatch {
+public:
+  /** Creates an empty batch, whose lanes use the size, platforms and colliders of the given rocket.
+   *
+   * @param prototype a rocket, which has been added to a world
+   * @param checkCollisions if false, collisions are skipped entirely, which is a lot faster, but lanes will never leave the STARTED state
+   */
+  explicit RocketBatch(const Rocket& prototype, bool checkCollisions = true);
+
+  /** Adds a new lane with the current flight state of the given rocket and returns the lane's index.
+   */
+  size_t AddLane(const Rocket& rocket);
+
+  /** Overwrites the state of the given lane with the current flight state of the rocket.
+   */
+  void SetLane(size_t lane, const Rocket& rocket);
+
+  /** Returns true if the flight state of the lane is bit-identical to the given rocket's state.
+   */
+  bool LaneEquals(size_t lane, const Rocket& rocket) const;
+
+  /** Returns the number of lanes
+   */
+  size_t Size() const;
+
+  /** Returns the instruction set of the flight logic ("SSE2", "NEON" or "scalar" without SIMD or with LANDER_NO_SIMD)
+   */
+  static const char* KernelName();
+
+  /** Simulates a single tick for all lanes.
+   *
+   * @param inputs one Input::Type bitmask per lane, which holds the inputs for this tick
+   * @param secondsPassed the tick duration
+   */
+  void Tick(const uint8_t* inputs, double secondsPassed = World::SECONDS_PER_TICK);
+
+  // Lane states in world coordinates (same units as the Rocket members)
+  std::vector<float> posX, posY;
+  std::vector<float> velocityX, velocityY;
+  std::vector<float> rotation;
+  std::vector<float> angularVelocity;
+  std::vector<float> fuelVolume; // FuelTank::currentVolume
+  std::vector<Rocket::STATE> state;
+
+  int32_t gameTick = 0; // the game tick of the lanes (see World::GameTick()), which moves the prototype's wind field. Advanced by Tick().
+
+private:
+  /** Checks the movement of all STARTED lanes in the last tick and moves the lanes, which collide with one of the colliders,
+   *  back to the time of impact (see Rocket::OnCollision())
+   */
+  void CheckCollisions(float secondsPassed);
+
+  /** Recalculates the cached thrust vectors of all thrusting lanes, whose rotation changed since the last tick
+   */
+  void UpdateThrustVectors();
+
+  /** Samples the prototype's wind field at the centers of all lanes
+   */
+  void SampleWind();
+
+  const Rocket& prototype;
+  std::vector<Collider*> colliders; // The prototype's colliders without the prototype itself
+
+  // Per tick scratch arrays (32 bit wide to keep the lanes of all arrays aligned in the SIMD loop)
+  std::vector<int32_t> active;     // 1 if the lane was STARTED at the beginning of the tick
+  std::vector<int32_t> laneInputs; // inputs of the current tick
+
+  // The lanes' movements of the current tick for the collision check (see Motion)
+  std::vector<float> startX, startY, startRotation;
+  std::vector<float> startVelocityX, startVelocityY, startAngularVelocity;
+  std::vector<float> accelerationX, accelerationY, angularAcceleration;
+
+  // The thrust vector (Vector::Up * thrust).Rotate(rotation) only changes with the rotation, so we cache it per lane
+  std::vector<float> thrustX, thrustY;
+  std::vector<float> thrustRotation; // the rotation, the thrust vector has been calculated for
+
+  // The wind and the air density at each lane (only sampled if the prototype's wind field isn't calm)
+  std::vector<float> windX, windY, airDensity;
+};
+
+}
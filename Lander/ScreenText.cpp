@@ -19,6 +19,14 @@ namespace Lander {
     state = GAMESTATE::VICTORY;
   }
 
+  ScreenText::Snapshot ScreenText::TakeSnapshot() const {
+    return { static_cast<uint8_t>(state) };
+  }
+
+  void ScreenText::Restore(const Snapshot& snapshot) {
+    state = static_cast<GAMESTATE>(snapshot.state);
+  }
+
   void ScreenText::Initialize(Size size) {
     windowSize = size;
     pos += Vector::Down * windowSize.height / 2.7f + Vector::Right * 150;
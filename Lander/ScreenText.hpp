@@ -10,6 +10,17 @@ namespace Lander {
     void SetGameOver();
     void SetVictory();
 
+    /** The displayed text (0 = running, 1 = game over, 2 = victory)
+     */
+    struct Snapshot {
+      uint8_t state;
+
+      bool operator==(const Snapshot& other) const = default;
+    };
+
+    Snapshot TakeSnapshot() const;
+    void Restore(const Snapshot& snapshot);
+
     virtual void Initialize(Size size) override;
 
     virtual void Draw(RenderInterface& renderInterface, const Rectangle& visibleRect, double secondsPassed) override;
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "Simulation.hpp"
+
+namespace Lander {
+
+Simulation::Simulation(std::unique_ptr<Input>&& input, Size levelSize, const LevelFile& levelFile) : level(levelFile), rocket(level.rocket) {
+  level.AddTo(world);
+
+  // A replay only plays back the same flight in the level it has been recorded in
+  const std::optional<uint32_t> recordedLevel = input->RecordedLevel();
+  if (recordedLevel && *recordedLevel != levelFile.Identity()) {
+    throw std::runtime_error("The replay has been recorded in a different level");
+  }
+
+  world.SetInput(std::move(input));
+  world.Initialize(levelSize);
+}
+
+void Simulation::Tick() {
+  const int ticks = StepTicks();
+  if (ticks > 1) {
+    // A single step of the rocket's integrator would be far less accurate than the ticks it replaces (see SetMaxTicksPerStep())
+    const Integrator integrator = rocket.integrator;
+    rocket.integrator = Integrator::RungeKutta4;
+    world.Tick(ticks);
+    rocket.integrator = integrator;
+  } else {
+    world.Tick();
+  }
+  peakVelocity = std::max(peakVelocity, rocket.velocity.Length());
+}
+
+void Simulation::SetMaxTicksPerStep(int ticks) {
+  maxTicksPerStep = std::max(ticks, 1);
+}
+
+int Simulation::StepTicks() {
+  if (maxTicksPerStep == 1 || rocket.GetState() != Rocket::STATE::STARTED || world.GameTick() < nextClearanceCheck) {
+    return 1;
+  }
+
+  int ticks = std::min(maxTicksPerStep, world.GetInput().UnchangedTicks());
+  if (ticks == 1) {
+    return 1;
+  }
+
+  // The rocket moves less than (|v|*t + a*t^2/2) with its maximum acceleration and rotates within the square around the
+  // circle around its center. Halve the step until it can't get within the margin of the closest collider during the step.
+  const float speed = rocket.velocity.Length();
+  auto travel = [&](int ticks) {
+    const float seconds = static_cast<float>(ticks * World::SECONDS_PER_TICK);
+    return (speed * seconds + rocket.MaxAcceleration(seconds) * (seconds * seconds / 2)) * PhysicsObject::PIXEL_PER_METER + CONTACT_MARGIN;
+  };
+  const Rectangle bounds = rocket.WorldBounds();
+  const Vector center = (bounds.topLeft + bounds.bottomRight) / 2;
+  const float radius = rocket.Center().Length();
+  const Rectangle square(center - Vector(radius, radius), center + Vector(radius, radius));
+
+  const float maxTravel = travel(ticks);
+  float clearance = maxTravel;
+  for (auto collider : world.GetBroadphase().Query(Rectangle(square.topLeft - Vector(maxTravel, maxTravel), square.bottomRight + Vector(maxTravel, maxTravel)))) {
+    if (collider != &rocket && collider->enabled) {
+      clearance = std::min(clearance, collider->Clearance(square, maxTravel));
+    }
+  }
+  while (ticks > 1 && travel(ticks) >= clearance) {
+    ticks /= 2;
+  }
+  if (ticks == 1) {
+    // The clearance grows by less than a tick's travel per tick, so skip the checks until two ticks could fit into it
+    // (but at most for the longest step, as the rocket may speed up)
+    const float skip = (travel(2) - clearance) / (travel(1) - CONTACT_MARGIN);
+    nextClearanceCheck = world.GameTick() + static_cast<int>(std::min(skip, static_cast<float>(maxTicksPerStep)));
+  }
+  return ticks;
+}
+
+void Simulation::Run() {
+  while (!IsFinished()) {
+    Tick();
+  }
+}
+
+bool Simulation::IsFinished() const {
+  auto state = rocket.GetState();
+  return state == Rocket::STATE::CRASHED || state == Rocket::STATE::SUCCESS || world.GetInput().IsFinished();
+}
+
+float Simulation::PeakVelocity() const {
+  return peakVelocity;
+}
+
+static_assert(std::is_trivially_copyable_v<Simulation::Snapshot>, "snapshots must be copyable with memcpy");
+
+Simulation::Snapshot Simulation::TakeSnapshot() const {
+  return { world.TakeSnapshot(), level.TakeSnapshot(), peakVelocity };
+}
+
+bool Simulation::Restore(const Snapshot& snapshot) {
+  world.Restore(snapshot.world);
+  peakVelocity = snapshot.peakVelocity;
+  nextClearanceCheck = 0;
+  return level.Restore(snapshot.level);
+}
+
+}
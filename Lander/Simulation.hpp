@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Level.hpp"
+
+namespace Lander {
+
+/** A windowless version of the game, which wires up the level exactly like main.cpp, but leaves out all objects,
+ *  which are only needed for rendering. Without a render loop, which waits for the next frame,
+ *  ticks can be run back to back as fast as the CPU allows, which is used to verify replays.
+ */
+class Simulation {
+public:
+  /** Builds the level with the given input
+   *
+   * @param input the input, which controls the rocket (usually a ReplayInput)
+   * @param levelSize the size of the game field (the client area of the game window)
+   * @param levelFile the level to simulate (must outlive the simulation)
+   * @throws std::runtime_error if the input is a replay, which has been recorded in a different level (see LevelFile::Identity())
+   */
+  Simulation(std::unique_ptr<Input>&& input, Size levelSize = Size(World::WINDOW_WIDTH, World::WINDOW_HEIGHT),
+             const LevelFile& levelFile = LevelFile::BuiltIn());
+
+  /** Runs a single physics tick and updates the peak velocity. With adaptive ticks (see SetMaxTicksPerStep()) this may run several ticks at once.
+   */
+  void Tick();
+
+  /** Lets Tick() run up to the given number of ticks at once (1 = every tick on its own, the default). Ticks are only combined
+   *  while the rocket is flying, the inputs stay the same (see Input::UnchangedTicks()) and the rocket can't get closer than
+   *  CONTACT_MARGIN to any collider. Close to the colliders every tick runs on its own. The inputs still change at the
+   *  same ticks.
+   *
+   *  Combined ticks are integrated with Integrator::RungeKutta4, whatever integrator the rocket has been recorded with: a single
+   *  step of the default Integrator::AverageVelocity over the whole duration ignores the rotation of the thrust and drifts by
+   *  hundreds of pixels. So the flight is no longer bit-identical to the recorded one (on the sample replays the final positions
+   *  are up to 1.4 px and the outcomes up to 1 tick apart). It's still deterministic: the same replay and maximum always give the
+   *  same result on every platform. Use it for fast previews and statistics, not to verify replays.
+   */
+  void SetMaxTicksPerStep(int ticks);
+
+  static constexpr float CONTACT_MARGIN = 20; // px (10 m)
+
+  /** Runs ticks back to back until IsFinished() returns true.
+   */
+  void Run();
+
+  /** Returns true if the rocket crashed, landed on the target platform or the input has no more inputs to provide.
+   */
+  bool IsFinished() const;
+
+  /** Returns the highest velocity (m/s) the rocket had at the end of any tick so far.
+   */
+  float PeakVelocity() const;
+
+  /** The complete state of the simulation as plain data (~180 bytes). Everything, which isn't part of the snapshot
+   *  (platforms, the terrain apart from its craters, the wind field apart from its seed, ...) never changes during the simulation. Snapshots can be copied with memcpy, stored in
+   *  plain arrays and restored any number of times to rewind the simulation or to branch off from it.
+   */
+  struct Snapshot {
+    World::Snapshot world;
+    Level::Snapshot level;
+    float peakVelocity;
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  Snapshot TakeSnapshot() const;
+
+  /** Restores the simulation to the given snapshot, which must have been taken from this simulation. Doesn't allocate.
+   *
+   * @return false if the rocket's input recording couldn't be restored (see Recorder::Restore()). The rest of the
+   *         simulation is restored nonetheless.
+   */
+  bool Restore(const Snapshot& snapshot);
+
+  // The level objects (declared before the world to outlive it)
+  Level level;
+  Rocket& rocket; // level.rocket
+
+  World world;
+
+private:
+  /** Returns how many ticks the next Tick() runs at once
+   */
+  int StepTicks();
+
+  float peakVelocity = 0;
+  int maxTicksPerStep = 1;
+  int nextClearanceCheck = 0; // game tick of the next check in StepTicks()
+};
+
+}
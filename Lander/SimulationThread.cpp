@@ -0,0 +1,186 @@
+#include "stdafx.h"
+#include "SimulationThread.hpp"
+#include "KeyboardInput.hpp"
+
+namespace Lander {
+
+SimulationThread::SimulationThread(Size levelSize, Clock& clock, InputFactory inputFactory, const LevelFile& levelFile)
+  : simulation(std::make_unique<KeyboardInput>(), levelSize, levelFile), clock(clock), gameTime(0) {
+  if (inputFactory) {
+    simulation.world.SetInput(inputFactory(simulation.level));
+  }
+
+  ResetGameTime();
+  PublishFrame(); // to always have a frame to show
+  thread = std::thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread() {
+  {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    stopping = true;
+  }
+  commandPosted.notify_one();
+  thread.join();
+}
+
+
+bool SimulationThread::ConsumeFrame() {
+  return frames.Consume();
+}
+
+const SimulationThread::Frame& SimulationThread::CurrentFrame() const {
+  return frames.Front();
+}
+
+
+float SimulationThread::TickProgress(Clock::time_point now) const {
+  using namespace std::chrono;
+  auto& frame = CurrentFrame();
+  auto passedTime = duration_cast<nanoseconds>(now - frame.publishTime);
+  auto gameTime = frame.gameTime + ((frame.gameSpeedExponent >= 0) ? passedTime * (1 << frame.gameSpeedExponent) : passedTime / (1 << -frame.gameSpeedExponent));
+
+  auto tickDuration = duration<double>(milliseconds(World::MILLIS_PER_TICK));
+  auto sinceTick = duration<double>(gameTime - frame.world.gameTick * milliseconds(World::MILLIS_PER_TICK));
+  return static_cast<float>(std::clamp(sinceTick / tickDuration, 0.0, 1.0));
+}
+
+
+void SimulationThread::LoadReplay(std::unique_ptr<ReplayInput>&& replay) {
+  Post({ Command::Type::LOAD_REPLAY, 0, std::move(replay) });
+}
+
+void SimulationThread::SeekReplayTo(int tick) {
+  Post({ Command::Type::SEEK_TO, tick, nullptr });
+}
+
+void SimulationThread::SeekReplayBy(int ticks) {
+  Post({ Command::Type::SEEK_BY, ticks, nullptr });
+}
+
+void SimulationThread::SetReplaySpeed(int exponent) {
+  Post({ Command::Type::SET_REPLAY_SPEED, exponent, nullptr });
+}
+
+void SimulationThread::SetMaxTicksPerUpdate(int maxTicks) {
+  Post({ Command::Type::SET_MAX_TICKS, maxTicks, nullptr });
+}
+
+
+void SimulationThread::Post(Command&& command) {
+  {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commands.push_back(std::move(command));
+  }
+  commandPosted.notify_one();
+}
+
+bool SimulationThread::RunCommands() {
+  std::vector<Command> pending;
+  {
+    std::lock_guard<std::mutex> lock(commandMutex);
+    pending.swap(commands);
+  }
+
+  auto& world = simulation.world;
+  for (auto& command : pending) {
+    switch (command.type) {
+      case Command::Type::LOAD_REPLAY:
+        world.SetInput(std::move(command.replay));
+        world.ResetGameTick(); // to not JUMP into the recording
+        simulation.level.terrain.RemoveCraters(0); // the replay has been recorded without the craters of this session
+        replayIndex = std::make_unique<ReplayIndex>(world, simulation.level);
+        ResetGameTime(); // after indexing, which may take a moment for long replays
+        break;
+
+      case Command::Type::SEEK_TO:
+      case Command::Type::SEEK_BY:
+        // Only seek as long as the replay is the current input
+        if (replayIndex && dynamic_cast<const ReplayInput*>(&world.GetInput())) {
+          replayIndex->Seek(command.type == Command::Type::SEEK_TO ? command.value : world.GameTick() + command.value);
+          ResetGameTime();
+        }
+        break;
+
+      case Command::Type::SET_REPLAY_SPEED:
+        replaySpeedExponent = std::clamp(command.value, MIN_REPLAY_SPEED_EXPONENT, MAX_REPLAY_SPEED_EXPONENT);
+        break;
+
+      case Command::Type::SET_MAX_TICKS:
+        maxTicksPerUpdate = std::max(1, command.value);
+        break;
+    }
+  }
+
+  return !pending.empty();
+}
+
+
+int SimulationThread::GameSpeedExponent() const {
+  const bool replaying = replayIndex && !simulation.world.GetInput().IsFinished();
+  return replaying ? replaySpeedExponent : 0;
+}
+
+void SimulationThread::ResetGameTime() {
+  lastGameTimeUpdate = clock.Now();
+  gameTime = std::chrono::milliseconds(static_cast<int64_t>(simulation.world.GameTick()) * World::MILLIS_PER_TICK);
+}
+
+void SimulationThread::PublishFrame() {
+  auto& frame = frames.Back();
+  frame.world = simulation.world.TakeSnapshot();
+  frame.level = simulation.level.TakeSnapshot();
+  frame.activeInputs = simulation.world.GetInput().AllActiveInputs();
+  frame.replaySpeedExponent = replaySpeedExponent;
+  frame.publishTime = lastGameTimeUpdate;
+  frame.gameTime = gameTime;
+  frame.gameSpeedExponent = GameSpeedExponent();
+  frames.Publish();
+}
+
+
+void SimulationThread::Run() {
+  using namespace std::chrono;
+  auto& world = simulation.world;
+  const auto tickDuration = milliseconds(World::MILLIS_PER_TICK);
+
+  while (true) {
+    bool changed = RunCommands();
+
+    // Advance the game time by the passed time (scaled while a replay is playing)
+    auto now = clock.Now();
+    auto passedTime = duration_cast<nanoseconds>(now - lastGameTimeUpdate);
+    lastGameTimeUpdate = now;
+    const int speedExponent = GameSpeedExponent();
+    gameTime += (speedExponent >= 0) ? passedTime * (1 << speedExponent) : passedTime / (1 << -speedExponent);
+
+    // Run the required amount of physics steps to catch up with the current game time,
+    // but not more than maxTicksPerUpdate. Any further backlog is dropped.
+    auto expectedTicks = gameTime / tickDuration;
+    if (expectedTicks - world.GameTick() > maxTicksPerUpdate) {
+      expectedTicks = world.GameTick() + maxTicksPerUpdate;
+      gameTime = expectedTicks * tickDuration;
+    }
+    while (world.GameTick() < expectedTicks) {
+      simulation.Tick();
+      changed = true;
+    }
+
+    if (changed) {
+      PublishFrame();
+    }
+
+    // Sleep until the next tick is due or a command has been posted (rounded up to not wake up before the tick is due)
+    auto gameTimeUntilNextTick = (world.GameTick() + 1) * tickDuration - gameTime;
+    auto wakeUpTime = now + ((speedExponent >= 0) ? (gameTimeUntilNextTick + nanoseconds((1 << speedExponent) - 1)) / (1 << speedExponent)
+                                                   : gameTimeUntilNextTick * (1 << -speedExponent));
+
+    std::unique_lock<std::mutex> lock(commandMutex);
+    clock.WaitUntil(wakeUpTime, commandPosted, lock, [this]() { return stopping || !commands.empty(); });
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Simulation.hpp"
+#include "ReplayIndex.hpp"
+#include "ReplayInput.hpp"
+#include "TripleBuffer.hpp"
+#include "Clock.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Lander {
+
+/** Runs the physics simulation of the level on its own thread in the time of the given clock, so that neither waits for the other: a slow frame
+ *  doesn't delay the simulation and a burst of ticks doesn't delay the next frame. After each batch of ticks the state of the
+ *  simulation is published as a Frame through a lock-free triple buffer, which the render thread mirrors into its own copy of
+ *  the level (see Level::Mirror()) before drawing.
+ *
+ *  The simulated world is only accessed by the simulation thread. Everything else (loading and seeking replays, the replay speed)
+ *  is passed to the simulation thread as a command, which it runs between two ticks.
+ */
+class SimulationThread {
+public:
+  /** Creates the input for the simulated world (the simulated level is passed to allow inputs like the HoverAIInput)
+   */
+  using InputFactory = std::function<std::unique_ptr<Input>(Level& level)>;
+
+  /** Creates the simulated level and starts simulating it right away.
+   *
+   * @param levelSize the size of the game field
+   * @param clock the clock, whose time the game time follows (must outlive the simulation thread)
+   * @param inputFactory creates the input of the simulated world (a KeyboardInput if empty)
+   * @param levelFile the level to simulate (must outlive the simulation thread)
+   */
+  SimulationThread(Size levelSize, Clock& clock, InputFactory inputFactory = nullptr, const LevelFile& levelFile = LevelFile::BuiltIn());
+
+  /** Stops the simulation thread
+   */
+  ~SimulationThread();
+
+  /** The state of the simulation after a batch of ticks
+   */
+  struct Frame {
+    World::Snapshot world;
+    Level::Snapshot level;
+    int32_t activeInputs;        // inputs of the last tick (see Input::AllActiveInputs())
+    int32_t replaySpeedExponent; // see SetReplaySpeed()
+
+    // To estimate the game time at any point in time after the frame has been published
+    Clock::time_point publishTime;
+    std::chrono::nanoseconds gameTime; // game time when publishing
+    int32_t gameSpeedExponent;         // the replay speed if a replay is playing, 0 otherwise
+  };
+
+  /** Takes the most recently published frame. Never waits for the simulation thread.
+   *
+   * @return false if no new frame has been published since the last call
+   */
+  bool ConsumeFrame();
+
+  /** Returns the frame taken by the last successful ConsumeFrame()
+   */
+  const Frame& CurrentFrame() const;
+
+  /** Returns the fraction of the tick after the current frame's tick, which has passed at the given time (0-1).
+   *  Drawing the objects interpolated between the last two ticks (see ViewObject::InterpolatedPos()) with this value
+   *  moves them smoothly, although each frame contains a different number of ticks.
+   */
+  float TickProgress(Clock::time_point now) const;
+
+  /** Replaces the simulated world's input with the given replay, restarts the game ticks and indexes the replay for seeking
+   */
+  void LoadReplay(std::unique_ptr<ReplayInput>&& replay);
+
+  /** Jumps to the given tick of the currently loaded replay (if any)
+   */
+  void SeekReplayTo(int tick);
+
+  /** Jumps the given number of ticks forward (or back if negative) in the currently loaded replay (if any)
+   */
+  void SeekReplayBy(int ticks);
+
+  // Replay speeds are powers of two from 1/8x to 64x
+  static const int MIN_REPLAY_SPEED_EXPONENT = -3;
+  static const int MAX_REPLAY_SPEED_EXPONENT = 6;
+
+  /** Sets the replay playback speed to 2^exponent (clamped to the range above). Only replays are sped up
+   *  or slowed down, the game itself always runs in real time.
+   */
+  void SetReplaySpeed(int exponent);
+
+  /** Limits the number of physics ticks, which are run at once to catch up with the game time. If the simulation
+   *  falls further behind (e.g. a replay speed the CPU can't keep up with), the remaining backlog is dropped,
+   *  so the game slows down instead of trying to catch up with ever longer batches of ticks.
+   */
+  void SetMaxTicksPerUpdate(int maxTicks);
+
+private:
+  struct Command {
+    enum class Type { LOAD_REPLAY, SEEK_TO, SEEK_BY, SET_REPLAY_SPEED, SET_MAX_TICKS } type = Type::SEEK_BY;
+    int value = 0;
+    std::unique_ptr<ReplayInput> replay = nullptr; // only for LOAD_REPLAY
+  };
+
+  /** Queues the command for the simulation thread and wakes it up
+   */
+  void Post(Command&& command);
+
+  /** Runs all queued commands (on the simulation thread)
+   *
+   * @return true if at least one command has been run
+   */
+  bool RunCommands();
+
+  /** Makes the game time continue from the current tick (after loading or seeking)
+   */
+  void ResetGameTime();
+
+  /** Returns the exponent of the speed, the game time currently passes with (the replay speed while a replay is playing)
+   */
+  int GameSpeedExponent() const;
+
+  /** Fills the back buffer with the current state and publishes it
+   */
+  void PublishFrame();
+
+  /** The simulation thread's main loop
+   */
+  void Run();
+
+  // Only accessed by the simulation thread
+  Simulation simulation;
+  Clock& clock;
+  std::unique_ptr<ReplayIndex> replayIndex; // keyframes of the currently loaded replay
+  Clock::time_point lastGameTimeUpdate; // The time the game time has been advanced last
+  std::chrono::nanoseconds gameTime; // The time, which should have been simulated by now (the game tick lags behind by less than a tick)
+  int replaySpeedExponent = 0; // replay speed = 2^replaySpeedExponent
+  int maxTicksPerUpdate = 1024;
+
+  TripleBuffer<Frame> frames;
+
+  // Commands from other threads
+  std::mutex commandMutex;
+  std::condition_variable commandPosted;
+  std::vector<Command> commands;
+  bool stopping = false;
+
+  std::thread thread; // last member to start the thread after everything else has been constructed
+};
+
+}
@@ -1,23 +1,166 @@
 #include "stdafx.h"
 #include "Terrain.hpp"
+#include "DeterministicMath.hpp"
 
 #undef min
 #undef max
 
 namespace Lander {
 
+namespace {
+
+// Cubic Hermite spline between (0, value0) and (1, value1) with the given slopes (per unit of the fraction)
+float Hermite(float value0, float slope0, float value1, float slope1, float t) {
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  return (2 * t3 - 3 * t2 + 1) * value0 + (t3 - 2 * t2 + t) * slope0 + (3 * t2 - 2 * t3) * value1 + (t3 - t2) * slope1;
+}
+
+// The min/max tree only prunes nodes, which are out of reach by more than this (px), so rounding never prunes a touching node
+const float TREE_TOLERANCE = 1e-3f;
+
+float Cross(Vector a, Vector b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+/** Checks whether the segment from start to start + direction crosses the segment p-q
+ *  and returns the fraction of direction at the crossing in t
+ */
+bool CrossesSegment(Vector start, Vector direction, Vector p, Vector q, float& t) {
+  const Vector edge = q - p;
+  const float denominator = Cross(direction, edge);
+  if (denominator == 0) {
+    return false; // parallel
+  }
+  const Vector offset = p - start;
+  t = Cross(offset, edge) / denominator;
+  const float u = Cross(offset, direction) / denominator;
+  return t >= 0 && t <= 1 && u >= 0 && u <= 1;
+}
+
+/** Returns the y of the polyline (sorted by x) at the given x, which must be within the polyline
+ */
+float PolylineY(const std::array<Vector, 5>& points, int count, float x) {
+  for (int i = 1; i < count; ++i) {
+    if (x <= points[i].x) {
+      const float width = points[i].x - points[i - 1].x;
+      const float t = width > 0 ? (x - points[i - 1].x) / width : 0;
+      return points[i - 1].y + t * (points[i].y - points[i - 1].y);
+    }
+  }
+  return points[count - 1].y;
+}
+
+// Derivative of Hermite() with respect to the fraction
+float HermiteSlope(float value0, float slope0, float value1, float slope1, float t) {
+  const float t2 = t * t;
+  return (6 * t2 - 6 * t) * (value0 - value1) + (3 * t2 - 4 * t + 1) * slope0 + (3 * t2 - 2 * t) * slope1;
+}
+
+// The x of the first sample of a chunk of a seeded terrain
+float ChunkOriginX(int64_t index) {
+  return static_cast<float>(index) * Terrain::CHUNK_WIDTH;
+}
+
+// SplitMix64 finalizer
+uint64_t Mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// A pseudo random number in [0, 1), which only depends on its arguments
+double Random(uint64_t seed, int64_t chunk, uint64_t salt) {
+  return (Mix(seed ^ Mix(static_cast<uint64_t>(chunk) ^ Mix(salt + 0x9e3779b97f4a7c15ull))) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+}
+
+
+Terrain::Terrain(Interpolation interpolation, float sampleSpacing, uint64_t seed) : interpolation(interpolation), sampleSpacing(sampleSpacing), seed(seed) {}
+
+void Terrain::SetHeights(const float* heights, size_t count, float firstX, float spacing) {
+  this->heights.assign(heights, heights + count);
+  firstHeightX = firstX;
+  heightSpacing = spacing;
+  seed = 0;
+}
+
 void Terrain::Initialize(Size size) {
+  // The background thread generates the chunks for the current size, so it has to stop first
+  chunkCache.reset();
+  recentChunk.reset();
+  hasRecent = false;
   this->size = size; // The terrain spans the whole display
+  carvedChunks.clear();
+  craters.clear();
+  craterEntries.clear();
+  patches.clear();
+  craterLog.clear();
+  columnHeights.clear();
+
+  if (seed == 0) {
+    // The rocket may leave the display on both sides, so the samples continue for another display width in both directions
+    const size_t count = static_cast<size_t>(std::ceil(3 * size.width / sampleSpacing)) + 1;
+    GenerateChunk(-size.width, 0, count, sampled);
+    return;
+  }
+
+  chunkSegments = static_cast<size_t>(std::ceil(CHUNK_WIDTH / sampleSpacing));
+  chunkCache = std::make_unique<TerrainChunkCache>(CHUNK_CACHE_CAPACITY, [this](int64_t index) {
+    auto chunk = std::make_shared<TerrainChunk>();
+    GenerateChunk(ChunkOriginX(index), 0, chunkSegments + 1, *chunk);
+    return std::shared_ptr<const TerrainChunk>(std::move(chunk));
+  });
+  Prefetch(-size.width, 2 * size.width);
+}
+
+void Terrain::Prefetch(float x0, float x1) const {
+  if (chunkCache && std::isfinite(x0) && std::isfinite(x1)) {
+    chunkCache->Prefetch(ChunkIndex(x0) - 1, ChunkIndex(x1) + 1, ChunkIndex((x0 + x1) / 2));
+  }
 }
 
 void Terrain::Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) {
+  Prefetch(visibleRect.topLeft.x, visibleRect.bottomRight.x);
   Vector baseLine = Vector::Down * size.height;
-  for (int x = visibleRect.topLeft.x; x <= visibleRect.bottomRight.x; ++x) {
+  const int firstX = static_cast<int>(visibleRect.topLeft.x);
+  const int lastX = static_cast<int>(visibleRect.bottomRight.x);
+  if (lastX < firstX) {
+    return;
+  }
+  const float* heights = ColumnHeights(firstX, lastX);
+  for (int x = firstX; x <= lastX; ++x) {
     baseLine.x = static_cast<float>(x);
-    renderTarget.DrawLine(baseLine, baseLine + (Vector::Up*GetTerrainHeight(baseLine.x)), Color::LightSlateGray);
+    renderTarget.DrawLine(baseLine, baseLine + (Vector::Up*heights[x - firstX]), Color::LightSlateGray);
   }
 }
 
+const float* Terrain::ColumnHeights(int firstX, int lastX) {
+  const size_t count = static_cast<size_t>(std::max(lastX - firstX + 1, 0));
+  const int lastFirstX = columnsX;
+  const int lastEndX = columnsX + static_cast<int>(columnHeights.size());
+  if (firstX == lastFirstX && count == columnHeights.size()) {
+    return columnHeights.data();
+  }
+
+  previousColumnHeights.swap(columnHeights);
+  columnHeights.resize(count);
+  columnsX = firstX;
+  // Keep the columns, which have been requested last time, and calculate the others
+  const int keptFirstX = std::max(firstX, lastFirstX);
+  const int keptEndX = std::min(lastX + 1, lastEndX);
+  if (keptFirstX < keptEndX) {
+    std::copy(previousColumnHeights.begin() + (keptFirstX - lastFirstX), previousColumnHeights.begin() + (keptEndX - lastFirstX),
+              columnHeights.begin() + (keptFirstX - firstX));
+    GetTerrainHeights(static_cast<float>(firstX), 1, keptFirstX - firstX, columnHeights.data());
+    GetTerrainHeights(static_cast<float>(keptEndX), 1, lastX + 1 - keptEndX, columnHeights.data() + (keptEndX - firstX));
+  } else {
+    GetTerrainHeights(static_cast<float>(firstX), 1, count, columnHeights.data());
+  }
+  return columnHeights.data();
+}
+
 int Terrain::RenderPriority() const { return 1000; }
 
 
@@ -34,16 +177,312 @@ bool Terrain::IsPointInside(Vector worldPoint) const {
   return (terrainHeight < worldPoint.y);
 }
 
+bool Terrain::CollidesWith(const Collider& object, ContactManifold& contact) const {
+  // The points below the surface with their vertical depth
+  std::array<std::pair<float, Vector>, 8> inside;
+  int count = 0;
+  for (auto& point : object.OutlinePoints()) {
+    if (IsPointInside(point)) {
+      inside[count++] = { point.y - (size.height - GetTerrainHeight(point.x)), point };
+    }
+  }
+  if (count == 0) {
+    return false;
+  }
+
+  // The deepest points are the contact points
+  std::stable_sort(inside.begin(), inside.begin() + count, [](const auto& a, const auto& b) { return a.first > b.first; });
+  contact.pointCount = std::min(count, ContactManifold::MAX_POINTS);
+  for (int i = 0; i < contact.pointCount; ++i) {
+    contact.points[i] = inside[i].second;
+  }
+
+  contact.normal = SurfaceNormal(inside[0].second.x);
+  contact.depth = inside[0].first * -contact.normal.y; // vertical depth -> depth along the normal
+  return true;
+}
+
+float Terrain::Clearance(const Rectangle& rect, float maxDistance) const {
+  // Every point of the surface closer than maxDistance is within that x range and at least as low as the highest one
+  float minHeight, maxHeight;
+  if (!GetTerrainHeightRange(rect.topLeft.x - maxDistance, rect.bottomRight.x + maxDistance, minHeight, maxHeight)) {
+    return 0; // not sampled there
+  }
+  return std::clamp((size.height - maxHeight) - rect.bottomRight.y - TREE_TOLERANCE, 0.0f, maxDistance);
+}
+
+Rectangle Terrain::WorldBounds() const {
+  const float infinity = std::numeric_limits<float>::infinity();
+  return Rectangle(Vector(-infinity, -infinity), Vector(infinity, infinity));
+}
+
+
+bool Terrain::Locate(const TerrainChunk& chunk, float x, size_t& index, float& fraction) const {
+  const float position = (x - chunk.originX) / sampleSpacing;
+  if (chunk.samples.size() < 2 || !(position >= 0 && position < chunk.samples.size() - 1)) { // also false for NaN
+    return false;
+  }
+  index = static_cast<size_t>(position);
+  fraction = position - index;
+  return true;
+}
+
+bool Terrain::SamplesAround(float x, const Sample*& samples, float& fraction, std::array<Sample, 2>& calculated) const {
+  size_t index;
+  if (!chunkCache) {
+    if (!Locate(sampled, x, index, fraction)) {
+      return false;
+    }
+    samples = &sampled.samples[index];
+    return true;
+  }
+  if (!std::isfinite(x)) {
+    return false;
+  }
+
+  const int64_t chunkIndex = ChunkIndex(x);
+  const float originX = ChunkOriginX(chunkIndex);
+  const float position = (x - originX) / sampleSpacing;
+  index = std::min(static_cast<size_t>(std::max(position, 0.0f)), chunkSegments - 1);
+  fraction = position - index;
+  if (const TerrainChunk* chunk = RecentChunk(chunkIndex)) {
+    samples = &chunk->samples[index];
+  } else {
+    // The same samples as GenerateChunk()
+    ++missingChunkQueries;
+    calculated[0] = ExactSample(originX + static_cast<double>(index) * sampleSpacing);
+    calculated[1] = ExactSample(originX + static_cast<double>(index + 1) * sampleSpacing);
+    samples = calculated.data();
+  }
+  return true;
+}
+
+const TerrainChunk* Terrain::RecentChunk(int64_t index) const {
+  if (!carvedChunks.empty() && !(hasRecent && recentIndex == index)) {
+    auto carved = carvedChunks.find(index);
+    if (carved != carvedChunks.end()) {
+      hasRecent = true;
+      recentIndex = index;
+      recentChunk = carved->second;
+      return recentChunk.get();
+    }
+  }
+  if (hasRecent && recentIndex == index) {
+    if (!recentChunk) {
+      recentChunk = chunkCache->Find(index); // may have been generated meanwhile
+    }
+    return recentChunk.get();
+  }
+  hasRecent = true;
+  recentIndex = index;
+  recentChunk = chunkCache->Find(index);
+  chunkCache->Prefetch(index - PREFETCH_CHUNKS, index + PREFETCH_CHUNKS, index);
+  return recentChunk.get();
+}
+
+template <class Visit>
+void Terrain::VisitChunks(float x0, float x1, bool backwards, Visit visit) const {
+  if (!chunkCache) {
+    if (sampled.samples.size() < 2) {
+      return;
+    }
+    x0 = std::max(x0, sampled.originX);
+    x1 = std::min(x1, SampleX(sampled, sampled.samples.size() - 1));
+    if (x0 <= x1) {
+      visit(sampled, x0, x1);
+    }
+    return;
+  }
+  if (!(x0 <= x1) || !std::isfinite(x0) || !std::isfinite(x1)) {
+    return;
+  }
+
+  const int64_t first = ChunkIndex(x0), last = ChunkIndex(x1);
+  for (int64_t i = 0; i <= last - first; ++i) {
+    const int64_t index = backwards ? last - i : first + i;
+    const float originX = ChunkOriginX(index);
+    const float chunkX0 = std::max(x0, originX);
+    const float chunkX1 = std::min(x1, ChunkOriginX(index + 1));
+    RecentChunk(index);
+    const std::shared_ptr<const TerrainChunk> chunk = recentChunk; // stays alive, even if the visit queries other chunks
+    bool done;
+    if (chunk) {
+      done = visit(*chunk, chunkX0, chunkX1);
+    } else {
+      // Only the samples of the range
+      ++missingChunkQueries;
+      const size_t firstSegment = std::min(static_cast<size_t>(std::max((chunkX0 - originX) / sampleSpacing, 0.0f)), chunkSegments - 1);
+      const size_t endSegment = std::clamp(static_cast<size_t>(std::ceil((chunkX1 - originX) / sampleSpacing)), firstSegment + 1, chunkSegments);
+      TerrainChunk part;
+      GenerateChunk(originX, firstSegment, endSegment - firstSegment + 1, part);
+      done = visit(part, chunkX0, chunkX1);
+    }
+    if (done) {
+      return;
+    }
+  }
+}
+
+Vector Terrain::SurfaceNormal(float x) const {
+  // The surface is at y = size.height - height(x), so its upwards normal is (-height'(x), -1) (normalized)
+  float slope = GetTerrainSlope(x);
+  return Vector(-slope, -1) / Vector(-slope, -1).Length();
+}
 
 float Terrain::GetTerrainHeight(float x) const {
+  const Sample* samples;
+  float t;
+  std::array<Sample, 2> calculated;
+  if (!SamplesAround(x, samples, t, calculated)) {
+    return ExactTerrainHeight(x);
+  }
+
+  const Sample& a = samples[0];
+  const Sample& b = samples[1];
+  if (interpolation == Interpolation::Linear) {
+    return std::max(a.smooth + t * (b.smooth - a.smooth) + std::abs(a.folded + t * (b.folded - a.folded)), 0.0f);
+  }
+  const float smooth = Hermite(a.smooth, a.smoothSlope * sampleSpacing, b.smooth, b.smoothSlope * sampleSpacing, t);
+  const float folded = Hermite(a.folded, a.foldedSlope * sampleSpacing, b.folded, b.foldedSlope * sampleSpacing, t);
+  return std::max(smooth + std::abs(folded), 0.0f);
+}
+
+float Terrain::GetTerrainSlope(float x) const {
+  const Sample* samples;
+  float t;
+  std::array<Sample, 2> calculated;
+  if (!SamplesAround(x, samples, t, calculated)) {
+    return ExactTerrainSlope(x);
+  }
+
+  const Sample& a = samples[0];
+  const Sample& b = samples[1];
+  float smooth, smoothSlope, folded, foldedSlope;
+  if (interpolation == Interpolation::Linear) {
+    smooth = a.smooth + t * (b.smooth - a.smooth);
+    folded = a.folded + t * (b.folded - a.folded);
+    smoothSlope = a.smoothSlope + t * (b.smoothSlope - a.smoothSlope);
+    foldedSlope = a.foldedSlope + t * (b.foldedSlope - a.foldedSlope);
+  } else {
+    smooth = Hermite(a.smooth, a.smoothSlope * sampleSpacing, b.smooth, b.smoothSlope * sampleSpacing, t);
+    folded = Hermite(a.folded, a.foldedSlope * sampleSpacing, b.folded, b.foldedSlope * sampleSpacing, t);
+    smoothSlope = HermiteSlope(a.smooth, a.smoothSlope * sampleSpacing, b.smooth, b.smoothSlope * sampleSpacing, t) / sampleSpacing;
+    foldedSlope = HermiteSlope(a.folded, a.foldedSlope * sampleSpacing, b.folded, b.foldedSlope * sampleSpacing, t) / sampleSpacing;
+  }
+  if (smooth + std::abs(folded) <= 0) {
+    return 0; // flat where the height is clamped
+  }
+  return smoothSlope + (folded < 0 ? -foldedSlope : foldedSlope);
+}
+
+void Terrain::GetTerrainHeights(float x0, float dx, size_t count, float* heights) const {
+  for (size_t i = 0; i < count; ++i) {
+    heights[i] = GetTerrainHeight(x0 + i * dx);
+  }
+}
+
+Terrain::Sample Terrain::ExactSample(double x) const {
+  if (!heights.empty()) {
+    return HeightsSample(x);
+  }
+  if (seed != 0) {
+    return SeededSample(x);
+  }
+  // The same terms as ExactTerrainHeight() and their derivatives
+  const double amplitude = size.height/7.0;
+  const double horizScale = 0.02;
+  Sample sample;
+  sample.smooth = static_cast<float>(amplitude/2 + amplitude*SimulationMath::Sin(x*horizScale) + amplitude/2*SimulationMath::Cos(x*horizScale/3)
+                                     + amplitude/4*SimulationMath::Sin(x*horizScale*1.5) + x/size.width * size.height/3);
+  sample.smoothSlope = static_cast<float>(amplitude*horizScale*SimulationMath::Cos(x*horizScale) - amplitude/2*horizScale/3*SimulationMath::Sin(x*horizScale/3)
+                                          + amplitude/4*horizScale*1.5*SimulationMath::Cos(x*horizScale*1.5) + size.height/3/size.width);
+  sample.folded = static_cast<float>(amplitude*0.75*SimulationMath::Cos(x*horizScale*1.7));
+  sample.foldedSlope = static_cast<float>(-amplitude*0.75*horizScale*1.7*SimulationMath::Sin(x*horizScale*1.7));
+  return sample;
+}
+
+Terrain::Sample Terrain::SeededSample(double x) const {
+  // The classic curves with phases and a frequency from the seed, without the ascending slope
+  const double amplitude = size.height/7.0;
+  const double horizScale = 0.02 * (0.8 + 0.4*Random(seed, 0, 0));
+  std::array<double, 4> phase;
+  for (size_t i = 0; i < phase.size(); ++i) {
+    phase[i] = 2*Vector::PI*Random(seed, 0, i + 1);
+  }
+  const double wave = amplitude*SimulationMath::Sin(x*horizScale + phase[0]) + amplitude/2*SimulationMath::Cos(x*horizScale/3 + phase[1])
+                      + amplitude/4*SimulationMath::Sin(x*horizScale*1.5 + phase[2]);
+  const double waveSlope = amplitude*horizScale*SimulationMath::Cos(x*horizScale + phase[0]) - amplitude/2*horizScale/3*SimulationMath::Sin(x*horizScale/3 + phase[1])
+                           + amplitude/4*horizScale*1.5*SimulationMath::Cos(x*horizScale*1.5 + phase[2]);
+  const double fold = amplitude*0.75*SimulationMath::Cos(x*horizScale*1.7 + phase[3]);
+  const double foldSlope = -amplitude*0.75*horizScale*1.7*SimulationMath::Sin(x*horizScale*1.7 + phase[3]);
+
+  // Each chunk has its own roughness and ground level, blended with the next chunk's by a smoothstep, so the chunks join seamlessly
+  const double chunks = std::isfinite(x) ? std::floor(x / CHUNK_WIDTH) : 0;
+  const int64_t chunk = static_cast<int64_t>(chunks);
+  const double u = std::isfinite(x) ? x / CHUNK_WIDTH - chunks : 0;
+  const double blend = u*u*(3 - 2*u);
+  const double blendSlope = 6*u*(1 - u) / CHUNK_WIDTH;
+  auto roughness = [&](int64_t index) { return 0.4 + 0.8*Random(seed, index, 1); };
+  auto level = [&](int64_t index) { return amplitude*1.5*(Random(seed, index, 2) - 0.5); };
+  const double r = roughness(chunk) + (roughness(chunk + 1) - roughness(chunk))*blend;
+  const double rSlope = (roughness(chunk + 1) - roughness(chunk))*blendSlope;
+  const double base = amplitude + level(chunk) + (level(chunk + 1) - level(chunk))*blend;
+  const double baseSlope = (level(chunk + 1) - level(chunk))*blendSlope;
+
+  Sample sample;
+  sample.smooth = static_cast<float>(base + r*wave);
+  sample.smoothSlope = static_cast<float>(baseSlope + rSlope*wave + r*waveSlope);
+  sample.folded = static_cast<float>(r*fold);
+  sample.foldedSlope = static_cast<float>(rSlope*fold + r*foldSlope);
+  return sample;
+}
+
+Terrain::Sample Terrain::HeightsSample(double x) const {
+  Sample sample{};
+  if (heights.size() < 2) {
+    sample.smooth = heights.empty() ? 0 : heights[0];
+    return sample;
+  }
+  const double unclamped = (x - firstHeightX) / heightSpacing;
+  const double position = std::clamp(unclamped, 0.0, static_cast<double>(heights.size() - 1));
+  const size_t index = std::min(static_cast<size_t>(position), heights.size() - 2);
+  const double rise = static_cast<double>(heights[index + 1]) - heights[index];
+  sample.smooth = static_cast<float>(heights[index] + (position - index) * rise);
+  sample.smoothSlope = unclamped == position ? static_cast<float>(rise / heightSpacing) : 0; // flat beyond the heights
+  return sample;
+}
+
+void Terrain::GenerateChunk(float originX, size_t firstIndex, size_t count, TerrainChunk& chunk) const {
+  chunk.originX = originX;
+  chunk.firstIndex = firstIndex;
+  chunk.samples.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    chunk.samples[i] = ExactSample(originX + static_cast<double>(firstIndex + i) * sampleSpacing);
+  }
+  BuildHeightTree(chunk);
+}
+
+float Terrain::ExactTerrainSlope(float x) const {
+  if (ExactTerrainHeight(x) <= 0) {
+    return 0;
+  }
+  Sample sample = ExactSample(x);
+  return sample.smoothSlope + (sample.folded < 0 ? -sample.foldedSlope : sample.foldedSlope);
+}
+
+float Terrain::ExactTerrainHeight(float x) const {
+  if (seed != 0 || !heights.empty()) {
+    const Sample sample = ExactSample(x);
+    return std::max(sample.smooth + std::abs(sample.folded), 0.0f);
+  }
   const double amplitude = size.height/7.0;
   const double horizScale = 0.02;
   double height = amplitude/2;
   // Generate terrain by adding some curves
-  height += amplitude*sin(x*horizScale);
-  height += abs(amplitude*0.75*cos(x*horizScale*1.7));
-  height += amplitude/2*cos(x*horizScale/3);
-  height += amplitude/4*sin(x*horizScale*1.5);
+  height += amplitude*SimulationMath::Sin(x*horizScale);
+  height += std::fabs(amplitude*0.75*SimulationMath::Cos(x*horizScale*1.7));
+  height += amplitude/2*SimulationMath::Cos(x*horizScale/3);
+  height += amplitude/4*SimulationMath::Sin(x*horizScale*1.5);
   
 
   height += x/size.width * size.height/3; //Add ascending slope
@@ -52,4 +491,481 @@ float Terrain::GetTerrainHeight(float x) const {
 }
 
 
+int Terrain::SegmentPolyline(const TerrainChunk& chunk, size_t segment, std::array<Vector, 5>& points) const {
+  const Sample& a = chunk.samples[segment];
+  const Sample& b = chunk.samples[segment + 1];
+  const float x0 = SampleX(chunk, segment);
+  auto unclamped = [&](float t) { return a.smooth + t * (b.smooth - a.smooth) + std::abs(a.folded + t * (b.folded - a.folded)); };
+
+  // Between the kink of the absolute value and the ends, the unclamped height is linear
+  std::array<float, 3> breaks;
+  int breakCount = 0;
+  breaks[breakCount++] = 0;
+  if ((a.folded < 0) != (b.folded < 0)) {
+    breaks[breakCount++] = a.folded / (a.folded - b.folded);
+  }
+  breaks[breakCount++] = 1;
+
+  int count = 0;
+  for (int i = 0; i < breakCount; ++i) {
+    const float height = unclamped(breaks[i]);
+    if (i > 0) {
+      const float previousHeight = unclamped(breaks[i - 1]);
+      if ((previousHeight < 0) != (height < 0)) {
+        // The clamping at 0 starts or ends in between
+        const float t = breaks[i - 1] + (breaks[i] - breaks[i - 1]) * (previousHeight / (previousHeight - height));
+        points[count++] = Vector(x0 + t * sampleSpacing, size.height);
+      }
+    }
+    points[count++] = Vector(x0 + breaks[i] * sampleSpacing, size.height - std::max(height, 0.0f));
+  }
+  return count;
+}
+
+void Terrain::BuildHeightTree(TerrainChunk& chunk) const {
+  const size_t segments = chunk.samples.size() > 1 ? chunk.samples.size() - 1 : 0;
+  size_t& treeLeaves = chunk.treeLeaves;
+  std::vector<float>& topY = chunk.topY;
+  std::vector<float>& bottomY = chunk.bottomY;
+  treeLeaves = 1;
+  while (treeLeaves < segments) {
+    treeLeaves *= 2;
+  }
+  // Empty leaves are never reached
+  topY.assign(2 * treeLeaves, std::numeric_limits<float>::infinity());
+  bottomY.assign(2 * treeLeaves, -std::numeric_limits<float>::infinity());
+  UpdateHeightTree(chunk, 0, segments);
+}
+
+void Terrain::UpdateHeightTree(TerrainChunk& chunk, size_t first, size_t end) const {
+  if (first >= end) {
+    return;
+  }
+  std::vector<float>& topY = chunk.topY;
+  std::vector<float>& bottomY = chunk.bottomY;
+  std::array<Vector, 5> points;
+  for (size_t i = first; i < end; ++i) {
+    const int count = SegmentPolyline(chunk, i, points);
+    const size_t leaf = chunk.treeLeaves + i;
+    topY[leaf] = std::numeric_limits<float>::infinity();
+    bottomY[leaf] = -std::numeric_limits<float>::infinity();
+    for (int p = 0; p < count; ++p) {
+      topY[leaf] = std::min(topY[leaf], points[p].y);
+      bottomY[leaf] = std::max(bottomY[leaf], points[p].y);
+    }
+  }
+  // The parents of the changed nodes, level by level up to the root
+  for (size_t low = (chunk.treeLeaves + first) / 2, high = (chunk.treeLeaves + end - 1) / 2; low >= 1; low /= 2, high /= 2) {
+    for (size_t node = low; node <= high; ++node) {
+      topY[node] = std::min(topY[2 * node], topY[2 * node + 1]);
+      bottomY[node] = std::max(bottomY[2 * node], bottomY[2 * node + 1]);
+    }
+  }
+}
+
+
+void Terrain::AddCrater(const Crater& crater) {
+  // A crater, which is carved again after rewinding, reuses its entry, so the same craters always have the same snapshot
+  const uint32_t previousEntry = craterEntries.empty() ? 0 : craterEntries.back();
+  for (size_t i = craterLog.size(); i > 0; --i) {
+    if (craterLog[i - 1].previousEntry == previousEntry && craterLog[i - 1].crater == crater) {
+      CarveLogged(static_cast<uint32_t>(i));
+      return;
+    }
+  }
+  craterLog.push_back({ crater, previousEntry });
+  CarveLogged(static_cast<uint32_t>(craterLog.size()));
+}
+
+void Terrain::CarveLogged(uint32_t entry) {
+  const Crater& crater = craterLog[entry - 1].crater;
+  craters.push_back(crater);
+  craterEntries.push_back(entry);
+  if (!(crater.radius > 0) || !(crater.depth >= 0) || !std::isfinite(crater.x) || !std::isfinite(crater.y) || !std::isfinite(crater.radius)) {
+    return; // nothing to carve
+  }
+  if (!chunkCache) {
+    Carve(sampled, 0, craters.size() - 1);
+    return;
+  }
+  for (int64_t index = ChunkIndex(crater.x - crater.radius); index <= ChunkIndex(crater.x + crater.radius); ++index) {
+    Carve(CarvedChunk(index), index, craters.size() - 1);
+  }
+}
+
+void Terrain::RemoveCraters(size_t count) {
+  while (!patches.empty() && patches.back().crater >= count) {
+    const CraterPatch& patch = patches.back();
+    TerrainChunk& chunk = chunkCache ? *carvedChunks.at(patch.chunk) : sampled;
+    std::copy(patch.samples.begin(), patch.samples.end(), chunk.samples.begin() + patch.firstSample);
+    SamplesChanged(chunk, patch.firstSample, patch.firstSample + patch.samples.size() - 1);
+    patches.pop_back();
+  }
+  if (count < craters.size()) {
+    craters.resize(count);
+    craterEntries.resize(count);
+  }
+}
+
+Terrain::Snapshot Terrain::TakeSnapshot() const {
+  return { static_cast<uint32_t>(craters.size()), craterEntries.empty() ? 0 : craterEntries.back(), craters.empty() ? Crater{} : craters.back() };
+}
+
+void Terrain::Restore(const Snapshot& snapshot) {
+  // The snapshot's craters from the latest one back to the first one
+  std::vector<uint32_t> entries;
+  for (uint32_t entry = snapshot.logEntry; entry != 0 && entry <= craterLog.size(); entry = craterLog[entry - 1].previousEntry) {
+    entries.push_back(entry);
+  }
+  if (entries.size() != snapshot.craters) {
+    Mirror(snapshot); // not taken by this terrain since its last Initialize()
+    return;
+  }
+
+  // Keep the craters both have in common and carve the rest in their order
+  size_t common = 0;
+  while (common < craterEntries.size() && common < entries.size() && craterEntries[common] == entries[entries.size() - 1 - common]) {
+    ++common;
+  }
+  RemoveCraters(common);
+  for (size_t i = common; i < entries.size(); ++i) {
+    CarveLogged(entries[entries.size() - 1 - i]);
+  }
+}
+
+void Terrain::Mirror(const Snapshot& snapshot) {
+  if (snapshot.craters == 0) {
+    RemoveCraters(0);
+    return;
+  }
+  if (!craters.empty() && craters.size() <= snapshot.craters && craters.back() == snapshot.lastCrater) {
+    return; // already shown
+  }
+  RemoveCraters(std::min<size_t>(craters.size(), snapshot.craters - 1));
+  AddCrater(snapshot.lastCrater);
+}
+
+TerrainChunk& Terrain::CarvedChunk(int64_t index) {
+  if (!chunkCache) {
+    return sampled;
+  }
+  std::shared_ptr<TerrainChunk>& chunk = carvedChunks[index];
+  if (!chunk) {
+    if (auto cached = chunkCache->Find(index)) {
+      chunk = std::make_shared<TerrainChunk>(*cached);
+    } else {
+      chunk = std::make_shared<TerrainChunk>();
+      GenerateChunk(ChunkOriginX(index), 0, chunkSegments + 1, *chunk);
+    }
+    hasRecent = false; // RecentChunk() has to return the copy from now on
+    recentChunk.reset();
+  }
+  return *chunk;
+}
+
+void Terrain::Carve(TerrainChunk& chunk, int64_t chunkIndex, size_t craterIndex) {
+  const Crater& crater = craters[craterIndex];
+  if (chunk.samples.size() < 2) {
+    return;
+  }
+  const size_t lastSample = chunk.samples.size() - 1;
+  const float first = std::ceil((crater.x - crater.radius - SampleX(chunk, 0)) / sampleSpacing);
+  const float last = std::floor((crater.x + crater.radius - SampleX(chunk, 0)) / sampleSpacing);
+  if (last < 0 || first > lastSample) {
+    return;
+  }
+  const size_t firstIndex = static_cast<size_t>(std::max(first, 0.0f));
+  const size_t lastIndex = std::min(static_cast<size_t>(last), lastSample);
+  if (firstIndex > lastIndex) {
+    return;
+  }
+
+  CraterPatch patch{ craterIndex, chunkIndex, firstIndex, std::vector<Sample>(chunk.samples.begin() + firstIndex, chunk.samples.begin() + lastIndex + 1) };
+  bool changed = false;
+  for (size_t i = firstIndex; i <= lastIndex; ++i) {
+    const float u = (SampleX(chunk, i) - crater.x) / crater.radius;
+    if (!(std::abs(u) < 1)) {
+      continue;
+    }
+    // The bottom of the bowl: y = crater.y + depth * sqrt(1 - u^2)
+    const float root = std::sqrt(1 - u * u);
+    const float bottom = size.height - (crater.y + crater.depth * root);
+    Sample& sample = chunk.samples[i];
+    if (std::max(bottom, 0.0f) >= std::max(sample.smooth + std::abs(sample.folded), 0.0f)) {
+      continue; // already lower
+    }
+    // The bowl replaces the profile at the sample. Its slope gets steep at the rim, so it is limited there.
+    sample.smooth = std::max(bottom, 0.0f);
+    sample.smoothSlope = bottom > 0 ? crater.depth * u / (std::max(root, 0.1f) * crater.radius) : 0;
+    sample.folded = 0;
+    sample.foldedSlope = 0;
+    changed = true;
+  }
+  if (changed) {
+    patches.push_back(std::move(patch));
+    SamplesChanged(chunk, firstIndex, lastIndex);
+  }
+}
+
+void Terrain::SamplesChanged(TerrainChunk& chunk, size_t first, size_t last) {
+  // The segments on both sides of the changed samples
+  const size_t firstSegment = first > 0 ? first - 1 : 0;
+  const size_t endSegment = std::min(last + 1, chunk.samples.size() - 1);
+  UpdateHeightTree(chunk, firstSegment, endSegment);
+
+  if (columnHeights.empty()) {
+    return;
+  }
+  const int firstX = std::max(columnsX, static_cast<int>(std::floor(SampleX(chunk, firstSegment))));
+  const int lastX = std::min(columnsX + static_cast<int>(columnHeights.size()) - 1, static_cast<int>(std::ceil(SampleX(chunk, endSegment))));
+  if (firstX <= lastX) {
+    GetTerrainHeights(static_cast<float>(firstX), 1, lastX - firstX + 1, columnHeights.data() + (firstX - columnsX));
+  }
+}
+
+float Terrain::GetAltitude(Vector point) const {
+  return (size.height - GetTerrainHeight(point.x)) - point.y;
+}
+
+bool Terrain::GetTerrainHeightRange(float x0, float x1, float& minHeight, float& maxHeight) const {
+  if (x1 < x0) {
+    std::swap(x0, x1);
+  }
+
+  float top = std::numeric_limits<float>::infinity();
+  float bottom = -std::numeric_limits<float>::infinity();
+  bool sampledRange = false;
+  VisitChunks(x0, x1, false, [&](const TerrainChunk& chunk, float chunkX0, float chunkX1) {
+    SurfaceRange(chunk, 1, 0, chunk.treeLeaves, chunkX0, chunkX1, top, bottom);
+    sampledRange = true;
+    return false;
+  });
+  if (!sampledRange) {
+    return false;
+  }
+  minHeight = size.height - bottom;
+  maxHeight = size.height - top;
+  return true;
+}
+
+void Terrain::SurfaceRange(const TerrainChunk& chunk, size_t node, size_t first, size_t end, float x0, float x1, float& top, float& bottom) const {
+  const size_t segments = chunk.samples.size() - 1;
+  const float nodeX0 = SampleX(chunk, first);
+  const float nodeX1 = SampleX(chunk, std::min(end, segments));
+  if (first >= segments || nodeX1 < x0 || nodeX0 > x1) {
+    return;
+  }
+  if (x0 <= nodeX0 && nodeX1 <= x1) {
+    top = std::min(top, chunk.topY[node]);
+    bottom = std::max(bottom, chunk.bottomY[node]);
+    return;
+  }
+  if (end - first == 1) {
+    // Partly covered leaf: the polyline points in the range and both ends of the range
+    std::array<Vector, 5> points;
+    const int count = SegmentPolyline(chunk, first, points);
+    for (int i = 0; i < count; ++i) {
+      if (x0 <= points[i].x && points[i].x <= x1) {
+        top = std::min(top, points[i].y);
+        bottom = std::max(bottom, points[i].y);
+      }
+    }
+    for (float x : { std::max(x0, nodeX0), std::min(x1, nodeX1) }) {
+      const float y = PolylineY(points, count, x);
+      top = std::min(top, y);
+      bottom = std::max(bottom, y);
+    }
+    return;
+  }
+  const size_t middle = (first + end) / 2;
+  SurfaceRange(chunk, 2 * node, first, middle, x0, x1, top, bottom);
+  SurfaceRange(chunk, 2 * node + 1, middle, end, x0, x1, top, bottom);
+}
+
+bool Terrain::IntersectSegment(Vector from, Vector to, Hit& hit) const {
+  if (!chunkCache && sampled.samples.size() < 2) {
+    return false;
+  }
+  if (GetAltitude(from) < 0) {
+    hit.pos = from;
+    hit.normal = SurfaceNormal(from.x);
+    hit.fraction = 0;
+    return true;
+  }
+  // The chunk, which the segment passes first, has the earlier hit
+  const Vector direction = to - from;
+  bool found = false;
+  VisitChunks(std::min(from.x, to.x), std::max(from.x, to.x), direction.x < 0, [&](const TerrainChunk& chunk, float, float) {
+    found = IntersectSegment(chunk, 1, 0, chunk.treeLeaves, from, direction, hit);
+    return found;
+  });
+  return found;
+}
+
+bool Terrain::IntersectSegment(const TerrainChunk& chunk, size_t node, size_t first, size_t end, Vector from, Vector direction, Hit& hit) const {
+  const size_t segments = chunk.samples.size() - 1;
+  if (first >= segments) {
+    return false;
+  }
+
+  // The part of the segment above the node
+  const float nodeX0 = SampleX(chunk, first);
+  const float nodeX1 = SampleX(chunk, std::min(end, segments));
+  float t0 = 0, t1 = 1;
+  if (direction.x != 0) {
+    const float ta = (nodeX0 - from.x) / direction.x;
+    const float tb = (nodeX1 - from.x) / direction.x;
+    t0 = std::max(t0, std::min(ta, tb));
+    t1 = std::min(t1, std::max(ta, tb));
+    if (t0 > t1) {
+      return false;
+    }
+  } else if (from.x < nodeX0 || from.x > nodeX1) {
+    return false;
+  }
+  // It can only reach the surface if its lowest point there is as low as the highest point of the surface
+  const float lowestY = std::max(from.y + t0 * direction.y, from.y + t1 * direction.y);
+  if (lowestY + TREE_TOLERANCE < chunk.topY[node]) {
+    return false;
+  }
+
+  if (end - first == 1) {
+    std::array<Vector, 5> points;
+    const int count = SegmentPolyline(chunk, first, points);
+    float best = std::numeric_limits<float>::infinity();
+    for (int i = 0; i + 1 < count; ++i) {
+      float t;
+      if (CrossesSegment(from, direction, points[i], points[i + 1], t) && t < best) {
+        best = t;
+      }
+    }
+    if (best > 1) {
+      return false;
+    }
+    hit.pos = from + direction * best;
+    hit.normal = SurfaceNormal(hit.pos.x);
+    hit.fraction = best;
+    return true;
+  }
+
+  // The child, which the segment passes first, has the earlier hit
+  const size_t middle = (first + end) / 2;
+  if (direction.x >= 0) {
+    return IntersectSegment(chunk, 2 * node, first, middle, from, direction, hit) || IntersectSegment(chunk, 2 * node + 1, middle, end, from, direction, hit);
+  }
+  return IntersectSegment(chunk, 2 * node + 1, middle, end, from, direction, hit) || IntersectSegment(chunk, 2 * node, first, middle, from, direction, hit);
+}
+
+bool Terrain::IntersectRay(Vector origin, Vector direction, float maxDistance, Hit& hit) const {
+  return IntersectSegment(origin, origin + direction * (maxDistance / direction.Length()), hit);
+}
+
+bool Terrain::IsVisible(Vector from, Vector to) const {
+  Hit hit;
+  return !IntersectSegment(from, to, hit);
+}
+
+bool Terrain::SweepBox(const Rectangle& box, Vector displacement, Hit& hit) const {
+  if (!chunkCache && sampled.samples.size() < 2) {
+    return false;
+  }
+  float minHeight, maxHeight;
+  if (GetTerrainHeightRange(box.topLeft.x, box.bottomRight.x, minHeight, maxHeight) && size.height - maxHeight < box.bottomRight.y) {
+    const float x = (box.topLeft.x + box.bottomRight.x) / 2;
+    hit.pos = Vector(x, size.height - GetTerrainHeight(x));
+    hit.normal = SurfaceNormal(x);
+    hit.fraction = 0;
+    return true;
+  }
+
+  // A box spans several chunks, so all chunks along the way are searched (pruned by the best hit so far)
+  bool found = false;
+  const float x0 = std::min(box.topLeft.x, box.topLeft.x + displacement.x);
+  const float x1 = std::max(box.bottomRight.x, box.bottomRight.x + displacement.x);
+  VisitChunks(x0, x1, displacement.x < 0, [&](const TerrainChunk& chunk, float, float) {
+    SweepBox(chunk, 1, 0, chunk.treeLeaves, box, displacement, hit, found);
+    return false;
+  });
+  return found;
+}
+
+void Terrain::SweepBox(const TerrainChunk& chunk, size_t node, size_t first, size_t end, const Rectangle& box, Vector displacement, Hit& hit, bool& found) const {
+  const size_t segments = chunk.samples.size() - 1;
+  if (first >= segments) {
+    return;
+  }
+
+  // The time, during which the box is above the node, and before the best hit so far
+  const float nodeX0 = SampleX(chunk, first);
+  const float nodeX1 = SampleX(chunk, std::min(end, segments));
+  const float left = box.topLeft.x, right = box.bottomRight.x, bottom = box.bottomRight.y;
+  float t0 = 0, t1 = found ? hit.fraction : 1;
+  if (displacement.x > 0) {
+    t0 = std::max(t0, (nodeX0 - right) / displacement.x);
+    t1 = std::min(t1, (nodeX1 - left) / displacement.x);
+  } else if (displacement.x < 0) {
+    t0 = std::max(t0, (nodeX1 - left) / displacement.x);
+    t1 = std::min(t1, (nodeX0 - right) / displacement.x);
+  } else if (right < nodeX0 || left > nodeX1) {
+    return;
+  }
+  if (t0 > t1) {
+    return;
+  }
+  // The bottom of the box must reach the highest point of the surface
+  const float lowestBottom = std::max(bottom + t0 * displacement.y, bottom + t1 * displacement.y);
+  if (lowestBottom + TREE_TOLERANCE < chunk.topY[node]) {
+    return;
+  }
+
+  if (end - first == 1) {
+    std::array<Vector, 5> points;
+    const int count = SegmentPolyline(chunk, first, points);
+    auto record = [&](float t, Vector pos) {
+      if (!found || t < hit.fraction) {
+        found = true;
+        hit.fraction = t;
+        hit.pos = pos;
+      }
+    };
+
+    // The bottom corners of the box moving onto the surface
+    const Vector bottomLeft(left, bottom), bottomRight(right, bottom);
+    for (int i = 0; i + 1 < count; ++i) {
+      float t;
+      for (const Vector& corner : { bottomLeft, bottomRight }) {
+        if (CrossesSegment(corner, displacement, points[i], points[i + 1], t)) {
+          record(t, corner + displacement * t);
+        }
+      }
+    }
+    // The points of the surface moving onto the edges of the box (seen from the box, the surface moves by -displacement)
+    const Vector topLeft(left, box.topLeft.y), topRight(right, box.topLeft.y);
+    const std::array<std::pair<Vector, Vector>, 3> edges = { { { topLeft, bottomLeft }, { topRight, bottomRight }, { bottomLeft, bottomRight } } };
+    for (int i = 0; i < count; ++i) {
+      float t;
+      for (const auto& edge : edges) {
+        if (CrossesSegment(points[i], displacement * -1, edge.first, edge.second, t)) {
+          record(t, points[i]);
+        }
+      }
+    }
+    if (found) {
+      hit.normal = SurfaceNormal(hit.pos.x);
+    }
+    return;
+  }
+
+  // Visit the child, which the box passes first, first, so the other one can be pruned by its hit
+  const size_t middle = (first + end) / 2;
+  if (displacement.x >= 0) {
+    SweepBox(chunk, 2 * node, first, middle, box, displacement, hit, found);
+    SweepBox(chunk, 2 * node + 1, middle, end, box, displacement, hit, found);
+  } else {
+    SweepBox(chunk, 2 * node + 1, middle, end, box, displacement, hit, found);
+    SweepBox(chunk, 2 * node, first, middle, box, displacement, hit, found);
+  }
+}
+
+
 }
\ No newline at end of file
@@ -1,13 +1,54 @@
 #pragma once
 
+#include "TerrainChunkCache.hpp"
+
 namespace Lander {
 
+/** The ground of the level. Its profile is a sum of sine curves, which is sampled into a height array in Initialize(),
+ *  so a height query only has to interpolate between two samples.
+ *
+ *  The classic terrain (seed 0) is sampled once from -width to 2*width. A seeded terrain continues without end: its profile is
+ *  generated per chunk of CHUNK_WIDTH px from the seed and the chunk's index, the chunks around the queries and the visible area
+ *  are generated ahead on a background thread and only the most recently used ones are kept (see TerrainChunkCache).
+ *  A query never waits for a chunk: if it hasn't been generated yet, the query calculates the samples it needs itself, which
+ *  gives exactly the same results.
+ */
 class Terrain : public Collider {
 public:
+  enum class Interpolation {
+    Linear, // between the heights of both samples
+    Cubic   // Hermite spline through the heights and exact slopes of both samples (smaller error, a few more operations)
+  };
+
+  static constexpr float CHUNK_WIDTH = 1024;        // px of a chunk of a seeded terrain
+  static constexpr size_t CHUNK_CACHE_CAPACITY = 16; // chunks a seeded terrain keeps
+  static constexpr int PREFETCH_CHUNKS = 2;          // chunks generated ahead on both sides of the queried chunk
+
+  /** @param interpolation how heights between the samples are calculated
+   *  @param sampleSpacing the horizontal distance between two samples (px)
+   *  @param seed 0 for the classic terrain, anything else for an endless terrain generated from it
+   */
+  explicit Terrain(Interpolation interpolation = Interpolation::Linear, float sampleSpacing = 1, uint64_t seed = 0);
+
+  /** Replaces the profile with the given heights, which are spacing px apart starting at firstX, linearly interpolated and
+   *  continued with the first and the last height beyond them (e.g. from a LevelFile). The heights are copied and the terrain
+   *  isn't seeded anymore. Must be called before Initialize().
+   */
+  void SetHeights(const float* heights, size_t count, float firstX, float spacing);
+
+  /** Samples the terrain profile for the given size (from -width to 2*width, queries outside of that calculate the exact profile).
+   *  A seeded terrain starts generating the chunks around the display instead.
+   */
   virtual void Initialize(Size size) override;
 
   virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override;
 
+  /** Returns the heights of the columns from firstX to lastX (1 px apart), which Draw() draws. They are kept between the frames:
+   *  only the columns, which weren't requested last time, are calculated and craters update the columns they change.
+   *  The pointer is valid until the next call.
+   */
+  const float* ColumnHeights(int firstX, int lastX);
+
   /** Specify high render priority to first draw the terrain.
    */
   virtual int RenderPriority() const override;
@@ -17,15 +58,275 @@ public:
    */
   virtual Vector GetTerrainPos(float x) const;
 
+  /** Where a ray, segment or box hits the terrain first
+   */
+  struct Hit {
+    Vector pos;     // the first point touching the surface (for boxes the point of contact at that time)
+    Vector normal;  // the surface normal there
+    float fraction; // 0-1, the fraction of the segment or the box's displacement before the hit
+  };
+
+  // The queries below use a min/max tree over the sampled surface (see BuildHeightTree()) and take O(log n) instead of
+  // stepping along the surface. They treat the surface as the linear interpolation of the samples (for cubic interpolation
+  // it differs by the interpolation error) and the classic terrain only knows the sampled range (-width to 2*width).
+
+  /** Returns how far the point is above the surface directly below it (negative if it is below the surface)
+   */
+  float GetAltitude(Vector point) const;
+
+  /** Returns the lowest and the highest terrain height between x0 and x1. Returns false if the range isn't sampled at all.
+   */
+  bool GetTerrainHeightRange(float x0, float x1, float& minHeight, float& maxHeight) const;
+
+  /** Finds the first point of the segment, which is below the surface. A segment, which starts below the surface, hits at fraction 0.
+   */
+  bool IntersectSegment(Vector from, Vector to, Hit& hit) const;
+
+  /** Finds the first point of the ray within the given distance, which is below the surface (fraction is relative to maxDistance)
+   */
+  bool IntersectRay(Vector origin, Vector direction, float maxDistance, Hit& hit) const;
+
+  /** Returns true if the segment between both points doesn't touch the terrain
+   */
+  bool IsVisible(Vector from, Vector to) const;
+
+  /** Moves the axis aligned box along the displacement and finds the first time, at which it touches the surface.
+   *  A box, which already overlaps the terrain, hits at fraction 0.
+   */
+  bool SweepBox(const Rectangle& box, Vector displacement, Hit& hit) const;
+
   virtual bool IsPointInside(Vector point) const override;
 
+  /** Returns the height of the rectangle's bottom above the highest point of the surface within maxDistance to the left
+   *  and right of it (see GetTerrainHeightRange())
+   */
+  virtual float Clearance(const Rectangle& rect, float maxDistance) const override;
+
+  /** The terrain continues beyond its size in every direction, so its bounds are unlimited
+   */
+  virtual Rectangle WorldBounds() const override;
+
+  /** The terrain is no rectangle: the corners and the centers of the edges of the object are checked to be below the surface.
+   *  The contact normal is the surface normal at the deepest of these points.
+   */
+  virtual bool CollidesWith(const Collider& object, ContactManifold& contact) const override;
+
   virtual bool DrawBoundingBox() override { return false; }
 
-private:
-  /** Returns the terrain height at the given position
+  /** Returns the terrain height at the given position, interpolated between the samples
    */
   float GetTerrainHeight(float x) const;
 
+  /** Returns the slope (height change per px) of the terrain at the given position, interpolated between the exact slopes of the samples
+   *  (for cubic interpolation the derivative of the spline)
+   */
+  float GetTerrainSlope(float x) const;
+
+  /** Writes the heights at x0, x0 + dx, ..., x0 + (count-1)*dx into heights (same results as GetTerrainHeight())
+   */
+  void GetTerrainHeights(float x0, float dx, size_t count, float* heights) const;
+
+  /** Returns the height of the terrain profile, which the samples are taken from, at the given position
+   */
+  float ExactTerrainHeight(float x) const;
+
+  /** Returns the slope of the terrain profile at the given position
+   */
+  float ExactTerrainSlope(float x) const;
+
+  uint64_t Seed() const { return seed; }
+
+  /** Queues the chunks of a seeded terrain between both positions (and one more on both sides) for the background thread.
+   *  Called by Draw() for the visible area.
+   */
+  void Prefetch(float x0, float x1) const;
+
+  /** Returns the chunk cache of a seeded terrain (nullptr for the classic terrain or before Initialize())
+   */
+  TerrainChunkCache* GetChunkCache() const { return chunkCache.get(); }
+
+  /** Returns the index of the chunk of a seeded terrain, which contains the given position
+   */
+  static int64_t ChunkIndex(float x) { return static_cast<int64_t>(std::floor(x / CHUNK_WIDTH)); }
+
+  /** Returns the number of queries, which had to calculate their samples because the chunk hadn't been generated yet
+   */
+  uint64_t MissingChunkQueries() const { return missingChunkQueries; }
+
+  /** A bowl carved into the terrain (e.g. by a crash, see AddCrater())
+   */
+  struct Crater {
+    float x, y;   // the center (usually on the surface)
+    float radius; // px
+    float depth;  // px below the center at the middle of the bowl
+
+    bool operator==(const Crater& other) const = default;
+  };
+
+  /** Carves the crater into the terrain: within its radius the surface drops to the bottom of the elliptic bowl below its center
+   *  wherever that is lower. Only the samples below the crater, the nodes of the min/max tree above them and the columns of Draw()
+   *  they change are updated, so the queries and draws cost the same no matter how many craters have been carved.
+   *  The classic terrain is only carved within its samples (from -width to 2*width). Initialize() and a reset of the rocket remove all craters.
+   */
+  void AddCrater(const Crater& crater);
+
+  size_t CraterCount() const { return craters.size(); }
+
+  /** Removes the latest craters until the given number is left and restores the samples they have changed
+   */
+  void RemoveCraters(size_t count);
+
+  /** The craters of the terrain. Every crater carved since Initialize() is kept in an append-only log together with the crater
+   *  carved before it, so the snapshot only holds the log entry of its latest crater and the chain of entries leading to it is the
+   *  complete list of its craters. The latest crater itself is stored as well to show it in another terrain (see Mirror()).
+   */
+  struct Snapshot {
+    uint32_t craters;  // CraterCount()
+    uint32_t logEntry; // 1-based index of the latest crater in the log, 0 without craters
+    Crater lastCrater; // zero radius without craters
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  Snapshot TakeSnapshot() const;
+
+  /** Restores the craters of a snapshot, which this terrain has taken since its last Initialize(): removes the craters, which
+   *  the snapshot lacks, and carves the snapshot's craters, which the terrain lacks, from the log
+   */
+  void Restore(const Snapshot& snapshot);
+
+  /** Shows the craters of a snapshot of a terrain, which is simulated somewhere else (whose log this terrain doesn't have):
+   *  removes the craters after the snapshot's count and carves its latest crater, if the terrain lacks it. Craters before the
+   *  latest one, which the terrain lacks, stay missing (the rocket resets the terrain's craters, so a flight has at most one).
+   */
+  void Mirror(const Snapshot& snapshot);
+
+private:
+  using Sample = TerrainChunk::Sample;
+
+  /** Returns the exact sample for the given position
+   */
+  Sample ExactSample(double x) const;
+
+  /** Returns the exact sample of a seeded terrain for the given position
+   */
+  Sample SeededSample(double x) const;
+
+  /** Returns the sample of the heights set by SetHeights() for the given position
+   */
+  Sample HeightsSample(double x) const;
+
+  /** Generates the samples [firstIndex, firstIndex + count) of the grid starting at originX and their min/max tree
+   */
+  void GenerateChunk(float originX, size_t firstIndex, size_t count, TerrainChunk& chunk) const;
+
+  /** Returns the x of the given sample of the chunk
+   */
+  float SampleX(const TerrainChunk& chunk, size_t index) const { return chunk.originX + (chunk.firstIndex + index) * sampleSpacing; }
+
+  /** Finds the samples around the given position: chunk.samples[index] and chunk.samples[index + 1] with the position at the given
+   *  fraction (0-1) between them. Returns false if the position is outside of the chunk's samples, which must start at sample 0.
+   */
+  bool Locate(const TerrainChunk& chunk, float x, size_t& index, float& fraction) const;
+
+  /** Finds the samples around the given position (samples[0] and samples[1]) and the fraction (0-1) between them. The samples of
+   *  missing chunks of a seeded terrain are calculated into calculated. Returns false if the position is outside of the classic terrain's samples.
+   */
+  bool SamplesAround(float x, const Sample*& samples, float& fraction, std::array<Sample, 2>& calculated) const;
+
+  /** Returns the generated chunk of a seeded terrain with the given index or nullptr. The pointer is valid until the next call.
+   */
+  const TerrainChunk* RecentChunk(int64_t index) const;
+
+  /** Calls visit(chunk, x0, x1) for the parts of the range [x0, x1], which have samples, chunk by chunk (backwards from x1 if
+   *  backwards is true) until visit returns true. Missing chunks of a seeded terrain are calculated for the range only.
+   */
+  template <class Visit>
+  void VisitChunks(float x0, float x1, bool backwards, Visit visit) const;
+
+  /** Writes the surface between chunk.samples[segment] and chunk.samples[segment + 1] as polyline (at most 5 points in world coordinates,
+   *  the kinks of the absolute value and of the clamping at 0 are points of their own) and returns the number of points.
+   */
+  int SegmentPolyline(const TerrainChunk& chunk, size_t segment, std::array<Vector, 5>& points) const;
+
+  /** Rebuilds the min/max tree of the chunk from its samples
+   */
+  void BuildHeightTree(TerrainChunk& chunk) const;
+
+  /** Updates the leaves of the segments [first, end) of the chunk's min/max tree and the nodes above them.
+   *  Must be called whenever samples change.
+   */
+  void UpdateHeightTree(TerrainChunk& chunk, size_t first, size_t end) const;
+
+  /** Returns the chunk with the given index, which craters may change: the classic terrain's samples or a copy of the chunk of a
+   *  seeded terrain, which is kept apart from the chunk cache, so the craters stay when the cache drops the chunk
+   */
+  TerrainChunk& CarvedChunk(int64_t index);
+
+  /** Lowers the samples of the chunk below the given crater and remembers their former values in patches
+   */
+  void Carve(TerrainChunk& chunk, int64_t chunkIndex, size_t crater);
+
+  /** Updates the min/max tree and the columns of Draw() after the samples [first, last] of the chunk have changed
+   */
+  void SamplesChanged(TerrainChunk& chunk, size_t first, size_t last);
+
+  /** Returns the upwards normal of the surface at the given position
+   */
+  Vector SurfaceNormal(float x) const;
+
+  // Recursive parts of the queries. The node covers the segments [first, end) between the chunk's samples.
+  bool IntersectSegment(const TerrainChunk& chunk, size_t node, size_t first, size_t end, Vector from, Vector direction, Hit& hit) const;
+  void SweepBox(const TerrainChunk& chunk, size_t node, size_t first, size_t end, const Rectangle& box, Vector displacement, Hit& hit, bool& found) const;
+  void SurfaceRange(const TerrainChunk& chunk, size_t node, size_t first, size_t end, float x0, float x1, float& topY, float& bottomY) const;
+
+  Interpolation interpolation;
+  float sampleSpacing;
+  uint64_t seed;
+  std::vector<float> heights; // see SetHeights()
+  float firstHeightX = 0;
+  float heightSpacing = 1;
+  TerrainChunk sampled;    // the samples of the classic terrain
+  size_t chunkSegments = 0; // segments between the samples of a chunk of a seeded terrain
+
+  // The chunk of a seeded terrain, which has been queried last
+  mutable int64_t recentIndex = 0;
+  mutable std::shared_ptr<const TerrainChunk> recentChunk;
+  mutable bool hasRecent = false;
+  mutable uint64_t missingChunkQueries = 0;
+
+  // The chunks of a seeded terrain, which craters have changed (see CarvedChunk())
+  std::unordered_map<int64_t, std::shared_ptr<TerrainChunk>> carvedChunks;
+
+  // The samples, which a crater has changed, before the change (to remove the crater again)
+  struct CraterPatch {
+    size_t crater;
+    int64_t chunk; // index of the chunk of a seeded terrain
+    size_t firstSample;
+    std::vector<Sample> samples;
+  };
+  std::vector<Crater> craters;
+  std::vector<uint32_t> craterEntries; // the log entries of the craters (see Snapshot)
+  std::vector<CraterPatch> patches;    // in the order of the craters
+
+  // All craters carved since Initialize() with the entry of the crater carved before them (see Snapshot)
+  struct LoggedCrater {
+    Crater crater;
+    uint32_t previousEntry;
+  };
+  std::vector<LoggedCrater> craterLog;
+
+  /** Carves the crater of the given log entry on top of the current craters
+   */
+  void CarveLogged(uint32_t entry);
+
+  // The heights of the columns of the last ColumnHeights() call starting at columnsX and the buffer for the next call
+  std::vector<float> columnHeights;
+  std::vector<float> previousColumnHeights;
+  int columnsX = 0;
+
+  // Destroyed first, so its thread has stopped before the state it generates the chunks from
+  std::unique_ptr<TerrainChunkCache> chunkCache;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "stdafx.h"
+#include "TerrainChunkCache.hpp"
+
+namespace Lander {
+
+
+TerrainChunkCache::TerrainChunkCache(size_t capacity, Generator generator)
+  : capacity(std::max<size_t>(capacity, 1)), generator(std::move(generator)), thread(&TerrainChunkCache::Run, this) {}
+
+TerrainChunkCache::~TerrainChunkCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+std::shared_ptr<const TerrainChunk> TerrainChunkCache::Find(int64_t index) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = chunkIndex.find(index);
+  if (found == chunkIndex.end()) {
+    ++statistics.misses;
+    return nullptr;
+  }
+  ++statistics.hits;
+  chunks.splice(chunks.begin(), chunks, found->second);
+  return found->second->second;
+}
+
+void TerrainChunkCache::Prefetch(int64_t first, int64_t last, int64_t center) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.clear();
+    // Nearest to the center first, at most as many as can be cached
+    for (int64_t distance = 0; queue.size() < capacity && (center - distance >= first || center + distance <= last); ++distance) {
+      for (int64_t index : { center + distance, center - distance }) {
+        if (first <= index && index <= last && !chunkIndex.count(index)
+            && std::find(queue.begin(), queue.end(), index) == queue.end()) {
+          queue.push_back(index);
+        }
+      }
+    }
+    if (queue.empty()) {
+      return;
+    }
+  }
+  wake.notify_one();
+}
+
+void TerrainChunkCache::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this] { return queue.empty() && !generating; });
+}
+
+size_t TerrainChunkCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return chunks.size();
+}
+
+TerrainChunkCache::Statistics TerrainChunkCache::GetStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return statistics;
+}
+
+void TerrainChunkCache::Run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (stopping) {
+      return;
+    }
+    const int64_t index = queue.front();
+    queue.pop_front();
+    generating = true;
+
+    // Generate without holding the lock, so Find() doesn't wait for it
+    lock.unlock();
+    std::shared_ptr<const TerrainChunk> chunk = generator(index);
+    lock.lock();
+
+    generating = false;
+    if (!chunkIndex.count(index)) {
+      chunks.emplace_front(index, std::move(chunk));
+      chunkIndex[index] = chunks.begin();
+      ++statistics.generated;
+      while (chunks.size() > capacity) {
+        chunkIndex.erase(chunks.back().first);
+        chunks.pop_back();
+        ++statistics.evicted;
+      }
+    }
+    if (queue.empty()) {
+      idle.notify_all();
+    }
+  }
+}
+
+}
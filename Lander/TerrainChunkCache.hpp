@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Lander {
+
+/** The samples of a part of the terrain profile and a min/max tree over the segments between them (see Terrain)
+ */
+struct TerrainChunk {
+  /** The profile is the sum of a smooth function and the absolute value of another one (clamped at 0). Both are sampled separately
+   *  and the absolute value is taken after interpolating, so the kinks of the absolute value stay sharp.
+   */
+  struct Sample {
+    float smooth, smoothSlope;
+    float folded, foldedSlope; // the function, whose absolute value is added
+  };
+
+  float originX = 0;     // x of the first sample of the chunk's grid
+  size_t firstIndex = 0; // index of samples[0] in the chunk's grid (only chunks generated for a single query don't start at 0)
+  std::vector<Sample> samples;
+
+  // The min/max tree: an implicit binary tree (children of node i are 2i and 2i+1, the root is 1) over the segments between the samples,
+  // which holds the y of the highest (topY) and the lowest (bottomY) point of the surface above each node. Padded to a power of 2 with empty leaves.
+  size_t treeLeaves = 0;
+  std::vector<float> topY, bottomY;
+};
+
+/** Keeps the most recently used chunks of a streamed terrain and generates new chunks on a background thread.
+ *
+ *  Find() never waits: a chunk, which hasn't been generated yet, is simply missing and the caller has to calculate what it needs
+ *  itself. Prefetch() queues the chunks, which are about to be used. When more chunks than the capacity are cached, the least recently
+ *  used one is dropped, so the memory stays bounded no matter how far the terrain is explored. Chunks, which are still in use, stay alive
+ *  through their shared pointers.
+ */
+class TerrainChunkCache {
+public:
+  /** Generates the chunk with the given index. Called on the background thread, so it must only read state, which doesn't change while the cache exists.
+   */
+  using Generator = std::function<std::shared_ptr<const TerrainChunk>(int64_t index)>;
+
+  /** Starts the background thread
+   *
+   * @param capacity the maximum number of cached chunks
+   */
+  TerrainChunkCache(size_t capacity, Generator generator);
+
+  /** Stops the background thread (after the chunk it is currently generating)
+   */
+  ~TerrainChunkCache();
+
+  TerrainChunkCache(const TerrainChunkCache&) = delete;
+  TerrainChunkCache& operator=(const TerrainChunkCache&) = delete;
+
+  /** Returns the chunk with the given index and marks it as the most recently used one, or nullptr if it hasn't been generated yet.
+   */
+  std::shared_ptr<const TerrainChunk> Find(int64_t index);
+
+  /** Queues the chunks from first to last, which aren't cached yet, for the background thread (nearest to center first). Chunks, which
+   *  have been queued before and haven't been started yet, are dropped: only the latest request matters.
+   */
+  void Prefetch(int64_t first, int64_t last, int64_t center);
+
+  /** Waits until the background thread has generated all queued chunks
+   */
+  void WaitIdle();
+
+  /** The number of chunks, which are cached right now
+   */
+  size_t Size() const;
+
+  size_t Capacity() const { return capacity; }
+
+  struct Statistics {
+    uint64_t hits = 0;      // Find() calls, which returned a chunk
+    uint64_t misses = 0;    // Find() calls, which returned nullptr
+    uint64_t generated = 0; // chunks generated by the background thread
+    uint64_t evicted = 0;   // chunks dropped to stay within the capacity
+  };
+
+  Statistics GetStatistics() const;
+
+private:
+  void Run();
+
+  const size_t capacity;
+  const Generator generator;
+
+  mutable std::mutex mutex;
+  std::condition_variable wake; // signals new requests or the stop to the background thread
+  std::condition_variable idle; // signals that the queue has been worked off
+
+  using Entry = std::pair<int64_t, std::shared_ptr<const TerrainChunk>>;
+  std::list<Entry> chunks; // most recently used first
+  std::unordered_map<int64_t, std::list<Entry>::iterator> chunkIndex;
+  std::deque<int64_t> queue;
+  bool generating = false;
+  bool stopping = false;
+  Statistics statistics;
+
+  std::thread thread; // started last, after all members it uses have been constructed
+};
+
+}
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "TimeCounter.hpp"
+#include "World.hpp"
 #include <sstream>
 #include <iomanip>
 
@@ -13,13 +14,25 @@ namespace Lander {
 
   void TimeCounter::StartCount() {
     started = true;
-    startTime = std::chrono::high_resolution_clock::now();
+    startTick = world->GameTick();
   }
 
   void TimeCounter::StopCount() {
     started = false;
   }
 
+  void TimeCounter::StopCountAt(float ticks) {
+    if (started) {
+      // The current tick is still running, the world counts it after all objects have been updated
+      passedMilliSeconds = static_cast<int>((world->GameTick() - startTick + static_cast<double>(ticks)) * World::MILLIS_PER_TICK);
+      passedSeconds = passedMilliSeconds / 1000;
+      passedMilliSeconds %= 1000;
+      passedMinutes = passedSeconds / 60;
+      passedSeconds %= 60;
+    }
+    StopCount();
+  }
+
   void TimeCounter::ResetCount() {
     StopCount();
     passedMilliSeconds = 0;
@@ -27,6 +40,24 @@ namespace Lander {
     passedMinutes = 0;
   }
 
+  TimeCounter::Snapshot TimeCounter::TakeSnapshot() const {
+    int64_t elapsed = 0;
+    if (started) {
+      elapsed = static_cast<int64_t>(world->GameTick() - startTick) * World::MILLIS_PER_TICK * 1000000;
+    }
+    return { elapsed, passedMilliSeconds, passedSeconds, passedMinutes, started };
+  }
+
+  void TimeCounter::Restore(const Snapshot& snapshot) {
+    started = snapshot.started;
+    if (started) {
+      startTick = world->GameTick() - static_cast<int>(snapshot.elapsedNanoSeconds / (World::MILLIS_PER_TICK * 1000000));
+    }
+    passedMilliSeconds = snapshot.passedMilliSeconds;
+    passedSeconds = snapshot.passedSeconds;
+    passedMinutes = snapshot.passedMinutes;
+  }
+
   void TimeCounter::Initialize(Size _size) {
     windowSize = _size;
     pos = Vector::Right * (windowSize.width - size.width);
@@ -36,9 +67,7 @@ namespace Lander {
 
     if (started) {   
       // Calculate passed time
-      auto passedTime = startTime - std::chrono::high_resolution_clock::now();
-
-      passedMilliSeconds = -1 * static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(passedTime).count());
+      passedMilliSeconds = (world->GameTick() - startTick) * World::MILLIS_PER_TICK;
       passedSeconds = passedMilliSeconds / 1000;
       passedMilliSeconds %= 1000;
       passedMinutes = passedSeconds / 60;
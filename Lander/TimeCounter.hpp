@@ -1,8 +1,10 @@
 #pragma once
-#include <chrono>
 
 namespace Lander {
 
+  /** Shows the simulated time since StartCount(). The time is counted in game ticks, so it follows the game's clock
+   *  (e.g. a replay played at 2x counts twice as fast) and is the same in every run of a replay.
+   */
   class TimeCounter : public OverlayObject {
   public:
     TimeCounter();
@@ -11,6 +13,29 @@ namespace Lander {
     void StopCount();
     void ResetCount();
 
+    /** Stops the counter the given (fractional) number of ticks after the start of the current tick and shows the exact time until then
+     *  (e.g. the time of impact, see Collider::CheckCollisions(const Motion&)). It is a fraction of 1 unless the world runs several ticks at once.
+     */
+    void StopCountAt(float ticks);
+
+    /** The counter's state with the running time stored as elapsed time instead of the start tick
+     */
+    struct Snapshot {
+      int64_t elapsedNanoSeconds; // time since StartCount() if started
+      int32_t passedMilliSeconds;
+      int32_t passedSeconds;
+      int32_t passedMinutes;
+      bool started;
+
+      bool operator==(const Snapshot& other) const = default;
+    };
+
+    Snapshot TakeSnapshot() const;
+
+    /** Restores the displayed time. A running counter continues counting from the snapshot's elapsed time.
+     */
+    void Restore(const Snapshot& snapshot);
+
     virtual void Initialize(Size size) override;
 
     virtual void Draw(RenderInterface& renderInterface, const Rectangle& visibleRect, double secondsPassed) override;
@@ -23,7 +48,7 @@ namespace Lander {
     bool started = false;
     Size windowSize;
 
-    std::chrono::high_resolution_clock::time_point startTime;
+    int startTick = 0; // the world's game tick in StartCount()
     int passedMilliSeconds = 0;
     int passedSeconds = 0;
     int passedMinutes = 0;
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+
+namespace Lander {
+
+/** Passes values from one writer thread to one reader thread without locks. The writer fills the back buffer and publishes it,
+ *  the reader takes the most recently published buffer. Neither side ever waits for the other: the writer always has a buffer
+ *  to write into and the reader keeps its current buffer until a newer one has been published. Intermediate values, which have
+ *  been published before the reader got to them, are skipped.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+  /** Returns the buffer the writer fills before calling Publish()
+   */
+  T& Back() {
+    return buffers[back];
+  }
+
+  /** Makes the back buffer available to the reader and hands the writer a new back buffer
+   */
+  void Publish() {
+    back = middle.exchange(back | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  /** Takes the most recently published buffer as front buffer.
+   *
+   * @return false if nothing has been published since the last call (the front buffer stays the same)
+   */
+  bool Consume() {
+    if ((middle.load(std::memory_order_relaxed) & NEW_DATA) == 0) {
+      return false;
+    }
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /** Returns the buffer the reader took with the last successful Consume()
+   */
+  const T& Front() const {
+    return buffers[front];
+  }
+
+private:
+  static constexpr uint8_t INDEX_MASK = 0x03;
+  static constexpr uint8_t NEW_DATA = 0x04; // set in middle, if the middle buffer hasn't been consumed yet
+
+  T buffers[3] = {};
+
+  // Each side's index on its own cache line to not slow down the other side
+  alignas(64) uint8_t front = 0;
+  alignas(64) std::atomic<uint8_t> middle = 1;
+  alignas(64) uint8_t back = 2;
+};
+
+}
@@ -1,196 +1,85 @@
 #include "stdafx.h"
 
-namespace {
-  const float PI = 3.14159265359f;
-}
+#if defined(LANDER_SIMD_SSE2)
+#include <emmintrin.h>
+#elif defined(LANDER_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// No FMA contraction in this file, the batch functions must round like the scalar operations
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
 
 namespace Lander {
 
-const Vector Vector::Zero(0,0);
-const Vector Vector::Up(0,-1); // Viewport's vertical axis is reversed
-const Vector Vector::Down(0,1);
-const Vector Vector::Left(-1,0);
-const Vector Vector::Right(1,0);
-
-Vector::Vector() : x(0), y(0) {}
-Vector::Vector(float x, float y) : x(x), y(y) {}
-Vector::Vector(const Vector& other) : x(other.x), y(other.y) {}
-
-Vector Vector::Rotate(float angle) const {  // Rotate vector according to the angle
-
-  float radAngle = angle*PI / 180;
-  return Vector((x * cos(radAngle)) - (y * sin(radAngle)),
-                (x * sin(radAngle)) + (y * cos(radAngle)));
-}
-
-Vector Vector::Rotate(float angle, Vector rotationPoint) const {
-  return (*this - rotationPoint).Rotate(angle) + rotationPoint;
-}
-
-Vector Vector::Rotate90CW() const {
-  return Vector(-y, x);
-}
-
-Vector Vector::Rotate90CCW() const {
-  return Vector(y, -x);
-}
-
-Vector Vector::Rotate180() const {
-  return Vector(-x, -y);
-}
-
-
-float Vector::AngleBetween(Vector other) const {
-  return acosf(*this * other / (Length() * other.Length())) / PI * 180;
-}
-
-
-float Vector::AngleTo(Vector other) const {
-  // We project other onto this vector rotate 90 clockwise and check wether
-  // the scalar product is positive or negative to determine whether other is right or
-  // left of this vector and thus whether to return a positive or negative angle
-  return ((Rotate90CW() * other > 0) ? 1 : -1) * AngleBetween(other);
-}
-
-
-Vector& Vector::operator=(const Vector& other) {
-  x = other.x;
-  y = other.y;
-  return *this;
-}
-
-Vector& Vector::operator+=(const Vector& other) {
-  x += other.x;
-  y += other.y;
-  return *this;
-}
-
-Vector& Vector::operator-=(const Vector& other) {
-  x -= other.x;
-  y -= other.y;
-  return *this;
-}
-
-Vector& Vector::operator*=(float factor) {
-  x *= factor;
-  y *= factor;
-  return *this;
-}
-
-Vector& Vector::operator/=(float divisor) {
-  return *this *= (1 / divisor);
-}
-
-Vector Vector::operator+(const Vector& other) const {
-  return Vector(x+other.x, y+other.y);
-}
-  
-Vector Vector::operator-(const Vector& other) const {
-  return Vector(x-other.x, y-other.y);
-}
-  
-Vector Vector::operator*(float factor) const {
-  return Vector(x*factor, y*factor);
-}
-
-Vector Vector::operator/(float divisor) const {
-  return *this * (1/divisor);
-}
-
-float Vector::operator*(const Vector& other) const {
-  return x * other.x + y * other.y;
-}
-
-float Vector::Length() const {
-  return sqrt(x*x + y*y);
-}
-
-Vector operator*(float factor, const Vector& v) {
-  return v * factor;
-}
-
-Vector::operator D2D1_POINT_2F() const {
-  return D2D1::Point2F(x,y);
-}
-
-Vector Vector::FromSize(const Size& size) {
-  return Vector(size.width, size.height);
-}
-
-Size::Size() : width(0), height(0) {}
-Size::Size(float width, float height) : width(width), height(height) {}
-Size::Size(const Size& other) : width(other.width), height(other.height) {}
-Size::Size(const D2D1_SIZE_F& other) : width(other.width), height(other.height) {}
-
-Size Size::Abs() const {
-  return Size(abs(width), abs(height));
-}
-
-Rectangle::Rectangle() {}
-Rectangle::Rectangle(Vector topLeft, Vector bottomRight) : topLeft(topLeft), bottomRight(bottomRight) {}
-Rectangle::Rectangle(Vector topLeft, vec::Size size) : topLeft(topLeft), bottomRight((Vector::Right * size.width) + (Vector::Down * size.height) + topLeft) {}
-Rectangle::Rectangle(const RECT& rc) : topLeft(static_cast<float>(rc.left), static_cast<float>(rc.top)), bottomRight(static_cast<float>(rc.right),static_cast<float>(rc.bottom)) {}
-Rectangle::Rectangle(const Rectangle& other) : topLeft(other.topLeft), bottomRight(other.bottomRight) {}
-
-
-Rectangle::operator D2D1_RECT_F() const {
-  return D2D1::RectF(topLeft.x, topLeft.y, bottomRight.x, bottomRight.y);
-}
-
-Size Rectangle::Size() const {
-  return vec::Size(bottomRight.x - topLeft.x, bottomRight.y - topLeft.y);
-}
-
-Vector Rectangle::TopRight() const {
-  return Vector(bottomRight.x, topLeft.y);
-}
-
-Vector Rectangle::BottomLeft() const {
-  return Vector(topLeft.x, bottomRight.y);
-}
-
-Vector Rectangle::Center() const {
-  return Vector((bottomRight.x + topLeft.x) / 2, (topLeft.y + bottomRight.y) / 2);
-}
-
-Vector Rectangle::TopCenter() const {
-  return Vector(Center().x, topLeft.y);
-}
-
-
-
-Vector Rectangle::RightCenter() const {
-  return Vector(bottomRight.x, Center().y);
-}
- 
-Vector Rectangle::BottomCenter() const {
-  return Vector(Center().x, bottomRight.y);
-}
-  
-Vector Rectangle::LeftCenter() const {
-  return Vector(topLeft.x, Center().y);
-}
-
-void Rectangle::operator+=(Vector offset) {
-  topLeft += offset;
-  bottomRight += offset;
-}
-
-bool Rectangle::Contains(Vector pos) const {
-  // Our check is based on the following assumption about the coordinate system
-  assert(Vector::Up.y == -1 && Vector::Right.x == 1);
-  return pos.x >= topLeft.x && pos.x <= bottomRight.x && pos.y >= topLeft.y && pos.y <= bottomRight.y;
-}
+namespace {
 
-bool Rectangle::Contains(const Rectangle& other) const {
-  return Contains(other.topLeft) && Contains(other.bottomRight) && Contains(other.TopRight()) && Contains(other.BottomLeft());
+/** Applies the matrix (m11 m12 / m21 m22) and the offset (dx, dy) to count points. Two points are processed at once
+ *  as [x0, y0, x1, y1]: (xs * [m11, m21, m11, m21] + ys * [m12, m22, m12, m22]) + [dx, dy, dx, dy]
+ *  which are the same operations in the same order as Transform::operator(). Without Translate, the offset isn't added
+ *  at all (adding 0 would turn -0 into +0).
+ */
+template <bool Translate>
+void ApplyMatrix(float m11, float m12, float m21, float m22, float dx, float dy, const Vector* in, Vector* out, size_t count) {
+  size_t i = 0;
+#if defined(LANDER_SIMD_SSE2)
+  const __m128 xFactors = _mm_setr_ps(m11, m21, m11, m21);
+  const __m128 yFactors = _mm_setr_ps(m12, m22, m12, m22);
+  const __m128 offset = _mm_setr_ps(dx, dy, dx, dy);
+  for (; i + 2 <= count; i += 2) {
+    __m128 points = _mm_loadu_ps(&in[i].x);
+    __m128 xs = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 ys = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 result = _mm_add_ps(_mm_mul_ps(xs, xFactors), _mm_mul_ps(ys, yFactors));
+    if (Translate) {
+      result = _mm_add_ps(result, offset);
+    }
+    _mm_storeu_ps(&out[i].x, result);
+  }
+#elif defined(LANDER_SIMD_NEON)
+  const float xFactorValues[4] = { m11, m21, m11, m21 };
+  const float yFactorValues[4] = { m12, m22, m12, m22 };
+  const float offsetValues[4] = { dx, dy, dx, dy };
+  const float32x4_t xFactors = vld1q_f32(xFactorValues);
+  const float32x4_t yFactors = vld1q_f32(yFactorValues);
+  const float32x4_t offset = vld1q_f32(offsetValues);
+  for (; i + 2 <= count; i += 2) {
+    float32x4_t points = vld1q_f32(&in[i].x);
+    float32x4_t xs = vtrn1q_f32(points, points);
+    float32x4_t ys = vtrn2q_f32(points, points);
+    // Separate multiplications and additions (vmlaq/vfmaq would round differently)
+    float32x4_t result = vaddq_f32(vmulq_f32(xs, xFactors), vmulq_f32(ys, yFactors));
+    if (Translate) {
+      result = vaddq_f32(result, offset);
+    }
+    vst1q_f32(&out[i].x, result);
+  }
+#endif
+  for (; i < count; i++) {
+    Vector point = in[i];
+    Vector result(m11 * point.x + m12 * point.y, m21 * point.x + m22 * point.y);
+    if (Translate) {
+      result += Vector(dx, dy);
+    }
+    out[i] = result;
+  }
+}
+
+}
+
+void RotatePoints(float angle, const Vector* in, Vector* out, size_t count) {
+  // Same sine and cosine as Vector::Rotate(), (x*cos) - (y*sin) is computed as (x*cos) + (y*-sin), which is exact
+  float radAngle = angle*Vector::PI / 180;
+  float cosAngle = SimulationMath::Cos(radAngle);
+  float sinAngle = SimulationMath::Sin(radAngle);
+  ApplyMatrix<false>(cosAngle, -sinAngle, sinAngle, cosAngle, 0, 0, in, out, count);
+}
+
+void TransformPoints(const Transform& transform, const Vector* in, Vector* out, size_t count) {
+  ApplyMatrix<true>(transform.m11, transform.m12, transform.m21, transform.m22, transform.dx, transform.dy, in, out, count);
 }
 
-bool Rectangle::Intersects(const Rectangle& other) const {
-  return Contains(other.topLeft)
-      || Contains(other.bottomRight)
-      || Contains(other.TopRight())
-      || Contains(other.BottomLeft());
 }
-
-}
\ No newline at end of file
@@ -1,17 +1,30 @@
 #pragma once
- 
+
+#include "DeterministicMath.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// The batch functions use SSE2 or NEON if available (define LANDER_NO_SIMD to always use the scalar loops)
+#if !defined(LANDER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LANDER_SIMD_SSE2
+#elif !defined(LANDER_NO_SIMD) && ((defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64))
+#define LANDER_SIMD_NEON
+#endif
+
 namespace Lander {
 
 class Size;
 class Rectangle;
 
-/** This class represents a 2D Float vector
+/** This class represents a 2D Float vector. All operations are inline (and constexpr where possible),
+ *  so the compiler can inline and vectorize them on the physics and collision paths.
  */
 class Vector {
 public:
-  Vector(); // (0,0)
-  Vector(float x, float y); //A vector (x, y)
-  Vector(const Vector& other);
+  constexpr Vector() : x(0), y(0) {} // (0,0)
+  constexpr Vector(float x, float y) : x(x), y(y) {} //A vector (x, y)
 
   /** Rotates the vector around (0,0) with the given angle (in degrees)
    *  positive angles correspond to a clockwise rotation
@@ -22,17 +35,17 @@ public:
    */
   Vector Rotate(float angle, Vector rotationPoint) const;
 
-  /** Rotates the vector by 90 clockwise 
+  /** Rotates the vector by 90 clockwise
    */
-  Vector Rotate90CW() const;
+  constexpr Vector Rotate90CW() const;
 
   /** Rotates the vector by 90 counter clockwise
    */
-  Vector Rotate90CCW() const;
+  constexpr Vector Rotate90CCW() const;
 
   /** Rotates the vector by 180
    */
-  Vector Rotate180() const;
+  constexpr Vector Rotate180() const;
 
   /** Returns the smallest angle (in degrees) between the two vectors, which will always be positive
    *  None of them must be the Zero vector
@@ -44,21 +57,19 @@ public:
    */
   float AngleTo(Vector other) const;
 
-  Vector& operator=(const Vector& other);
-
   // Mathematical operations
-  Vector& operator+=(const Vector& other);
-  Vector& operator-=(const Vector& other);
-  Vector& operator*=(float factor);
-  Vector& operator/=(float divisor);
+  constexpr Vector& operator+=(const Vector& other);
+  constexpr Vector& operator-=(const Vector& other);
+  constexpr Vector& operator*=(float factor);
+  constexpr Vector& operator/=(float divisor);
 
-  Vector operator+(const Vector& other) const;
-  Vector operator-(const Vector& other) const;
-  Vector operator*(float factor) const;
-  Vector operator/(float divisor) const;
+  constexpr Vector operator+(const Vector& other) const;
+  constexpr Vector operator-(const Vector& other) const;
+  constexpr Vector operator*(float factor) const;
+  constexpr Vector operator/(float divisor) const;
 
   /** Scalar product */
-  float operator*(const Vector& other) const;
+  constexpr float operator*(const Vector& other) const;
 
 
   // Vector length
@@ -66,11 +77,13 @@ public:
 
   float x, y;
 
+#ifdef _WIN32
   // Implicit conversion to a Direct2D point
   operator D2D1_POINT_2F() const;
+#endif
 
-  // Conversion from a size 
-  static Vector FromSize(const Size& size);
+  // Conversion from a size
+  static constexpr Vector FromSize(const Size& size);
 
   //Constant vectors
   static const Vector Zero;
@@ -78,9 +91,12 @@ public:
   static const Vector Down;
   static const Vector Left;
   static const Vector Right;
+
+  // The value of pi used for all conversions between degrees and radians
+  static constexpr float PI = 3.14159265359f;
 };
 
-Vector operator*(float factor, const Vector& v);
+constexpr Vector operator*(float factor, const Vector& v);
 
 /** A size class to represent sizes. We could use a vector for this too, but it would be a bit confusing, because
  *  when describing a rectangle with two vectors it would be unclear, whether it the second vector is the bottom right position
@@ -88,10 +104,11 @@ Vector operator*(float factor, const Vector& v);
  */
 class Size {
 public:
-  Size(); //width=0, height=0
-  Size(float width, float height);
-  Size(const Size& other);
-  Size(const D2D1_SIZE_F& other); //conversion from Direct2D type
+  constexpr Size() : width(0), height(0) {} //width=0, height=0
+  constexpr Size(float width, float height) : width(width), height(height) {}
+#ifdef _WIN32
+  Size(const D2D1_SIZE_F& other) : width(other.width), height(other.height) {} //conversion from Direct2D type
+#endif
 
   /** Returns a size with absolute values (no negative ones)
    */
@@ -104,49 +121,347 @@ public:
  */
 class Rectangle {
 public:
-  Rectangle(); //(0,0) - (0,0)
-  Rectangle(Vector topLeft, Vector bottomRight);
-  Rectangle(Vector topLeft, Size size);
+  constexpr Rectangle() {} //(0,0) - (0,0)
+  constexpr Rectangle(Vector topLeft, Vector bottomRight) : topLeft(topLeft), bottomRight(bottomRight) {}
+  constexpr Rectangle(Vector topLeft, Size size);
+#ifdef _WIN32
   Rectangle(const RECT& winRect);
-  Rectangle(const Rectangle& other);
+#endif
 
-  /** Implicit conversion to Direct2D type 
+#ifdef _WIN32
+  /** Implicit conversion to Direct2D type
    */
   operator D2D1_RECT_F() const;
+#endif
 
   /** Returns the width&height of the rectangle
    */
-  Size Size() const;
+  constexpr Lander::Size Size() const;
 
-  Vector TopRight() const;
-  Vector BottomLeft() const;
-  Vector Center() const;
+  constexpr Vector TopRight() const;
+  constexpr Vector BottomLeft() const;
+  constexpr Vector Center() const;
 
-  Vector TopCenter() const;
-  Vector RightCenter() const;
-  Vector BottomCenter() const;
-  Vector LeftCenter() const;
+  constexpr Vector TopCenter() const;
+  constexpr Vector RightCenter() const;
+  constexpr Vector BottomCenter() const;
+  constexpr Vector LeftCenter() const;
 
   /** Moves the whole rectangle by the specified vector offset
    */
-  void operator+=(Vector offset);
+  constexpr void operator+=(Vector offset);
 
   /** True if the specified position is inside this rectangle
    */
-  bool Contains(Vector pos) const;
+  constexpr bool Contains(Vector pos) const;
   /** True if this rectangle contains all corner points of the given rectangle
    */
-  bool Contains(const Rectangle& other) const;
-  bool Intersects(const Rectangle& other) const;
-  
+  constexpr bool Contains(const Rectangle& other) const;
+  constexpr bool Intersects(const Rectangle& other) const;
+
 
   Vector topLeft, bottomRight;
 };
 
+/** An affine 2D transformation as 2x3 matrix, which maps (x, y) to (m11*x + m12*y + dx, m21*x + m22*y + dy)
+ */
+class Transform {
+public:
+  constexpr Transform() : m11(1), m12(0), m21(0), m22(1), dx(0), dy(0) {} // identity
+
+  /** Returns the transformation of a view object with the given top left position, rotation (degrees, clockwise around
+   *  the object's center) and size from object coordinates into world coordinates (see ViewObject::ObjectToWorld())
+   */
+  static Transform ObjectToWorld(Vector pos, float rotation, Lander::Size size);
+
+  /** Returns the translation by the given offset
+   */
+  static constexpr Transform Translation(Vector offset);
+
+  /** Returns the clockwise rotation by the given angle (degrees) around the given point
+   */
+  static Transform Rotation(float angle, Vector center);
+
+  /** Returns the inverse transformation (only valid for rotations and translations)
+   */
+  constexpr Transform InverseRigid() const;
+
+  /** Applies the transformation to the given point
+   */
+  constexpr Vector operator()(Vector point) const;
+
+#ifdef _WIN32
+  // Implicit conversion to a Direct2D matrix (which multiplies row vectors)
+  operator D2D1::Matrix3x2F() const;
+#endif
+
+  float m11, m12, m21, m22;
+  float dx, dy;
+};
+
+/** Concatenates two transformations: (a * b)(v) == a(b(v))
+ */
+constexpr Transform operator*(const Transform& a, const Transform& b);
+
   //Namespace with typedefs to resolve namespace conflicts by writing vec::Size instead of Size
   namespace vec {
     typedef Lander::Vector Vector;
     typedef Lander::Size Size;
     typedef Lander::Rectangle Rectangle;
+    typedef Lander::Transform Transform;
   }
-}
\ No newline at end of file
+
+// The types are copied around by value everywhere, so they must stay plain data
+static_assert(std::is_trivially_copyable_v<Vector> && std::is_trivially_copyable_v<Size>
+           && std::is_trivially_copyable_v<Rectangle> && std::is_trivially_copyable_v<Transform>, "math types must be trivially copyable");
+
+
+/** Rotates count points around (0,0) by the given angle (degrees, clockwise). The results are bit-identical to
+ *  calling Vector::Rotate(angle) on each point, but the sine and cosine are only calculated once.
+ *  in and out may be the same array.
+ */
+void RotatePoints(float angle, const Vector* in, Vector* out, size_t count);
+
+/** Applies the transformation to count points. The results are bit-identical to calling transform(point) on each point.
+ *  in and out may be the same array.
+ */
+void TransformPoints(const Transform& transform, const Vector* in, Vector* out, size_t count);
+
+
+// Implementation
+
+inline constexpr Vector Vector::Zero(0,0);
+inline constexpr Vector Vector::Up(0,-1); // Viewport's vertical axis is reversed
+inline constexpr Vector Vector::Down(0,1);
+inline constexpr Vector Vector::Left(-1,0);
+inline constexpr Vector Vector::Right(1,0);
+
+inline Vector Vector::Rotate(float angle) const {  // Rotate vector according to the angle
+  float radAngle = angle*PI / 180;
+  float cosAngle = SimulationMath::Cos(radAngle);
+  float sinAngle = SimulationMath::Sin(radAngle);
+  return Vector((x * cosAngle) - (y * sinAngle),
+                (x * sinAngle) + (y * cosAngle));
+}
+
+inline Vector Vector::Rotate(float angle, Vector rotationPoint) const {
+  return (*this - rotationPoint).Rotate(angle) + rotationPoint;
+}
+
+constexpr Vector Vector::Rotate90CW() const {
+  return Vector(-y, x);
+}
+
+constexpr Vector Vector::Rotate90CCW() const {
+  return Vector(y, -x);
+}
+
+constexpr Vector Vector::Rotate180() const {
+  return Vector(-x, -y);
+}
+
+inline float Vector::AngleBetween(Vector other) const {
+  return SimulationMath::Acos(*this * other / (Length() * other.Length())) / PI * 180;
+}
+
+inline float Vector::AngleTo(Vector other) const {
+  // We project other onto this vector rotate 90 clockwise and check wether
+  // the scalar product is positive or negative to determine whether other is right or
+  // left of this vector and thus whether to return a positive or negative angle
+  return ((Rotate90CW() * other > 0) ? 1 : -1) * AngleBetween(other);
+}
+
+constexpr Vector& Vector::operator+=(const Vector& other) {
+  x += other.x;
+  y += other.y;
+  return *this;
+}
+
+constexpr Vector& Vector::operator-=(const Vector& other) {
+  x -= other.x;
+  y -= other.y;
+  return *this;
+}
+
+constexpr Vector& Vector::operator*=(float factor) {
+  x *= factor;
+  y *= factor;
+  return *this;
+}
+
+constexpr Vector& Vector::operator/=(float divisor) {
+  return *this *= (1 / divisor);
+}
+
+constexpr Vector Vector::operator+(const Vector& other) const {
+  return Vector(x+other.x, y+other.y);
+}
+
+constexpr Vector Vector::operator-(const Vector& other) const {
+  return Vector(x-other.x, y-other.y);
+}
+
+constexpr Vector Vector::operator*(float factor) const {
+  return Vector(x*factor, y*factor);
+}
+
+constexpr Vector Vector::operator/(float divisor) const {
+  return *this * (1/divisor);
+}
+
+constexpr float Vector::operator*(const Vector& other) const {
+  return x * other.x + y * other.y;
+}
+
+inline float Vector::Length() const {
+  return std::sqrt(x*x + y*y); // correctly rounded on every platform
+}
+
+constexpr Vector operator*(float factor, const Vector& v) {
+  return v * factor;
+}
+
+#ifdef _WIN32
+inline Vector::operator D2D1_POINT_2F() const {
+  return D2D1::Point2F(x,y);
+}
+#endif
+
+constexpr Vector Vector::FromSize(const Size& size) {
+  return Vector(size.width, size.height);
+}
+
+
+inline Size Size::Abs() const {
+  return Size(std::abs(width), std::abs(height));
+}
+
+
+constexpr Rectangle::Rectangle(Vector topLeft, vec::Size size) : topLeft(topLeft), bottomRight((Vector::Right * size.width) + (Vector::Down * size.height) + topLeft) {}
+#ifdef _WIN32
+inline Rectangle::Rectangle(const RECT& rc) : topLeft(static_cast<float>(rc.left), static_cast<float>(rc.top)), bottomRight(static_cast<float>(rc.right),static_cast<float>(rc.bottom)) {}
+
+inline Rectangle::operator D2D1_RECT_F() const {
+  return D2D1::RectF(topLeft.x, topLeft.y, bottomRight.x, bottomRight.y);
+}
+#endif
+
+constexpr Size Rectangle::Size() const {
+  return vec::Size(bottomRight.x - topLeft.x, bottomRight.y - topLeft.y);
+}
+
+constexpr Vector Rectangle::TopRight() const {
+  return Vector(bottomRight.x, topLeft.y);
+}
+
+constexpr Vector Rectangle::BottomLeft() const {
+  return Vector(topLeft.x, bottomRight.y);
+}
+
+constexpr Vector Rectangle::Center() const {
+  return Vector((bottomRight.x + topLeft.x) / 2, (topLeft.y + bottomRight.y) / 2);
+}
+
+constexpr Vector Rectangle::TopCenter() const {
+  return Vector(Center().x, topLeft.y);
+}
+
+constexpr Vector Rectangle::RightCenter() const {
+  return Vector(bottomRight.x, Center().y);
+}
+
+constexpr Vector Rectangle::BottomCenter() const {
+  return Vector(Center().x, bottomRight.y);
+}
+
+constexpr Vector Rectangle::LeftCenter() const {
+  return Vector(topLeft.x, Center().y);
+}
+
+constexpr void Rectangle::operator+=(Vector offset) {
+  topLeft += offset;
+  bottomRight += offset;
+}
+
+constexpr bool Rectangle::Contains(Vector pos) const {
+  // Our check is based on the following assumption about the coordinate system
+  static_assert(Vector::Up.y == -1 && Vector::Right.x == 1);
+  return pos.x >= topLeft.x && pos.x <= bottomRight.x && pos.y >= topLeft.y && pos.y <= bottomRight.y;
+}
+
+constexpr bool Rectangle::Contains(const Rectangle& other) const {
+  return Contains(other.topLeft) && Contains(other.bottomRight) && Contains(other.TopRight()) && Contains(other.BottomLeft());
+}
+
+constexpr bool Rectangle::Intersects(const Rectangle& other) const {
+  return Contains(other.topLeft)
+      || Contains(other.bottomRight)
+      || Contains(other.TopRight())
+      || Contains(other.BottomLeft());
+}
+
+
+inline Transform Transform::ObjectToWorld(Vector pos, float rotation, Lander::Size size) {
+  // Rotate around the center and move to pos: R * (v - center) + center + pos
+  Vector center(size.width/2, size.height/2);
+  return Translation(pos) * Rotation(rotation, center);
+}
+
+constexpr Transform Transform::Translation(Vector offset) {
+  Transform translation;
+  translation.dx = offset.x;
+  translation.dy = offset.y;
+  return translation;
+}
+
+inline Transform Transform::Rotation(float angle, Vector center) {
+  // Same rotation as Vector::Rotate(): the only place, where a transformation calculates the sine and cosine
+  float radAngle = angle*Vector::PI / 180;
+  float cosAngle = SimulationMath::Cos(radAngle);
+  float sinAngle = SimulationMath::Sin(radAngle);
+
+  Transform rotation;
+  rotation.m11 = cosAngle;
+  rotation.m12 = -sinAngle;
+  rotation.m21 = sinAngle;
+  rotation.m22 = cosAngle;
+  rotation.dx = center.x - (cosAngle * center.x - sinAngle * center.y);
+  rotation.dy = center.y - (sinAngle * center.x + cosAngle * center.y);
+  return rotation;
+}
+
+constexpr Transform Transform::InverseRigid() const {
+  // The inverse of a rotation is its transposed matrix, the translation is rotated back and negated
+  Transform inverse;
+  inverse.m11 = m11;
+  inverse.m12 = m21;
+  inverse.m21 = m12;
+  inverse.m22 = m22;
+  inverse.dx = -(m11 * dx + m21 * dy);
+  inverse.dy = -(m12 * dx + m22 * dy);
+  return inverse;
+}
+
+constexpr Vector Transform::operator()(Vector point) const {
+  return Vector(m11 * point.x + m12 * point.y + dx,
+                m21 * point.x + m22 * point.y + dy);
+}
+
+constexpr Transform operator*(const Transform& a, const Transform& b) {
+  Transform product;
+  product.m11 = a.m11 * b.m11 + a.m12 * b.m21;
+  product.m12 = a.m11 * b.m12 + a.m12 * b.m22;
+  product.m21 = a.m21 * b.m11 + a.m22 * b.m21;
+  product.m22 = a.m21 * b.m12 + a.m22 * b.m22;
+  product.dx = a.m11 * b.dx + a.m12 * b.dy + a.dx;
+  product.dy = a.m21 * b.dx + a.m22 * b.dy + a.dy;
+  return product;
+}
+
+#ifdef _WIN32
+inline Transform::operator D2D1::Matrix3x2F() const {
+  return D2D1::Matrix3x2F(m11, m21, m12, m22, dx, dy);
+}
+#endif
+
+}
@@ -5,13 +5,36 @@ namespace Lander {
 
 Vector ViewObject::WorldToObject(Vector worldVector) const {
   // We have to first subtract the object's offset and then rotate back around it's center
-  return (worldVector - pos).Rotate(-rotation, Center());
+  return WorldToObjectTransform()(worldVector);
 }
 
   
 Vector ViewObject::ObjectToWorld(Vector objectVector) const {
   // We have to apply the object's rotation around the center to the given vector and then add the object's offset
-  return objectVector.Rotate(rotation, Center()) + pos;
+  return ObjectToWorldTransform()(objectVector);
+}
+
+const Transform& ViewObject::ObjectToWorldTransform() const {
+  UpdateTransforms();
+  return objectToWorld;
+}
+
+const Transform& ViewObject::WorldToObjectTransform() const {
+  UpdateTransforms();
+  return worldToObject;
+}
+
+void ViewObject::UpdateTransforms() const {
+  if (pos.x == transformPos.x && pos.y == transformPos.y && rotation == transformRotation
+      && size.width == transformSize.width && size.height == transformSize.height) {
+    return;
+  }
+
+  objectToWorld = Transform::ObjectToWorld(pos, rotation, size);
+  worldToObject = objectToWorld.InverseRigid();
+  transformPos = pos;
+  transformRotation = rotation;
+  transformSize = size;
 }
 
 Vector ViewObject::Center() const {
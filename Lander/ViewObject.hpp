@@ -4,10 +4,12 @@ namespace Lander {
 
 class RenderInterface;
 class Camera;
+class World;
 
 /** Each object, which wants to be drawn must be derived from this class
  */
 class ViewObject {
+  friend class World;
 public:
   /** Gets called once on each view object before the object gets drawn and after the game has initialized to 
    *  initialize the view object's resources.
@@ -60,6 +62,16 @@ public:
    */
   Vector ObjectToWorld(Vector objectVector) const;
 
+  /** Returns the transformation used by ObjectToWorld(). It is cached and only recalculated after pos, rotation or size changed,
+   *  so transforming many points only calculates the rotation's sine and cosine once. The reference stays valid until the
+   *  next change of the object.
+   */
+  const Transform& ObjectToWorldTransform() const;
+
+  /** Returns the transformation used by WorldToObject() (cached like ObjectToWorldTransform())
+   */
+  const Transform& WorldToObjectTransform() const;
+
   /** Returns the object's center position in object coordinates, relative to the top left corner.
    *  To get center in world coordinates, simply add pos to it.
    */
@@ -71,6 +83,17 @@ public:
    */
   virtual Vector GetScreenPosition(const Camera& camera) const;
 
+  /** Returns the position to draw the object at, when the given fraction of the next physics tick has passed.
+   *  Objects, which move in each tick, blend between their last two positions to move smoothly at any frame rate.
+   *
+   * @param tickProgress the passed fraction of the current tick (0-1)
+   */
+  virtual Vector InterpolatedPos(float tickProgress) const { return pos; }
+
+  /** Returns the rotation to draw the object with (see InterpolatedPos())
+   */
+  virtual float InterpolatedRotation(float tickProgress) const { return rotation; }
+
 
 
   /** This function gets called upon the game's destruction. Dynamically allocated ViewObjects
@@ -87,6 +110,23 @@ public:
 
   bool enabled = true; //if set to false, the Update() and Draw() functions won't be called anymore. Drawn with a red bounding box
   bool visible = true; //if set to false the Draw() function won't be called anymore. Drawn with a magenta bounding box
+
+private:
+  /** Recalculates the cached transformations if pos, rotation or size changed since they have been calculated
+   */
+  void UpdateTransforms() const;
+
+  // Cached transformations and the state they have been calculated for (not thread-safe, like the rest of the object)
+  mutable Transform objectToWorld, worldToObject;
+  mutable Vector transformPos;
+  mutable Size transformSize;
+  mutable float transformRotation = std::numeric_limits<float>::quiet_NaN(); // never equal -> calculated upon first use
+
+protected:
+  /** The world this object has been added to (set in World::AddObject()). Objects must use this world instead of a global
+   *  instance to look up the input and other objects, because several worlds may be simulated in parallel.
+   */
+  World* world = nullptr;
 };
 
 }
\ No newline at end of file
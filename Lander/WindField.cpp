@@ -0,0 +1,61 @@
+#include "stdafx.h"
+#include "WindField.hpp"
+#include "World.hpp"
+
+namespace Lander {
+
+namespace {
+
+// SplitMix64 finalizer
+uint64_t Mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// A pseudo random number in [-1, 1), which only depends on its arguments
+float Random(uint32_t seed, uint64_t index) {
+  return static_cast<float>(Mix(Mix(seed) + index) >> 40) * (2.0f / 16777216.0f) - 1;
+}
+
+const float DENSITY_STEP = 0.917004043f; // 2^(-1/DENSITY_HALVING_ROWS), the density ratio of two neighbouring rows
+
+}
+
+
+void WindField::Generate(uint32_t seed, float groundY) {
+  this->seed = seed;
+  this->groundY = groundY;
+  drift = 0;
+  maxSpeed = 0;
+  if (seed == 0) {
+    nodes.fill({});
+    return;
+  }
+
+  // The mean wind blows in the same direction at all altitudes and grows with the square root of the altitude
+  const float meanWind = MAX_MEAN_WIND * Random(seed, 0);
+  float density = GROUND_DENSITY;
+  for (int row = 0; row < ROWS; ++row) {
+    const float rowWind = meanWind * std::sqrt(static_cast<float>(row) / (ROWS - 1));
+    for (int column = 0; column < COLUMNS; ++column) {
+      const uint64_t index = 1 + 2 * static_cast<uint64_t>(row * COLUMNS + column);
+      Node& node = nodes[row * COLUMNS + column];
+      node.windX = rowWind + MAX_GUST * Random(seed, index);
+      node.windY = MAX_GUST / 3 * Random(seed, index + 1);
+      node.density = density;
+      maxSpeed = std::max(maxSpeed, Vector(node.windX, node.windY).Length());
+    }
+    density *= DENSITY_STEP;
+  }
+
+  // The gusts drift with the mean wind halfway up the grid
+  drift = static_cast<float>(meanWind * std::sqrt(0.5f) * PhysicsObject::PIXEL_PER_METER * World::SECONDS_PER_TICK / CELL_SIZE);
+}
+
+float WindField::Offset(int gameTick) const {
+  const double cells = gameTick * static_cast<double>(drift);
+  return static_cast<float>(cells - COLUMNS * std::floor(cells * (1.0 / COLUMNS)));
+}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+
+namespace Lander {
+
+/** The wind and the density of the air above a level, which cause the drag of flying objects (see PhysicsObject::ApplyDrag()).
+ *
+ *  The field is generated once from its seed into a small grid of nodes (CELL_SIZE px apart), which covers COLUMNS cells horizontally
+ *  and repeats beyond them, and ROWS rows of altitudes above the ground. Each node holds the wind of its row, which gets stronger with
+ *  the altitude, plus a random gust, and the air density, which halves every DENSITY_HALVING_ROWS rows. At() interpolates the four
+ *  nodes around a position bilinearly, which costs a handful of multiplications, so it can be sampled for every object on every tick.
+ *  The gusts drift with the wind: the grid moves horizontally with the game tick (see Offset()).
+ *
+ *  The generation only uses additions, multiplications and square roots, so the field is bit-identical on every platform.
+ *  The seed 0 is a level without atmosphere (no wind and no drag).
+ */
+class WindField {
+public:
+  static constexpr int COLUMNS = 32; // must be a power of 2 (see At())
+  static constexpr int ROWS = 16;
+  static constexpr float CELL_SIZE = 64;           // px between two nodes
+  static constexpr int DENSITY_HALVING_ROWS = 8;   // 512 px (256 m)
+
+  static constexpr float GROUND_DENSITY = 1.225f;  // kg/m³
+  static constexpr float MAX_MEAN_WIND = 15;       // m/s at the top row
+  static constexpr float MAX_GUST = 6;             // m/s horizontally (a third of it vertically)
+
+  /** The wind (m/s) and the air density (kg/m³) at a position
+   */
+  struct Sample {
+    Vector wind;
+    float density;
+  };
+
+  /** Generates the field for the given seed (0 for no atmosphere) with the ground (altitude 0) at the given y (px).
+   *  Doesn't allocate.
+   */
+  void Generate(uint32_t seed, float groundY);
+
+  uint32_t Seed() const { return seed; }
+
+  /** Returns true for a level without atmosphere (seed 0)
+   */
+  bool IsCalm() const { return seed == 0; }
+
+  float GroundY() const { return groundY; }
+
+  /** Returns the highest wind speed (m/s) of all nodes
+   */
+  float MaxSpeed() const { return maxSpeed; }
+
+  /** Returns how many cells (0 to COLUMNS) the drifting gusts have moved at the given game tick (see World::GameTick())
+   */
+  float Offset(int gameTick) const;
+
+  /** Returns the wind and the air density at the given position (px, |x| < 2^31 * CELL_SIZE) for the given Offset(). Above the top row
+   *  and below the ground, the field stays the same as at the top row or the ground.
+   */
+  Sample At(float x, float y, float offset) const;
+
+private:
+  struct Node {
+    float windX, windY;
+    float density;
+  };
+
+  uint32_t seed = 0;
+  float groundY = 0;
+  float drift = 0;    // cells per tick
+  float maxSpeed = 0;
+  std::array<Node, ROWS * COLUMNS> nodes = {}; // rows from the ground up
+};
+
+
+inline WindField::Sample WindField::At(float x, float y, float offset) const {
+  const float u = x * (1 / CELL_SIZE) - offset;
+  const float v = std::min(std::max((groundY - y) * (1 / CELL_SIZE), 0.0f), static_cast<float>(ROWS - 1)); // minss/maxss instead of branches
+
+  // Rounded down without calling floor(), the grid repeats every COLUMNS (a power of 2) columns
+  int column = static_cast<int>(u);
+  column -= u < static_cast<float>(column) ? 1 : 0;
+  const float fu = u - static_cast<float>(column);
+  const int column0 = column & (COLUMNS - 1);
+  const int column1 = (column + 1) & (COLUMNS - 1);
+  const int row0 = std::min(static_cast<int>(v), ROWS - 2);
+  const float fv = v - row0;
+
+  const Node& n00 = nodes[row0 * COLUMNS + column0];
+  const Node& n01 = nodes[row0 * COLUMNS + column1];
+  const Node& n10 = nodes[(row0 + 1) * COLUMNS + column0];
+  const Node& n11 = nodes[(row0 + 1) * COLUMNS + column1];
+  auto blend = [fu, fv](float a00, float a01, float a10, float a11) {
+    const float bottom = a00 + (a01 - a00) * fu;
+    const float top = a10 + (a11 - a10) * fu;
+    return bottom + (top - bottom) * fv;
+  };
+  return { Vector(blend(n00.windX, n01.windX, n10.windX, n11.windX), blend(n00.windY, n01.windY, n10.windY, n11.windY)),
+           blend(n00.density, n01.density, n10.density, n11.density) };
+}
+
+}
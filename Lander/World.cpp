@@ -0,0 +1,144 @@
+#include "stdafx.h"
+#include "World.hpp"
+#include "RigidBody.hpp"
+
+namespace Lander {
+
+const int World::MILLIS_PER_TICK = 5; // 5ms per physics tick (which is more than double my default rate)
+const double World::SECONDS_PER_TICK = MILLIS_PER_TICK / 1000.0;
+
+
+World::World() : initialized(false), gameTick(0) {}
+
+World::~World() {
+  //First clear colliders, we don't want objects to access deleted objects in Deinitialize()
+  colliders.clear();
+
+  //Deinitialize all view objects
+  for (auto viewObject : renderQueue) {
+    viewObject->Deinitialize();
+  }
+  renderQueue.clear();
+}
+
+
+void World::AddObject(ViewObject& viewObject) {
+  viewObject.world = this;
+
+  if (renderQueue.empty()) {
+    renderQueue.push_back(&viewObject);
+  } else { //!empty
+    if (viewObject.RenderPriority() <= renderQueue.back()->RenderPriority()) {
+      renderQueue.push_back(&viewObject);
+    } else if (viewObject.RenderPriority() >= renderQueue.front()->RenderPriority()) {
+      renderQueue.push_front(&viewObject);
+    } else { //insertion + sort
+      renderQueue.push_back(&viewObject);
+      std::stable_sort(renderQueue.begin(), renderQueue.end(), [](ViewObject* v1, ViewObject* v2) { return v1->RenderPriority() > v2->RenderPriority(); });
+    }
+  }
+
+  // Add to collider list if it is a collider
+  if (auto collider = dynamic_cast<Collider*>(&viewObject)) {
+    colliders.push_back(collider);
+    broadphase.Add(*collider);
+  }
+  if (auto body = dynamic_cast<RigidBody*>(&viewObject)) {
+    contactSolver.Add(*body);
+  }
+
+  // If initialization already took place, initialize the object upon insertion
+  if (initialized) {
+    viewObject.Initialize(size);
+    if (auto collider = dynamic_cast<Collider*>(&viewObject)) {
+      broadphase.Update(*collider); // may have changed its size
+    }
+  }
+}
+
+void World::Initialize(Size size) {
+  this->size = size;
+
+  for (auto viewObject : renderQueue) {
+    viewObject->Initialize(size);
+  }
+  for (auto collider : colliders) {
+    broadphase.Update(*collider); // objects may have adapted their size and position
+  }
+
+  initialized = true;
+}
+
+const std::vector<Collider*>& World::GetColliders() const {
+  return colliders;
+}
+
+Broadphase& World::GetBroadphase() {
+  return broadphase;
+}
+
+ContactSolver& World::GetContactSolver() {
+  return contactSolver;
+}
+
+GravitySolver& World::GetGravitySolver() {
+  return gravitySolver;
+}
+
+const Input& World::GetInput() const {
+  return *input;
+}
+
+void World::SetInput(std::unique_ptr<Input>&& input) {
+  this->input = std::move(input);
+}
+
+void World::Tick(int ticks) {
+  // Give objects time to update positions (takes ~25 microseconds in Debug)
+  for (int i = 0; i < ticks; ++i) {
+    input->Tick();
+  }
+  // The bodies attract each other with their positions at the start of the tick (the accelerations last until their Update())
+  if (!gravitySolver.Empty()) {
+    gravitySolver.Apply();
+  }
+  for (auto viewObject : renderQueue) {
+    if (viewObject->enabled) {
+      // update physics at a constant tick rate to make the simulation deterministic
+      viewObject->Update(ticks * SECONDS_PER_TICK);
+    }
+  }
+
+  // Colliders, which check collisions, update their own grid entry before checking. This moves all others, which have moved
+  // (cheap for colliders, which stayed within their grown bounds).
+  for (auto collider : colliders) {
+    if (collider->enabled) {
+      broadphase.Update(*collider);
+    }
+  }
+
+  if (!contactSolver.Empty()) {
+    contactSolver.Solve(broadphase, static_cast<float>(ticks * SECONDS_PER_TICK));
+  }
+
+  gameTick += ticks;
+}
+
+int World::GameTick() const {
+  return gameTick;
+}
+
+void World::ResetGameTick() {
+  gameTick = 0;
+}
+
+World::Snapshot World::TakeSnapshot() const {
+  return { gameTick, input->TakeSnapshot() };
+}
+
+void World::Restore(const Snapshot& snapshot) {
+  gameTick = snapshot.gameTick;
+  input->Restore(snapshot.input);
+}
+
+}
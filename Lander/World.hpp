@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Input.hpp"
+#include "Broadphase.hpp"
+#include "ContactSolver.hpp"
+#include "GravitySolver.hpp"
+
+namespace Lander {
+
+/** The world holds all view objects of the game together with the currently active input and advances the physics
+ *  simulation in fixed ticks. It doesn't know anything about windows or rendering, which allows us to run the
+ *  simulation without a window (see Simulation).
+ */
+class World {
+public:
+  World();
+  virtual ~World();
+
+  // This will be the size of the game window
+  static const int WINDOW_HEIGHT = 960;
+  static const int WINDOW_WIDTH = 1280;
+
+  /** Fixed phyics tick duration for the simulation. We hold it as int milliseconds per tick instead of
+   *  a double seconds per tick to avoid imprecision when calculating expectedTicks=elapsedTime/SECONDS_PER_TICK,
+   *  which would get more and more inprecise the larger elapsed time becomes.
+   */
+  static const int MILLIS_PER_TICK;
+  static const double SECONDS_PER_TICK; // only used to pass the tick duration to ViewObject::Update()
+
+  /** Adds a view object to the world's render queue and makes this world the object's world. The view objects's Initialize() gets called
+   *  in Initialize(). If the object is added after the world's initialization, Initialize() is called immediately.
+   *
+   * @param viewObject the viewObject to add. The World doesn't take ownership of this object and the object has to make sure, it
+   *                   exists at least until Deinitialize() gets called.
+   */
+  void AddObject(ViewObject& viewObject);
+
+  /** Initializes all registered view objects with the given size of the game field.
+   */
+  void Initialize(Size size);
+
+  /** Returns the internal list of colliders for collision checks.
+   */
+  const std::vector<Collider*>& GetColliders() const;
+
+  /** Returns the broadphase, which contains all colliders of this world (see Collider::CheckCollisions())
+   */
+  Broadphase& GetBroadphase();
+
+  /** Returns the solver, which resolves the contacts of the world's rigid bodies at the end of each tick (see RigidBody)
+   */
+  ContactSolver& GetContactSolver();
+
+  /** Returns the solver, with which the registered bodies and gravity wells attract each other at the start of each tick
+   */
+  GravitySolver& GetGravitySolver();
+
+  /** Returns a reference to the currently active input instance
+   */
+  const Input& GetInput() const;
+
+  /** Sets a new input device as the currently active and deletes the old input device
+   */
+  void SetInput(std::unique_ptr<Input>&& input);
+
+  /** Runs a single physics tick by ticking the input, applying the gravity between the bodies of the gravity solver, updating all enabled view objects and resolving the contacts of the rigid bodies.
+   *  Several ticks can be run as a single update over their whole duration, if the inputs stay the same during all of them
+   *  (see Input::UnchangedTicks()). The game tick advances by the given number of ticks.
+   */
+  void Tick(int ticks = 1);
+
+  /** Returns the number of physics ticks, which have been simulated so far.
+   */
+  int GameTick() const;
+
+  /** Starts counting the ticks from 0 again (e.g. when a replay has been loaded)
+   */
+  void ResetGameTick();
+
+  /** The world's own state (the state of the view objects is captured by their owner, see Simulation::Snapshot)
+   */
+  struct Snapshot {
+    int32_t gameTick;
+    Input::Snapshot input;
+
+    bool operator==(const Snapshot& other) const = default;
+  };
+
+  Snapshot TakeSnapshot() const;
+  void Restore(const Snapshot& snapshot);
+
+protected:
+  bool initialized;
+  Size size; // The size of the game field as passed to Initialize()
+
+  int gameTick; // The current game tick (used to control physics simulation speed)
+
+  // The currently active input instance
+  std::unique_ptr<Input> input;
+
+  std::deque<ViewObject*> renderQueue; // List of objects, which get rendered on each draw
+  std::vector<Collider*> colliders; // List of colliders for faster direct access
+  Broadphase broadphase; // The colliders sorted into a grid by their position
+  ContactSolver contactSolver; // Resolves the contacts of all rigid bodies
+  GravitySolver gravitySolver; // Lets the registered bodies attract each other
+};
+
+}
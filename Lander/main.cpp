@@ -4,11 +4,7 @@
 //Game objects
 #include "FPSCounter.hpp"
 #include "FuelTank.hpp"
-#include "Terrain.hpp"
-#include "Platform.hpp"
-#include "Rocket.hpp"
-#include "ScreenText.hpp"
-#include "TimeCounter.hpp"
+#include "Level.hpp"
 #include "InstrumentPanel.hpp"
 
 #include "HoverAIInput.hpp"
@@ -20,7 +16,7 @@ using namespace Lander;
 
 /** main() for windows applications
  */
-int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR /*cmdline*/, int) {
+int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR cmdline, int) {
   // Use HeapSetInformation to specify that the process should
   // terminate if the heap manager detects an error in any heap used
   // by the process.
@@ -38,30 +34,33 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR /*cmdline*/, int) {
       FPSCounter fpsCounter;
       app.AddObject(fpsCounter);
             
-      Terrain terrain;
-      app.AddObject(terrain);
-
-      Platform startPlatform(terrain, 162/*starting xPos*/);
-      app.AddObject(startPlatform);
-
-      Platform landingPlatform(terrain, 835/*target xPos*/);
-      app.AddObject(landingPlatform);
-            
-      ScreenText screenText;
-      app.AddObject(screenText);
-
-      TimeCounter timeCounter;
-      app.AddObject(timeCounter);
-
-      Rocket rocket(startPlatform, landingPlatform, screenText, timeCounter);
-      app.AddObject(rocket);
-      app.TrackObject(rocket);
+      // Terrain, platforms and rocket of the level file given on the command line (the built-in level without one)
+      std::unique_ptr<LevelFile> levelFile;
+      std::string levelPath(cmdline ? cmdline : "");
+      if (levelPath.size() >= 2 && levelPath.front() == '"' && levelPath.back() == '"') {
+        levelPath = levelPath.substr(1, levelPath.size() - 2);
+      }
+      if (!levelPath.empty()) {
+        try {
+          levelFile = std::make_unique<LevelFile>(levelPath);
+        } catch (std::exception& e) {
+          MessageBoxA(NULL, e.what(), "Lander", MB_OK | MB_ICONERROR);
+          CoUninitialize();
+          return 1;
+        }
+      }
+      Level level(levelFile ? *levelFile : LevelFile::BuiltIn());
+      app.AddLevel(level);
+      app.TrackObject(level.rocket);
 
-      InstrumentPanel panel(rocket);
+      InstrumentPanel panel(level.rocket);
       app.AddObject(panel);
 
       // Comment in to hover the rocket in place until it runs out of fuel
-      //app.SetInput(std::make_unique<HoverAIInput>(rocket));
+      //app.SetSimulationInput([](Level& level) { return std::make_unique<HoverAIInput>(level.rocket); });
+
+      // Comment in to advance the game by exactly 1/60 s per frame, no matter how long a frame takes
+      //app.SetClock(std::make_unique<FixedStepClock>(std::chrono::microseconds(16667)));
 
       if (SUCCEEDED(app.Initialize())) {
         app.RunMessageLoop();
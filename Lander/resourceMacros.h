@@ -16,7 +16,9 @@
 
   // Only define the symbols once in the resources.cpp
   #ifdef RESOURCE_CPP
+    #ifdef _WIN32
     #include "FontLoader.hpp"
+    #endif
 
     #undef START_IMAGES
     #undef DEFINE_IMAGE
@@ -33,12 +35,19 @@
 
 
 
+    #ifdef _WIN32
     #define START_FONTS namespace Lander { void registerFonts() { \
       auto fontLoader = Lander::FontLoader::Instance();
 
     #define DEFINE_FONT(name, number, path) fontLoader->RegisterFontResource(L##name, number);
 
     #define END_FONTS } }
+    #else
+    // Headless builds don't render any text, so there is no font loader to register the fonts with
+    #define START_FONTS namespace Lander { void registerFonts() {
+    #define DEFINE_FONT(name, number, path)
+    #define END_FONTS } }
+    #endif
 
   #else
   // How the resource.h looks to every other including cpp/hpp file (declarations)
@@ -2,24 +2,32 @@
 
 // C RunTime Header Files:
 #include <stdlib.h>
-#include <malloc.h>
 #include <memory.h>
 #include <wchar.h>
+#include <stdint.h>
 
 // C++ stl headers
 #include <cmath>
 #include <cassert>
 #include <algorithm>
 #include <memory>
+#include <limits>
+#include <filesystem>
+#include <stdexcept>
 
 #include <string>
 #include <sstream>
-#include <tchar.h>
+#include <iomanip>
 
 //STL collections
 #include <unordered_map>
 #include <vector>
 #include <deque>
+#include <list>
+
+#ifdef _WIN32
+#include <malloc.h>
+#include <tchar.h>
 
 // Windows Header Files:
 #include <windows.h>
@@ -29,15 +37,18 @@
 #include <d2d1helper.h>
 #include <dwrite.h>
 #include <wincodec.h>
+#endif
 
 #include "resources.h" //Our resources
 
 //Utility classes
+#ifdef _WIN32
 #include "Resource.hpp"
 #include "COMError.hpp"
 #include "COMBase.hpp"
-#include "Vector.hpp"
 #include "Data.hpp"
+#endif
+#include "Vector.hpp"
 
 #include "RenderInterface.hpp"
 #include "ViewObject.hpp"
@@ -45,7 +56,7 @@
 #include "Collider.hpp"
 #include "PhysicsObject.hpp"
 
-#ifndef HINST_THISCOMPONENT
+#if defined(_WIN32) && !defined(HINST_THISCOMPONENT)
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 #define HINST_THISCOMPONENT ((HINSTANCE)&__ImageBase)
 #endif
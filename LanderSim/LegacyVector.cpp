@@ -0,0 +1,80 @@
+#include "stdafx.h"
+#include "LegacyVector.hpp"
+#include "DeterministicMath.hpp"
+
+namespace {
+  const float PI = 3.14159265359f;
+}
+
+namespace Lander {
+namespace Legacy {
+
+Vector::Vector() : x(0), y(0) {}
+Vector::Vector(float x, float y) : x(x), y(y) {}
+Vector::Vector(const Vector& other) : x(other.x), y(other.y) {}
+
+Vector Vector::Rotate(float angle) const {
+  float radAngle = angle*PI / 180;
+  float cosAngle = SimulationMath::Cos(radAngle);
+  float sinAngle = SimulationMath::Sin(radAngle);
+  return Vector((x * cosAngle) - (y * sinAngle),
+                (x * sinAngle) + (y * cosAngle));
+}
+
+Vector& Vector::operator=(const Vector& other) {
+  x = other.x;
+  y = other.y;
+  return *this;
+}
+
+Vector& Vector::operator+=(const Vector& other) {
+  x += other.x;
+  y += other.y;
+  return *this;
+}
+
+Vector Vector::operator+(const Vector& other) const {
+  return Vector(x+other.x, y+other.y);
+}
+
+Vector Vector::operator-(const Vector& other) const {
+  return Vector(x-other.x, y-other.y);
+}
+
+Vector Vector::operator*(float factor) const {
+  return Vector(x*factor, y*factor);
+}
+
+float Vector::operator*(const Vector& other) const {
+  return x * other.x + y * other.y;
+}
+
+float Vector::Length() const {
+  return std::sqrt(x*x + y*y);
+}
+
+
+Transform::Transform() : m11(1), m12(0), m21(0), m22(1), dx(0), dy(0) {}
+
+Transform Transform::Rotation(float angle, Vector center) {
+  float radAngle = angle*PI / 180;
+  float cosAngle = SimulationMath::Cos(radAngle);
+  float sinAngle = SimulationMath::Sin(radAngle);
+
+  Transform rotation;
+  rotation.m11 = cosAngle;
+  rotation.m12 = -sinAngle;
+  rotation.m21 = sinAngle;
+  rotation.m22 = cosAngle;
+  rotation.dx = center.x - (cosAngle * center.x - sinAngle * center.y);
+  rotation.dy = center.y - (sinAngle * center.x + cosAngle * center.y);
+  return rotation;
+}
+
+Vector Transform::operator()(Vector point) const {
+  return Vector(m11 * point.x + m12 * point.y + dx,
+                m21 * point.x + m22 * point.y + dy);
+}
+
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace Lander {
+
+/** The vector math as it was before Vector became header-only: every operation is an out-of-line call in
+ *  LegacyVector.cpp and the copy constructor and assignment are user-provided. Only used as the baseline of BenchmarkVectors().
+ */
+namespace Legacy {
+
+class Vector {
+public:
+  Vector(); // (0,0)
+  Vector(float x, float y);
+  Vector(const Vector& other);
+
+  Vector Rotate(float angle) const;
+
+  Vector& operator=(const Vector& other);
+  Vector& operator+=(const Vector& other);
+  Vector operator+(const Vector& other) const;
+  Vector operator-(const Vector& other) const;
+  Vector operator*(float factor) const;
+  float operator*(const Vector& other) const;
+
+  float Length() const;
+
+  float x, y;
+};
+
+class Transform {
+public:
+  Transform(); // identity
+
+  static Transform Rotation(float angle, Vector center);
+
+  Vector operator()(Vector point) const;
+
+  float m11, m12, m21, m22;
+  float dx, dy;
+};
+
+}
+}
@@ -0,0 +1,1965 @@
+#include "stdafx.h"
+#include "Verifier.hpp"
+#include "Simulation.hpp"
+#include "ReplayInput.hpp"
+#include "RocketBatch.hpp"
+#include "ReplayIndex.hpp"
+#include "SimulationThread.hpp"
+#include "Clock.hpp"
+#include "DeterministicMath.hpp"
+#include "LegacyVector.hpp"
+#include "KeyboardInput.hpp"
+#include "Terrain.hpp"
+#include "Platform.hpp"
+#include "MirrorInput.hpp"
+#include "RigidBody.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <thread>
+
+namespace Lander {
+
+const char* OutcomeName(Rocket::STATE state) {
+  switch (state) {
+    case Rocket::STATE::SUCCESS:   return "SUCCESS";
+    case Rocket::STATE::CRASHED:   return "CRASHED";
+    case Rocket::STATE::LANDED:    return "LANDED";
+    case Rocket::STATE::STARTED:   return "FLYING";
+    case Rocket::STATE::UNSTARTED: return "UNSTARTED";
+  }
+  return "UNKNOWN";
+}
+
+
+VerificationResult VerifyReplay(const std::filesystem::path& file, Size levelSize, const LevelFile& level) {
+  VerificationResult result;
+  result.file = file.string();
+
+  try {
+    auto start = std::chrono::steady_clock::now();
+    Simulation simulation(std::make_unique<ReplayInput>(file), levelSize, level);
+    simulation.Run();
+    result.simulationMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    result.state = simulation.rocket.GetState();
+    result.ticks = simulation.world.GameTick();
+    result.peakVelocity = simulation.PeakVelocity();
+    result.fuelLeft = simulation.rocket.GetTank().CurrentVolume();
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+
+AdaptiveResult VerifyAdaptive(const std::filesystem::path& file, Size levelSize, int maxTicksPerStep, const LevelFile& level) {
+  AdaptiveResult result;
+  try {
+    Vector fixedPos, adaptivePos;
+    for (int ticks : { 1, maxTicksPerStep }) {
+      VerificationResult& verification = ticks == 1 ? result.fixed : result.adaptive;
+      verification.file = file.string();
+      verification.simulationMillis = std::numeric_limits<double>::infinity();
+      for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        Simulation simulation(std::make_unique<ReplayInput>(file), levelSize, level);
+        simulation.SetMaxTicksPerStep(ticks);
+        int steps = 0;
+        while (!simulation.IsFinished()) {
+          simulation.Tick();
+          ++steps;
+        }
+        verification.simulationMillis = std::min(verification.simulationMillis, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+        verification.state = simulation.rocket.GetState();
+        verification.ticks = simulation.world.GameTick();
+        verification.peakVelocity = simulation.PeakVelocity();
+        verification.fuelLeft = simulation.rocket.GetTank().CurrentVolume();
+        (ticks == 1 ? fixedPos : adaptivePos) = simulation.rocket.pos;
+        if (ticks != 1) {
+          result.adaptiveSteps = steps;
+        }
+      }
+    }
+    result.positionError = (adaptivePos - fixedPos).Length();
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+  return result;
+}
+
+
+std::vector<VerificationResult> VerifyReplays(const std::vector<std::filesystem::path>& files, Size levelSize, unsigned jobs, const LevelFile& level) {
+  if (jobs == 0) {
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  jobs = std::min<unsigned>(jobs, static_cast<unsigned>(files.size()));
+
+  std::vector<VerificationResult> results(files.size());
+
+  // Workers pick the next file from a shared counter, so long replays don't leave other workers idle.
+  // Each result slot is only written by the worker, which picked the file.
+  std::atomic<size_t> nextFile(0);
+  auto worker = [&]() {
+    for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+      results[i] = VerifyReplay(files[i], levelSize, level);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < jobs; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker(); // the calling thread is a worker too
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  return results;
+}
+
+
+LockstepResult VerifyLockstep(const std::filesystem::path& file, Size levelSize, size_t lanes, const LevelFile& level) {
+  using clock = std::chrono::steady_clock;
+  LockstepResult result;
+  result.lanes = lanes;
+
+  try {
+    Simulation simulation(std::make_unique<ReplayInput>(file), levelSize, level);
+    RocketBatch batch(simulation.rocket);
+    for (size_t i = 0; i < lanes; ++i) {
+      batch.AddLane(simulation.rocket);
+    }
+
+    std::vector<uint8_t> inputs(lanes);
+    std::vector<uint8_t> flightInputs; // the inputs of all compared ticks for the throughput measurement
+    clock::duration kernelTime(0);
+
+    while (!simulation.IsFinished()) {
+      bool wasFlying = simulation.rocket.GetState() == Rocket::STATE::STARTED;
+      const Terrain::Snapshot terrainBefore = simulation.level.terrain.TakeSnapshot();
+      simulation.Tick();
+
+      if (wasFlying) {
+        // The input of the tick is still active until the next tick
+        auto input = static_cast<uint8_t>(simulation.world.GetInput().AllActiveInputs());
+        std::fill(inputs.begin(), inputs.end(), input);
+        flightInputs.push_back(input);
+
+        // The lanes don't carve craters: they collide with the terrain from before the rocket's crash
+        const Terrain::Snapshot terrainAfter = simulation.level.terrain.TakeSnapshot();
+        simulation.level.terrain.Restore(terrainBefore);
+        auto start = clock::now();
+        batch.Tick(inputs.data());
+        kernelTime += clock::now() - start;
+        simulation.level.terrain.Restore(terrainAfter);
+
+        ++result.comparedTicks;
+        for (size_t i = 0; i < lanes; ++i) {
+          if (!batch.LaneEquals(i, simulation.rocket)) {
+            ++result.mismatchedTicks;
+            break;
+          }
+        }
+      } else if (simulation.rocket.GetState() == Rocket::STATE::STARTED) {
+        // Rocket took off (again) -> start all lanes from the rocket's state
+        if (simulation.rocket.integrator != Integrator::AverageVelocity) {
+          throw std::runtime_error(std::string("RocketBatch can't simulate replays recorded with ") + IntegratorName(simulation.rocket.integrator));
+        }
+        for (size_t i = 0; i < lanes; ++i) {
+          batch.SetLane(i, simulation.rocket);
+        }
+        batch.gameTick = simulation.world.GameTick();
+      }
+    }
+
+    if (result.comparedTicks == 0) {
+      return result;
+    }
+    result.laneTicksPerSecond = lanes * result.comparedTicks / std::chrono::duration<double>(kernelTime).count();
+
+    // Throughput without collisions: the same flight again, but all lanes stay in the STARTED state
+    RocketBatch flightBatch(simulation.rocket, false);
+    for (size_t i = 0; i < lanes; ++i) {
+      flightBatch.AddLane(simulation.rocket);
+      flightBatch.state[i] = Rocket::STATE::STARTED;
+    }
+    auto start = clock::now();
+    for (auto input : flightInputs) {
+      std::fill(inputs.begin(), inputs.end(), input);
+      flightBatch.Tick(inputs.data());
+    }
+    result.laneTicksPerSecondNoCollisions = lanes * flightInputs.size() / std::chrono::duration<double>(clock::now() - start).count();
+
+    // Without rotation, the thrust vectors (two deterministic sines and cosines per lane) are only calculated once
+    RocketBatch kernelBatch(simulation.rocket, false);
+    for (size_t i = 0; i < lanes; ++i) {
+      kernelBatch.AddLane(simulation.rocket);
+      kernelBatch.state[i] = Rocket::STATE::STARTED;
+      kernelBatch.angularVelocity[i] = 0;
+    }
+    start = clock::now();
+    for (auto input : flightInputs) {
+      std::fill(inputs.begin(), inputs.end(), static_cast<uint8_t>(input & ~(Input::RollLeft | Input::RollRight)));
+      kernelBatch.Tick(inputs.data());
+    }
+    result.laneTicksPerSecondNoRotation = lanes * flightInputs.size() / std::chrono::duration<double>(clock::now() - start).count();
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+
+WindResult VerifyWind(const std::filesystem::path& file, Size levelSize, uint32_t seed, size_t lanes, const LevelFile& level) {
+  using clock = std::chrono::steady_clock;
+  WindResult result;
+  const std::filesystem::path windyFile = std::filesystem::temp_directory_path()
+                                        / (file.stem().string() + "-wind-" + std::to_string(seed) + ".sav");
+
+  try {
+    // The recorded entries without the header (see Recorder::SaveReplay())
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream) {
+      throw std::runtime_error("Failed to open the file");
+    }
+    std::vector<Recorder::Entry> entries;
+    Recorder::Entry entry;
+    while (stream.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+      entries.push_back(entry);
+    }
+    Integrator integrator = Integrator::AverageVelocity;
+    size_t headerEntries = 0;
+    if (!entries.empty() && entries[0].inputs == Recorder::HEADER_INPUTS) {
+      integrator = static_cast<Integrator>(entries[0].ticks);
+      for (headerEntries = 1; headerEntries < entries.size()
+           && (entries[headerEntries].inputs == Recorder::WIND_INPUTS || entries[headerEntries].inputs == Recorder::LEVEL_INPUTS); ++headerEntries) {}
+    }
+    const uint32_t recordedLevel = ReplayInput(file).RecordedLevel().value_or(0);
+    if (!Recorder::WriteReplay(windyFile, entries.data() + headerEntries, entries.size() - headerEntries, integrator, seed, recordedLevel)) {
+      throw std::runtime_error("Failed to write the replay with wind");
+    }
+    if (ReplayInput(windyFile).RecordedWindSeed() != seed) {
+      throw std::runtime_error("The wind seed got lost in the replay");
+    }
+
+    result.calm = VerifyReplay(file, levelSize, level);
+    result.windy = VerifyReplay(windyFile, levelSize, level);
+    if (!result.calm.error.empty() || !result.windy.error.empty()) {
+      throw std::runtime_error(result.calm.error.empty() ? result.windy.error : result.calm.error);
+    }
+
+    Simulation::Snapshot finalSnapshots[2];
+    for (auto& snapshot : finalSnapshots) {
+      Simulation simulation(std::make_unique<ReplayInput>(windyFile), levelSize, level);
+      simulation.Run();
+      snapshot = simulation.TakeSnapshot();
+    }
+    result.deterministic = finalSnapshots[0] == finalSnapshots[1];
+
+    result.lockstep = VerifyLockstep(windyFile, levelSize, lanes, level);
+    result.calmLaneTicksPerSecond = VerifyLockstep(file, levelSize, lanes, level).laneTicksPerSecond;
+    if (!result.lockstep.error.empty()) {
+      throw std::runtime_error(result.lockstep.error);
+    }
+
+    // Many objects at random positions across the level and above it, which sample the field on every tick
+    WindField wind;
+    wind.Generate(seed, levelSize.height);
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(-levelSize.width, 2 * levelSize.width);
+    std::uniform_real_distribution<float> y(-levelSize.height, levelSize.height);
+    std::vector<Vector> positions(4096);
+    for (auto& position : positions) {
+      position = Vector(x(random), y(random));
+    }
+    std::vector<WindField::Sample> samples(positions.size());
+    const int ticks = 250;
+    auto start = clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+      const float offset = wind.Offset(tick);
+      for (size_t i = 0; i < positions.size(); ++i) {
+        samples[i] = wind.At(positions[i].x, positions[i].y, offset);
+      }
+    }
+    result.sampleNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (ticks * positions.size());
+    for (auto& sample : samples) {
+      if (!std::isfinite(sample.wind.x) || !std::isfinite(sample.wind.y) || !(sample.density > 0)) {
+        throw std::runtime_error("The wind field returned invalid samples");
+      }
+    }
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  std::error_code ignored;
+  std::filesystem::remove(windyFile, ignored);
+  return result;
+}
+
+
+namespace {
+
+bool SameOutcome(const Simulation::Snapshot& a, const Simulation::Snapshot& b) {
+  return a.world == b.world && a.level == b.level && a.peakVelocity == b.peakVelocity;
+}
+
+bool SameState(const World::Snapshot& world, const Level::Snapshot& level, const Simulation::Snapshot& expected) {
+  return world == expected.world && level == expected.level;
+}
+
+}
+
+SnapshotResult VerifySnapshots(const std::filesystem::path& file, Size levelSize, int samples, const LevelFile& level) {
+  using clock = std::chrono::steady_clock;
+  SnapshotResult result;
+
+  try {
+    Simulation simulation(std::make_unique<ReplayInput>(file), levelSize, level);
+
+    std::vector<Simulation::Snapshot> snapshots;
+    clock::duration takeTime(0);
+    do {
+      snapshots.emplace_back();
+      auto start = clock::now();
+      snapshots.back() = simulation.TakeSnapshot();
+      takeTime += clock::now() - start;
+
+      if (simulation.IsFinished()) {
+        break;
+      }
+      simulation.Tick();
+    } while (true);
+
+    const auto finalSnapshot = snapshots.back();
+    result.snapshots = static_cast<int>(snapshots.size());
+    result.takeNanos = std::chrono::duration<double, std::nano>(takeTime).count() / snapshots.size();
+
+    // Restore throughput (each snapshot once, in order)
+    auto start = clock::now();
+    for (auto& snapshot : snapshots) {
+      simulation.Restore(snapshot);
+    }
+    result.restoreNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / snapshots.size();
+
+    // Seek back and forth through the replay and re-simulate from there
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> pick(0, snapshots.size() - 1);
+    for (int i = 0; i < samples; ++i) {
+      bool restored = simulation.Restore(snapshots[pick(random)]);
+      simulation.Run();
+
+      ++result.checkedSnapshots;
+      if (!restored || !SameOutcome(simulation.TakeSnapshot(), finalSnapshot)) {
+        ++result.mismatches;
+      }
+    }
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+
+SeekResult VerifySeeking(const std::filesystem::path& file, Size levelSize, int seeks, int interval, const LevelFile& level) {
+  using clock = std::chrono::steady_clock;
+  SeekResult result;
+
+  try {
+    // Reference states of all ticks
+    std::vector<Simulation::Snapshot> expected;
+    Simulation reference(std::make_unique<ReplayInput>(file), levelSize, level);
+    expected.push_back(reference.TakeSnapshot());
+    while (!reference.IsFinished()) {
+      reference.Tick();
+      expected.push_back(reference.TakeSnapshot());
+    }
+    result.ticks = reference.world.GameTick();
+
+    Simulation simulation(std::make_unique<ReplayInput>(file), levelSize, level);
+    auto start = clock::now();
+    ReplayIndex index(simulation.world, simulation.level, interval);
+    result.indexMillis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> pick(0, result.ticks);
+    double totalMicros = 0;
+    for (int i = 0; i < seeks; ++i) {
+      int tick = pick(random);
+      start = clock::now();
+      index.Seek(tick);
+      double micros = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+      totalMicros += micros;
+      result.maxSeekMicros = std::max(result.maxSeekMicros, micros);
+
+      ++result.seeks;
+      if (!SameState(simulation.world.TakeSnapshot(), simulation.level.TakeSnapshot(), expected[tick])) {
+        ++result.mismatches;
+      }
+    }
+    result.averageSeekMicros = seeks > 0 ? totalMicros / seeks : 0;
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+
+ThreadedResult VerifyThreaded(const std::filesystem::path& file, Size levelSize, int replaySpeedExponent, ClockType clockType, const LevelFile& level) {
+  using clock = std::chrono::steady_clock;
+  ThreadedResult result;
+
+  try {
+    Simulation reference(std::make_unique<ReplayInput>(file), levelSize, level);
+    reference.Run();
+    const auto expected = reference.TakeSnapshot();
+
+    std::unique_ptr<Clock> gameClock;
+    switch (clockType) {
+      case ClockType::REAL:  gameClock = std::make_unique<RealTimeClock>(); break;
+      case ClockType::FIXED: gameClock = std::make_unique<FixedStepClock>(FRAME_STEP); break;
+      case ClockType::FAST:  gameClock = std::make_unique<AsFastAsPossibleClock>(); break;
+    }
+
+    auto start = clock::now();
+    SimulationThread simulation(levelSize, *gameClock, nullptr, level);
+    simulation.SetReplaySpeed(replaySpeedExponent);
+    simulation.LoadReplay(std::make_unique<ReplayInput>(file));
+
+    // Wait for the replay to be loaded (the tick restarts at 0) and played back up to the tick, in which it finished
+    bool loaded = false;
+    int lastTick = 0;
+    while (true) {
+      // The "render" loop: the fixed step clock advances one frame per iteration, the other clocks advance on their own
+      gameClock->NextFrame();
+      if (!simulation.ConsumeFrame()) {
+        if (clockType == ClockType::FAST) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        continue;
+      }
+
+      auto& frame = simulation.CurrentFrame();
+      ++result.frames;
+      loaded = loaded || frame.world.gameTick < lastTick || frame.world.input.position > 0;
+      lastTick = frame.world.gameTick;
+      if (loaded && frame.world.gameTick >= expected.world.gameTick) {
+        // A frame may show a later tick than the one the replay finished in (especially with the fast clock, which runs
+        // many ticks per frame) and a rocket, which is still flying, moves on. So compare with the reference at the same tick.
+        while (reference.world.GameTick() < frame.world.gameTick) {
+          reference.Tick();
+        }
+        auto referenceRocket = reference.rocket.TakeSnapshot();
+        result.ticks = frame.world.gameTick;
+        result.identical = frame.level.rocket.state == referenceRocket.state && frame.level.rocket.fuelVolume == referenceRocket.fuelVolume;
+        break;
+      }
+    }
+    result.seconds = std::chrono::duration<double>(clock::now() - start).count();
+    result.clockSeconds = std::chrono::duration<double>(gameClock->Now().time_since_epoch()).count();
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+
+  return result;
+}
+
+
+namespace {
+
+/** Returns the distance of a and b in units in the last place (the number of doubles between them)
+ */
+double UlpDistance(double a, double b) {
+  auto ordered = [](double value) {
+    int64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? std::numeric_limits<int64_t>::min() - bits : bits; // monotonic for negative values too
+  };
+  auto distance = ordered(a) - ordered(b);
+  return static_cast<double>(distance < 0 ? -distance : distance);
+}
+
+MathBenchmarkResult CompareFunction(const std::string& name, const std::vector<double>& arguments, double (*libm)(double), double (*deterministic)(double)) {
+  using clock = std::chrono::steady_clock;
+  MathBenchmarkResult result;
+  result.function = name;
+
+  std::vector<double> expected(arguments.size()), actual(arguments.size());
+  auto start = clock::now();
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    expected[i] = libm(arguments[i]);
+  }
+  result.libmNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / arguments.size();
+
+  start = clock::now();
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    actual[i] = deterministic(arguments[i]);
+  }
+  result.deterministicNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / arguments.size();
+
+  size_t different = 0;
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    if (std::memcmp(&expected[i], &actual[i], sizeof(double)) != 0) {
+      ++different;
+      result.maxUlps = std::max(result.maxUlps, UlpDistance(expected[i], actual[i]));
+    }
+  }
+  result.differentResults = static_cast<double>(different) / arguments.size();
+  return result;
+}
+
+}
+
+std::vector<MathBenchmarkResult> BenchmarkMath(int samples) {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<double> angles(-4 * 3.14159265358979323846, 4 * 3.14159265358979323846); // rotations in radians
+  std::uniform_real_distribution<double> terrain(0, 4000 * 0.02 * 1.7);                                       // Terrain::ExactTerrainHeight()
+  std::uniform_real_distribution<double> cosines(-1, 1);
+
+  std::vector<double> angleArguments(samples), terrainArguments(samples), cosineArguments(samples);
+  for (int i = 0; i < samples; ++i) {
+    angleArguments[i] = angles(random);
+    terrainArguments[i] = terrain(random);
+    cosineArguments[i] = cosines(random);
+  }
+
+  auto libmSin = [](double x) { return std::sin(x); };
+  auto libmCos = [](double x) { return std::cos(x); };
+  auto libmAcos = [](double x) { return std::acos(x); };
+  return {
+    CompareFunction("sin (rotations)", angleArguments, libmSin, DeterministicMath::Sin),
+    CompareFunction("cos (rotations)", angleArguments, libmCos, DeterministicMath::Cos),
+    CompareFunction("sin (terrain)", terrainArguments, libmSin, DeterministicMath::Sin),
+    CompareFunction("cos (terrain)", terrainArguments, libmCos, DeterministicMath::Cos),
+    CompareFunction("acos", cosineArguments, libmAcos, DeterministicMath::Acos),
+  };
+}
+
+
+namespace {
+
+/** Returns the time per point of the fastest of several calls of operation
+ */
+template <class Operation>
+double NanosPerPoint(size_t points, Operation operation) {
+  const int RUNS = 5;
+  double fastest = std::numeric_limits<double>::max();
+  for (int run = 0; run < RUNS; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    operation();
+    fastest = std::min(fastest, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+  }
+  return fastest / points;
+}
+
+bool SameBits(const Legacy::Vector& legacy, const Vector& vector) {
+  return std::memcmp(&legacy.x, &vector.x, sizeof(float)) == 0 && std::memcmp(&legacy.y, &vector.y, sizeof(float)) == 0;
+}
+
+bool SamePoints(const std::vector<Legacy::Vector>& legacy, const std::vector<Vector>& vectors) {
+  for (size_t i = 0; i < legacy.size(); ++i) {
+    if (!SameBits(legacy[i], vectors[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}
+
+std::vector<VectorBenchmarkResult> BenchmarkVectors(int points) {
+  const size_t count = static_cast<size_t>(points);
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> positions(-500, 500);
+  std::uniform_real_distribution<float> velocities(-50, 50);
+
+  std::vector<Legacy::Vector> legacyPositions(count), legacyVelocities(count), legacyOut(count);
+  std::vector<Vector> vectorPositions(count), vectorVelocities(count), vectorOut(count), batchOut(count);
+  for (size_t i = 0; i < count; ++i) {
+    vectorPositions[i] = Vector(positions(random), positions(random));
+    vectorVelocities[i] = Vector(velocities(random), velocities(random));
+    legacyPositions[i] = Legacy::Vector(vectorPositions[i].x, vectorPositions[i].y);
+    legacyVelocities[i] = Legacy::Vector(vectorVelocities[i].x, vectorVelocities[i].y);
+  }
+
+  std::vector<VectorBenchmarkResult> results;
+  const float dt = 1.0f / 60;
+  const float angle = 37.5f;
+
+  // One physics step: move by the velocity and take the distance travelled (PhysicsObject::Update())
+  VectorBenchmarkResult arithmetic;
+  arithmetic.operation = "pos+v*dt,Length";
+  std::vector<float> legacyLengths(count), vectorLengths(count);
+  arithmetic.legacyNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      legacyOut[i] = legacyPositions[i] + legacyVelocities[i] * dt;
+      legacyLengths[i] = (legacyOut[i] - legacyPositions[i]).Length();
+    }
+  });
+  arithmetic.inlineNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      vectorOut[i] = vectorPositions[i] + vectorVelocities[i] * dt;
+      vectorLengths[i] = (vectorOut[i] - vectorPositions[i]).Length();
+    }
+  });
+  arithmetic.identical = SamePoints(legacyOut, vectorOut)
+                      && std::memcmp(legacyLengths.data(), vectorLengths.data(), count * sizeof(float)) == 0;
+  results.push_back(arithmetic);
+
+  // Rotating the corners of a collider (Collider::CheckCollisions() before the cached transforms)
+  VectorBenchmarkResult rotation;
+  rotation.operation = "Rotate";
+  rotation.legacyNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      legacyOut[i] = legacyPositions[i].Rotate(angle);
+    }
+  });
+  rotation.inlineNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      vectorOut[i] = vectorPositions[i].Rotate(angle);
+    }
+  });
+  rotation.batchNanos = NanosPerPoint(count, [&]() { RotatePoints(angle, vectorPositions.data(), batchOut.data(), count); });
+  rotation.identical = SamePoints(legacyOut, vectorOut) && SamePoints(legacyOut, batchOut);
+  results.push_back(rotation);
+
+  // Mapping object coordinates into the world (ViewObject::ObjectToWorld())
+  VectorBenchmarkResult transformation;
+  transformation.operation = "Transform";
+  auto legacyTransform = Legacy::Transform::Rotation(angle, Legacy::Vector(20, 40));
+  legacyTransform.dx += 300;
+  legacyTransform.dy += 200;
+  auto transform = Transform::Rotation(angle, Vector(20, 40));
+  transform.dx += 300;
+  transform.dy += 200;
+  transformation.legacyNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      legacyOut[i] = legacyTransform(legacyPositions[i]);
+    }
+  });
+  transformation.inlineNanos = NanosPerPoint(count, [&]() {
+    for (size_t i = 0; i < count; ++i) {
+      vectorOut[i] = transform(vectorPositions[i]);
+    }
+  });
+  transformation.batchNanos = NanosPerPoint(count, [&]() { TransformPoints(transform, vectorPositions.data(), batchOut.data(), count); });
+  transformation.identical = SamePoints(legacyOut, vectorOut) && SamePoints(legacyOut, batchOut);
+  results.push_back(transformation);
+
+  return results;
+}
+
+
+namespace {
+
+/** A small box for BenchmarkBroadphase(), which moves through the field, bounces off its borders and records its collisions
+ */
+class Debris : public Collider {
+public:
+  Debris(uint32_t id, Vector velocity, float angularVelocity, Size field, bool bruteForce)
+    : id(id), velocity(velocity), angularVelocity(angularVelocity), field(field), bruteForce(bruteForce) {}
+
+  virtual void Update(double secondsSinceLastFrame) override {
+    const float seconds = static_cast<float>(secondsSinceLastFrame);
+    pos += velocity * seconds;
+    rotation += angularVelocity * seconds;
+    if (pos.x < 0 || pos.x + size.width > field.width) {
+      velocity.x = -velocity.x;
+    }
+    if (pos.y < 0 || pos.y + size.height > field.height) {
+      velocity.y = -velocity.y;
+    }
+
+    if (bruteForce) {
+      CheckCollisions(world->GetColliders());
+    } else {
+      CheckCollisions();
+    }
+  }
+
+  virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override {}
+
+  const uint32_t id;
+  uint64_t collisions = 0;
+  uint64_t checksum = 0; // of the ids of the colliders hit, in order
+
+private:
+  virtual void OnCollision(Collider& collider, const ContactManifold& contact) override {
+    ++collisions;
+    checksum = checksum * 1000003 + static_cast<Debris&>(collider).id;
+  }
+
+  Vector velocity;
+  const float angularVelocity;
+  const Size field;
+  const bool bruteForce;
+};
+
+/** Fills the world with randomly placed debris (the same for the same seed)
+ */
+void AddDebris(World& world, std::vector<std::unique_ptr<Debris>>& debris, int count, bool bruteForce, uint32_t seed) {
+  // About one box per 40x40 units, so the density doesn't depend on the count
+  const float side = std::sqrt(static_cast<float>(count)) * 40;
+  const Size field(side, side);
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> positions(0, side - 16);
+  std::uniform_real_distribution<float> sizes(4, 16);
+  std::uniform_real_distribution<float> speeds(-100, 100);
+  std::uniform_real_distribution<float> angles(-90, 90);
+
+  world.SetInput(std::make_unique<KeyboardInput>());
+  for (int i = 0; i < count; ++i) {
+    Vector velocity(speeds(random), speeds(random));
+    debris.push_back(std::make_unique<Debris>(static_cast<uint32_t>(i), velocity, angles(random), field, bruteForce));
+    debris.back()->pos = Vector(positions(random), positions(random));
+    debris.back()->size = Size(sizes(random), sizes(random));
+    debris.back()->rotation = angles(random);
+    world.AddObject(*debris.back());
+  }
+  world.Initialize(field);
+}
+
+}
+
+BroadphaseBenchmarkResult BenchmarkBroadphase(int colliders, int ticks) {
+  using clock = std::chrono::steady_clock;
+  BroadphaseBenchmarkResult result;
+  result.ticks = ticks;
+  // Checking every collider takes quadratic time, so only a few ticks are compared with many colliders
+  result.bruteForceTicks = static_cast<int>(std::clamp<int64_t>(20000000 / (static_cast<int64_t>(colliders) * colliders), 2, ticks));
+
+  // The debris is declared before the worlds to outlive them
+  std::vector<std::unique_ptr<Debris>> debris, bruteForceDebris;
+  World world, bruteForceWorld;
+  AddDebris(world, debris, colliders, false, 42);
+  AddDebris(bruteForceWorld, bruteForceDebris, colliders, true, 42);
+
+  auto start = clock::now();
+  for (int tick = 0; tick < result.bruteForceTicks; ++tick) {
+    bruteForceWorld.Tick();
+  }
+  result.bruteForceMillis = std::chrono::duration<double, std::milli>(clock::now() - start).count() / result.bruteForceTicks;
+
+  start = clock::now();
+  for (int tick = 0; tick < ticks; ++tick) {
+    world.Tick();
+    if (tick + 1 == result.bruteForceTicks) {
+      result.identical = std::equal(debris.begin(), debris.end(), bruteForceDebris.begin(), [](auto& a, auto& b) {
+        return a->collisions == b->collisions && a->checksum == b->checksum;
+      });
+    }
+  }
+  result.broadphaseMillis = std::chrono::duration<double, std::milli>(clock::now() - start).count() / ticks;
+
+  size_t candidates = 0;
+  for (auto& box : debris) {
+    candidates += world.GetBroadphase().Query(box->WorldBounds()).size() - 1; // without the box itself
+  }
+  result.averageCandidates = static_cast<double>(candidates) / debris.size();
+
+  std::vector<std::pair<Collider*, Collider*>> pairs;
+  start = clock::now();
+  world.GetBroadphase().CandidatePairs(pairs);
+  result.candidatePairsMillis = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  result.candidatePairs = pairs.size();
+
+  return result;
+}
+
+
+namespace {
+
+/** Returns the corners of the collider's rectangle in world coordinates in order around the rectangle
+ */
+std::array<Vector, 4> Corners(const Collider& collider) {
+  Rectangle rect(Vector::Zero, collider.size);
+  const Transform& toWorld = collider.ObjectToWorldTransform();
+  return { toWorld(rect.topLeft), toWorld(rect.TopRight()), toWorld(rect.bottomRight), toWorld(rect.BottomLeft()) };
+}
+
+/** Returns the orientation of the triangle a, b, c (positive, negative or 0 if collinear) in double precision
+ */
+double Orientation(Vector a, Vector b, Vector c) {
+  return (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y) - (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x);
+}
+
+bool InsideConvex(const std::array<Vector, 4>& polygon, Vector point) {
+  bool negative = false, positive = false;
+  for (size_t i = 0; i < polygon.size(); ++i) {
+    double orientation = Orientation(polygon[i], polygon[(i + 1) % polygon.size()], point);
+    negative = negative || orientation < 0;
+    positive = positive || orientation > 0;
+  }
+  return !(negative && positive);
+}
+
+bool SegmentsIntersect(Vector a1, Vector a2, Vector b1, Vector b2) {
+  double d1 = Orientation(b1, b2, a1), d2 = Orientation(b1, b2, a2);
+  double d3 = Orientation(a1, a2, b1), d4 = Orientation(a1, a2, b2);
+  return ((d1 < 0) != (d2 < 0)) && ((d3 < 0) != (d4 < 0));
+}
+
+/** Reference test: two convex polygons overlap, if a corner of one is inside the other or two edges cross
+ */
+bool PolygonsOverlap(const std::array<Vector, 4>& a, const std::array<Vector, 4>& b) {
+  for (size_t i = 0; i < 4; ++i) {
+    if (InsideConvex(b, a[i]) || InsideConvex(a, b[i])) {
+      return true;
+    }
+    for (size_t j = 0; j < 4; ++j) {
+      if (SegmentsIntersect(a[i], a[(i + 1) % 4], b[j], b[(j + 1) % 4])) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+}
+
+NarrowphaseBenchmarkResult BenchmarkNarrowphase(int pairs) {
+  NarrowphaseBenchmarkResult result;
+  result.pairs = pairs;
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> positions(0, 60);
+  std::uniform_real_distribution<float> sizes(1, 60);
+  std::uniform_real_distribution<float> thinSizes(1, 4);
+  std::uniform_real_distribution<float> angles(-180, 180);
+
+  // Objects (like the rocket) and obstacles (a quarter of them as thin as the platforms)
+  std::vector<std::unique_ptr<Debris>> objects, obstacles;
+  for (int i = 0; i < pairs; ++i) {
+    for (auto list : { &objects, &obstacles }) {
+      list->push_back(std::make_unique<Debris>(static_cast<uint32_t>(i), Vector::Zero, 0.0f, Size(), false));
+      auto& box = *list->back();
+      box.pos = Vector(positions(random), positions(random));
+      box.size = Size(sizes(random), (list == &obstacles && i % 4 == 0) ? thinSizes(random) : sizes(random));
+      box.rotation = angles(random);
+      box.ObjectToWorldTransform(); // calculate the cached transformations upfront, like the simulation does once per tick
+      box.WorldToObjectTransform();
+    }
+  }
+
+  std::vector<char> separatingAxisHits(pairs), pointTestHits(pairs);
+  std::vector<ContactManifold> contacts(pairs);
+  result.separatingAxisNanos = NanosPerPoint(pairs, [&]() {
+    for (int i = 0; i < pairs; ++i) {
+      separatingAxisHits[i] = obstacles[i]->CollidesWith(*objects[i], contacts[i]);
+    }
+  });
+  result.pointTestNanos = NanosPerPoint(pairs, [&]() {
+    for (int i = 0; i < pairs; ++i) {
+      auto points = objects[i]->OutlinePoints();
+      const Collider& obstacle = *obstacles[i];
+      pointTestHits[i] = std::any_of(points.begin(), points.end(), [&obstacle](const Vector& point) { return obstacle.IsPointInside(point); });
+    }
+  });
+
+  for (int i = 0; i < pairs; ++i) {
+    bool overlapping = PolygonsOverlap(Corners(*objects[i]), Corners(*obstacles[i]));
+    result.overlapping += overlapping;
+    result.separatingAxisHits += separatingAxisHits[i];
+    result.pointTestHits += pointTestHits[i];
+    result.separatingAxisWrong += separatingAxisHits[i] != overlapping;
+
+    // The contact points lie on the incident face, so they must be within the penetration depth of both rectangles
+    auto& contact = contacts[i];
+    auto inside = [&contact](const OrientedBox& box, Vector point) {
+      const float tolerance = contact.depth + 1e-3f;
+      Vector offset = point - box.center;
+      return std::abs(offset * box.axisX) <= box.halfSize.width + tolerance && std::abs(offset * box.axisY) <= box.halfSize.height + tolerance;
+    };
+    bool pointsInside = std::all_of(contact.points.begin(), contact.points.begin() + contact.pointCount, [&](const Vector& point) {
+      return inside(objects[i]->WorldBox(), point) && inside(obstacles[i]->WorldBox(), point);
+    });
+    if (separatingAxisHits[i] && (std::abs(contact.normal.Length() - 1) > 1e-4f || contact.depth < 0 || contact.pointCount < 1 || !pointsInside)) {
+      ++result.invalidContacts;
+    }
+  }
+
+  return result;
+}
+
+
+namespace {
+
+/** A box for BenchmarkSweep(), which falls down and remembers when it touched something first
+ */
+class FallingBox : public PhysicsObject {
+public:
+  explicit FallingBox(bool continuous) {
+    continuousCollisions = continuous;
+    size = Size(16, 50);
+  }
+
+  virtual void PhysicsUpdate(double secondsSinceLastFrame) override {
+    ApplyGravity();
+  }
+
+  /** Checks the current position only, like the rocket did at the beginning of every tick
+   */
+  void CheckPosition() {
+    CheckCollisions();
+  }
+
+  virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override {}
+
+  Collider* hit = nullptr;
+  float hitTime = 1; // fraction of the tick
+
+private:
+  virtual void OnCollision(Collider& collider, const ContactManifold& contact) override {
+    hit = &collider;
+    hitTime = contact.time;
+  }
+};
+
+}
+
+std::vector<SweepBenchmarkResult> BenchmarkSweep(int drops) {
+  using clock = std::chrono::steady_clock;
+  const Size field(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  Terrain terrain; // only positions the platform
+  terrain.Initialize(field);
+
+  // The same drops for every tick duration: the distance of the box's bottom to the platform, its speed and horizontal offset
+  struct Drop { float height, speed, offset; };
+  std::vector<Drop> dropList(drops);
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> heights(20, 300), speeds(50, 800), offsets(-17, 17);
+  for (auto& drop : dropList) {
+    drop = { heights(random), speeds(random), offsets(random) };
+  }
+
+  std::vector<SweepBenchmarkResult> results;
+  for (int millisPerTick : { 5, 20, 50 }) {
+    SweepBenchmarkResult result;
+    result.millisPerTick = millisPerTick;
+    result.drops = drops;
+    const double seconds = millisPerTick / 1000.0;
+
+    for (bool continuous : { false, true }) {
+      Platform platform(terrain, field.width / 2);
+      FallingBox box(continuous);
+      World world;
+      world.SetInput(std::make_unique<KeyboardInput>());
+      world.AddObject(platform);
+      world.AddObject(box);
+      platform.Update(0);
+      world.Initialize(field);
+
+      int tunneled = 0;
+      int64_t ticks = 0;
+      double errorSum = 0, maxError = 0;
+      auto start = clock::now();
+      for (auto& drop : dropList) {
+        box.pos = Vector(platform.pos.x + (platform.size.width - box.size.width) / 2 + drop.offset, platform.pos.y - drop.height - box.size.height);
+        box.rotation = 0;
+        box.Stop();
+        box.velocity = Vector::Down * drop.speed;
+        box.hit = nullptr;
+
+        int tick = 0;
+        // Until the box hits something or is completely below the platform
+        while (!box.hit && box.pos.y < platform.pos.y + platform.size.height) {
+          box.Update(seconds);
+          if (!continuous) {
+            box.CheckPosition();
+          }
+          ++tick;
+        }
+        ticks += tick;
+
+        if (box.hit != &platform) {
+          ++tunneled;
+          continue;
+        }
+        // The bottom moves by (v*t + g*t^2/2) * PIXEL_PER_METER, solved for the distance to the platform
+        const double gravity = 9.81;
+        const double exactTime = (-drop.speed + std::sqrt(static_cast<double>(drop.speed) * drop.speed + 2 * gravity * drop.height / PhysicsObject::PIXEL_PER_METER)) / gravity;
+        const double error = std::abs((tick - 1 + box.hitTime) * seconds - exactTime) * 1000;
+        errorSum += error;
+        maxError = std::max(maxError, error);
+      }
+      const double nanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / std::max<int64_t>(ticks, 1);
+      const double meanError = drops > tunneled ? errorSum / (drops - tunneled) : 0;
+
+      (continuous ? result.sweptTunneled : result.discreteTunneled) = tunneled;
+      (continuous ? result.sweptMeanError : result.discreteMeanError) = meanError;
+      (continuous ? result.sweptMaxError : result.discreteMaxError) = maxError;
+      (continuous ? result.sweptNanos : result.discreteNanos) = nanos;
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
+
+std::vector<TerrainBenchmarkResult> BenchmarkTerrain(int queries) {
+  const Size field(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  const size_t count = static_cast<size_t>(queries);
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> positions(0, field.width);
+  std::vector<float> xs(count);
+  for (auto& x : xs) {
+    x = positions(random);
+  }
+  // The batch covers the field in even steps
+  const float dx = field.width / count;
+
+  std::vector<float> exactHeights(count), exactSlopes(count), heights(count), slopes(count), batchHeights(count), singleHeights(count);
+  std::vector<TerrainBenchmarkResult> results;
+  for (auto interpolation : { Terrain::Interpolation::Linear, Terrain::Interpolation::Cubic }) {
+    for (float spacing : { 1.0f, 2.0f, 4.0f, 8.0f }) {
+      Terrain terrain(interpolation, spacing);
+      terrain.Initialize(field);
+
+      TerrainBenchmarkResult result;
+      result.interpolation = interpolation;
+      result.sampleSpacing = spacing;
+      result.exactNanos = NanosPerPoint(count, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+          exactHeights[i] = terrain.ExactTerrainHeight(xs[i]);
+        }
+      });
+      result.sampledNanos = NanosPerPoint(count, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+          heights[i] = terrain.GetTerrainHeight(xs[i]);
+        }
+      });
+      result.slopeNanos = NanosPerPoint(count, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+          slopes[i] = terrain.GetTerrainSlope(xs[i]);
+        }
+      });
+      result.batchNanos = NanosPerPoint(count, [&]() { terrain.GetTerrainHeights(0, dx, count, batchHeights.data()); });
+
+      for (size_t i = 0; i < count; ++i) {
+        exactSlopes[i] = terrain.ExactTerrainSlope(xs[i]);
+        singleHeights[i] = terrain.GetTerrainHeight(0 + i * dx);
+
+        const double heightError = std::abs(static_cast<double>(heights[i]) - exactHeights[i]);
+        const double slopeError = std::abs(static_cast<double>(slopes[i]) - exactSlopes[i]);
+        result.meanHeightError += heightError / count;
+        result.maxHeightError = std::max(result.maxHeightError, heightError);
+        result.meanSlopeError += slopeError / count;
+        result.maxSlopeError = std::max(result.maxSlopeError, slopeError);
+      }
+      result.batchIdentical = std::memcmp(batchHeights.data(), singleHeights.data(), count * sizeof(float)) == 0;
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+
+namespace {
+
+/** Intersects random segments and moving boxes within the field with the terrain and compares the hits with stepping along them
+ */
+RaycastBenchmarkResult CheckRaycasts(const Terrain& terrain, Size field, int queries, uint32_t seed) {
+  using clock = std::chrono::steady_clock;
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> xs(0, field.width), ys(0, field.height), angles(0, 2 * Vector::PI);
+  const float onSurface = 1e-2f; // px, how far a hit may be from the stepped surface
+  // Vertically or horizontally, so steep walls (e.g. of craters) don't need more precision than the floats have
+  auto isOnSurface = [&](Vector pos) {
+    const bool below = terrain.GetAltitude(pos) < 0;
+    return std::abs(terrain.GetAltitude(pos)) < onSurface || (terrain.GetAltitude(pos - Vector(onSurface, 0)) < 0) != below
+           || (terrain.GetAltitude(pos + Vector(onSurface, 0)) < 0) != below;
+  };
+
+  RaycastBenchmarkResult result;
+  result.segments = queries;
+  result.boxes = std::max(queries / 20, 1);
+
+  struct Segment { Vector from, to; };
+  std::vector<Segment> segments(result.segments);
+  std::uniform_real_distribution<float> segmentLengths(10, 600);
+  for (auto& segment : segments) {
+    segment.from = Vector(xs(random), ys(random));
+    const float angle = angles(random);
+    segment.to = segment.from + Vector(std::cos(angle), std::sin(angle)) * segmentLengths(random);
+  }
+
+  // Segments: step in 0.25 px steps until a point is below the surface
+  const float segmentStep = 0.25f;
+  std::vector<Terrain::Hit> hits(segments.size());
+  std::vector<char> found(segments.size());
+  auto start = clock::now();
+  for (size_t i = 0; i < segments.size(); ++i) {
+    found[i] = terrain.IntersectSegment(segments[i].from, segments[i].to, hits[i]);
+  }
+  result.segmentTreeNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / segments.size();
+
+  std::vector<float> stepped(segments.size());
+  start = clock::now();
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const Vector direction = segments[i].to - segments[i].from;
+    const int steps = static_cast<int>(std::ceil(direction.Length() / segmentStep));
+    stepped[i] = -1;
+    for (int step = 0; step <= steps; ++step) {
+      if (terrain.GetAltitude(segments[i].from + direction * (static_cast<float>(step) / steps)) < 0) {
+        stepped[i] = static_cast<float>(step) / steps;
+        break;
+      }
+    }
+  }
+  result.segmentSteppedNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / segments.size();
+
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const float length = (segments[i].to - segments[i].from).Length();
+    // Touching the surface between two steps is only found by the tree, but every hit has to be on the surface and not after the stepped one
+    bool valid = stepped[i] < 0 || found[i];
+    if (found[i]) {
+      ++result.segmentHits;
+      valid = valid && (hits[i].fraction == 0 || isOnSurface(hits[i].pos));
+      if (stepped[i] >= 0) {
+        const double distance = (stepped[i] - hits[i].fraction) * length;
+        valid = valid && distance > -onSurface;
+        result.segmentMaxDistance = std::max(result.segmentMaxDistance, distance);
+      }
+    }
+    result.segmentMismatches += valid ? 0 : 1;
+  }
+
+  // Boxes: move in 0.5 px steps until the surface is above the bottom at one of the columns (0.5 px apart) below the box
+  struct Box { Rectangle box; Vector displacement; };
+  std::vector<Box> boxes(result.boxes);
+  std::uniform_real_distribution<float> widths(10, 60), displacementLengths(10, 400);
+  for (auto& box : boxes) {
+    const Vector topLeft(xs(random), ys(random));
+    box.box = Rectangle(topLeft, topLeft + Vector(widths(random), widths(random)));
+    const float angle = angles(random);
+    box.displacement = Vector(std::cos(angle), std::sin(angle)) * displacementLengths(random);
+  }
+
+  const float boxStep = 0.5f;
+  std::vector<Terrain::Hit> boxHits(boxes.size());
+  std::vector<char> boxFound(boxes.size());
+  start = clock::now();
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    boxFound[i] = terrain.SweepBox(boxes[i].box, boxes[i].displacement, boxHits[i]);
+  }
+  result.boxTreeNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / boxes.size();
+
+  std::vector<float> boxStepped(boxes.size());
+  start = clock::now();
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    const Rectangle& box = boxes[i].box;
+    const int steps = static_cast<int>(std::ceil(boxes[i].displacement.Length() / boxStep));
+    const int columns = static_cast<int>(std::ceil((box.bottomRight.x - box.topLeft.x) / boxStep));
+    boxStepped[i] = -1;
+    for (int step = 0; step <= steps && boxStepped[i] < 0; ++step) {
+      const Vector offset = boxes[i].displacement * (static_cast<float>(step) / steps);
+      for (int column = 0; column <= columns; ++column) {
+        const float x = box.topLeft.x + (box.bottomRight.x - box.topLeft.x) * column / columns + offset.x;
+        if (terrain.GetAltitude(Vector(x, box.bottomRight.y + offset.y)) < 0) {
+          boxStepped[i] = static_cast<float>(step) / steps;
+          break;
+        }
+      }
+    }
+  }
+  result.boxSteppedNanos = std::chrono::duration<double, std::nano>(clock::now() - start).count() / boxes.size();
+
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    const Terrain::Hit& hit = boxHits[i];
+    bool valid = boxStepped[i] < 0 || boxFound[i];
+    if (boxFound[i]) {
+      ++result.boxHits;
+      // The hit must be on the surface and on the outline of the moved box
+      Rectangle moved = boxes[i].box;
+      moved += boxes[i].displacement * hit.fraction;
+      const bool onBox = hit.pos.x > moved.topLeft.x - onSurface && hit.pos.x < moved.bottomRight.x + onSurface &&
+                         hit.pos.y > moved.topLeft.y - onSurface && hit.pos.y < moved.bottomRight.y + onSurface;
+      valid = valid && (hit.fraction == 0 || (onBox && isOnSurface(hit.pos)));
+      if (boxStepped[i] >= 0) {
+        const double distance = (boxStepped[i] - hit.fraction) * boxes[i].displacement.Length();
+        valid = valid && distance > -onSurface;
+        result.boxMaxDistance = std::max(result.boxMaxDistance, distance);
+      }
+    }
+    result.boxMismatches += valid ? 0 : 1;
+  }
+  return result;
+}
+
+}
+
+RaycastBenchmarkResult BenchmarkRaycast(int queries) {
+  const Size field(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  Terrain terrain;
+  terrain.Initialize(field);
+  return CheckRaycasts(terrain, field, queries, 42);
+}
+
+
+const char* IntegratorName(Integrator integrator) {
+  switch (integrator) {
+    case Integrator::AverageVelocity:   return "AverageVelocity";
+    case Integrator::SemiImplicitEuler: return "SemiImplicitEuler";
+    case Integrator::VelocityVerlet:    return "VelocityVerlet";
+    case Integrator::RungeKutta4:       return "RungeKutta4";
+  }
+  return "UNKNOWN";
+}
+
+namespace {
+
+/** The inputs of the integrator benchmark's flight at the given time after the take off: full thrust with a few rolls
+ *  (the inputs only change at multiples of 50 ms, so they change at the same time for all tick durations)
+ */
+int FlightInputs(int64_t micros) {
+  int inputs = Input::Thrust;
+  if ((micros >= 500000 && micros < 1500000) || (micros >= 4500000 && micros < 5000000)) {
+    inputs |= Input::RollRight;
+  } else if (micros >= 2500000 && micros < 4000000) {
+    inputs |= Input::RollLeft;
+  }
+  return inputs;
+}
+
+}
+
+std::vector<IntegratorBenchmarkResult> BenchmarkIntegrators(int repetitions) {
+  using clock = std::chrono::steady_clock;
+  const int64_t flightMicros = 6000000;
+  const int64_t checkpointMicros = 500000;
+
+  // The rocket's state right after the take off (the take off tick doesn't move it) and its forces
+  auto input = std::make_unique<MirrorInput>();
+  MirrorInput& controls = *input;
+  Simulation simulation(std::move(input));
+  Rocket& rocket = simulation.rocket;
+  controls.SetActiveInputs(Input::Thrust);
+  rocket.Update(World::SECONDS_PER_TICK);
+  const Simulation::Snapshot takeOff = simulation.TakeSnapshot();
+  FuelTank tank = rocket.GetTank();
+  const double thrust = tank.GetThrust(0); // N
+  const double massFlow = tank.MassFlow(); // kg/s
+  const double rcsAcceleration = 10;       // deg/s^2, Rocket::angularAcceleration
+  const double gravity = 9.81;
+
+  // Reference: classic Runge-Kutta in double precision with 10 us steps. The state is x, y (m), vx, vy, rotation, angular velocity and mass.
+  using State = std::array<double, 7>;
+  auto derivative = [&](const State& s, int inputs) {
+    const bool thrusting = (inputs & Input::Thrust) != 0;
+    const double radians = s[4] * Vector::PI / 180;
+    const double thrustAcceleration = thrusting ? thrust / s[6] : 0;
+    const double angularAcceleration = (inputs & Input::RollRight ? rcsAcceleration : 0) - (inputs & Input::RollLeft ? rcsAcceleration : 0);
+    // Vector::Up.Rotate(rotation) = (sin, -cos)
+    return State{ s[2], s[3], thrustAcceleration * std::sin(radians), gravity - thrustAcceleration * std::cos(radians), s[5], angularAcceleration, thrusting ? -massFlow : 0 };
+  };
+  auto add = [](const State& s, const State& d, double factor) {
+    State result;
+    for (size_t i = 0; i < s.size(); ++i) {
+      result[i] = s[i] + d[i] * factor;
+    }
+    return result;
+  };
+
+  std::vector<State> reference;
+  State state = { rocket.pos.x / PhysicsObject::PIXEL_PER_METER, rocket.pos.y / PhysicsObject::PIXEL_PER_METER, 0, 0, 0, 0, rocket.mass };
+  const int64_t referenceStep = 10;
+  const double h = referenceStep / 1e6;
+  for (int64_t micros = 0; micros < flightMicros; micros += referenceStep) {
+    const int inputs = FlightInputs(micros);
+    const State k1 = derivative(state, inputs);
+    const State k2 = derivative(add(state, k1, h / 2), inputs);
+    const State k3 = derivative(add(state, k2, h / 2), inputs);
+    const State k4 = derivative(add(state, k3, h), inputs);
+    for (size_t i = 0; i < state.size(); ++i) {
+      state[i] += (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]) * (h / 6);
+    }
+    if ((micros + referenceStep) % checkpointMicros == 0) {
+      reference.push_back(state);
+    }
+  }
+
+  std::vector<IntegratorBenchmarkResult> results;
+  for (auto integrator : { Integrator::AverageVelocity, Integrator::SemiImplicitEuler, Integrator::VelocityVerlet, Integrator::RungeKutta4 }) {
+    for (int64_t tickMicros : { 5000, 10000, 20000, 25000, 50000 }) {
+      IntegratorBenchmarkResult result;
+      result.integrator = integrator;
+      result.tickMicros = static_cast<int>(tickMicros);
+      const double seconds = tickMicros / 1e6;
+
+      clock::duration elapsed(0);
+      for (int repetition = 0; repetition < std::max(repetitions, 1); ++repetition) {
+        simulation.Restore(takeOff);
+        rocket.integrator = integrator;
+        size_t checkpoint = 0;
+        for (int64_t micros = 0; micros < flightMicros; micros += tickMicros) {
+          controls.SetActiveInputs(FlightInputs(micros));
+          auto start = clock::now();
+          rocket.Update(seconds);
+          elapsed += clock::now() - start;
+
+          if (repetition == 0 && (micros + tickMicros) % checkpointMicros == 0) {
+            const State& expected = reference[checkpoint++];
+            const Vector position = rocket.pos / PhysicsObject::PIXEL_PER_METER;
+            result.maxPositionError = std::max(result.maxPositionError, std::hypot(position.x - expected[0], position.y - expected[1]));
+            result.maxVelocityError = std::max(result.maxVelocityError, std::hypot(rocket.velocity.x - expected[2], rocket.velocity.y - expected[3]));
+          }
+        }
+        if (rocket.GetState() != Rocket::STATE::STARTED) {
+          result.error = "the rocket touched down during the flight";
+        }
+      }
+      result.microsPerSecond = std::chrono::duration<double, std::micro>(elapsed).count() / std::max(repetitions, 1) / (flightMicros / 1e6);
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+
+namespace {
+
+/** An immovable box for BenchmarkContacts() (ground, walls and ramps)
+ */
+class Wall : public Collider {
+public:
+  Wall(Vector pos, Size size, float rotation = 0) {
+    this->pos = pos;
+    this->size = size;
+    this->rotation = rotation;
+  }
+
+  virtual void Draw(RenderInterface& renderTarget, const Rectangle& visibleRect, double secondsSinceLastFrame) override {}
+};
+
+/** Returns the deepest penetration (px) of any of the bodies into any collider
+ */
+float MaxDepth(World& world, const std::vector<std::unique_ptr<RigidBody>>& bodies) {
+  float depth = 0;
+  ContactManifold contact;
+  for (auto& body : bodies) {
+    for (auto collider : world.GetBroadphase().Query(body->WorldBounds())) {
+      if (collider != body.get() && collider->CollidesWith(*body, contact)) {
+        depth = std::max(depth, contact.depth);
+      }
+    }
+  }
+  return depth;
+}
+
+/** Runs the world for the given number of ticks and measures the time per tick, the contacts and the fastest body during the last second
+ */
+void RunContacts(World& world, const std::vector<std::unique_ptr<RigidBody>>& bodies, int ticks, ContactBenchmarkResult& result) {
+  using clock = std::chrono::steady_clock;
+  const int lastSecond = ticks - static_cast<int>(1 / World::SECONDS_PER_TICK);
+  size_t contacts = 0, warmStarted = 0;
+  clock::duration elapsed(0);
+  for (int tick = 0; tick < ticks; ++tick) {
+    auto start = clock::now();
+    world.Tick();
+    elapsed += clock::now() - start;
+    contacts += world.GetContactSolver().ContactCount();
+    warmStarted += world.GetContactSolver().WarmStartedContactCount();
+    if (tick >= lastSecond) {
+      for (auto& body : bodies) {
+        result.maxRestingSpeed = std::max(result.maxRestingSpeed, static_cast<double>(body->velocity.Length()));
+      }
+    }
+  }
+  result.microsPerTick = std::chrono::duration<double, std::micro>(elapsed).count() / ticks;
+  result.averageContacts = static_cast<double>(contacts) / ticks;
+  result.warmStartedShare = contacts > 0 ? static_cast<double>(warmStarted) / contacts : 0;
+  result.maxDepth = MaxDepth(world, bodies);
+}
+
+/** Drops a box with 6 m/s onto the ground and measures the speed it bounces off with
+ */
+ContactBenchmarkResult Touchdown(bool warmStarting) {
+  ContactBenchmarkResult result;
+  result.scenario = "touchdown";
+  result.warmStarting = warmStarting;
+  result.bodies = 1;
+
+  // The objects are declared before the world to outlive it
+  Wall ground(Vector(0, 500), Size(400, 50));
+  std::vector<std::unique_ptr<RigidBody>> bodies;
+  bodies.push_back(std::make_unique<RigidBody>(Size(20, 20), 50.0f, 0.5f, 0.5f));
+  World world;
+  world.SetInput(std::make_unique<KeyboardInput>());
+  world.GetContactSolver().warmStarting = warmStarting;
+  RigidBody& box = *bodies.back();
+  box.pos = Vector(190, 480);
+  box.velocity = Vector::Down * 6;
+  world.AddObject(ground);
+  world.AddObject(box);
+  world.Initialize(Size(400, 550));
+
+  // The bounce is the first tick, in which the box moves up
+  float impactSpeed = 0;
+  while (box.velocity.y > 0) {
+    impactSpeed = box.velocity.y + 9.81f * static_cast<float>(World::SECONDS_PER_TICK); // the gravity is applied before the contact is solved
+    world.Tick();
+  }
+  result.measured = -box.velocity.y / impactSpeed;
+  result.expected = box.restitution;
+  RunContacts(world, bodies, 600, result);
+  return result;
+}
+
+/** Puts a box on a 25 degree ramp and measures its acceleration along the ramp during 2 s
+ */
+ContactBenchmarkResult Slope(float friction, bool warmStarting) {
+  const float angle = -25;
+  ContactBenchmarkResult result;
+  result.scenario = friction < 0.466f ? "sliding on a slope" : "resting on a slope";
+  result.warmStarting = warmStarting;
+  result.bodies = 1;
+
+  Wall ramp(Vector(0, 400), Size(800, 40), angle);
+  std::vector<std::unique_ptr<RigidBody>> bodies;
+  bodies.push_back(std::make_unique<RigidBody>(Size(20, 10), 20.0f, friction, 0.0f));
+  World world;
+  world.SetInput(std::make_unique<KeyboardInput>());
+  world.GetContactSolver().warmStarting = warmStarting;
+  RigidBody& box = *bodies.back();
+  // Resting on the ramp's top face, a bit right of its center
+  const OrientedBox rampBox = ramp.WorldBox();
+  const Vector up = rampBox.axisY * -1;
+  const Vector center = rampBox.center + up * (rampBox.halfSize.height + box.size.height / 2) + rampBox.axisX * 100;
+  box.pos = center - box.Center();
+  box.rotation = angle;
+  world.AddObject(ramp);
+  world.AddObject(box);
+  world.Initialize(Size(800, 800));
+
+  const int ticks = static_cast<int>(2 / World::SECONDS_PER_TICK);
+  RunContacts(world, bodies, ticks, result);
+  const double radians = -angle * Vector::PI / 180;
+  result.measured = box.velocity.Length() / 2;
+  result.expected = std::max(9.81 * (std::sin(radians) - friction * std::cos(radians)), 0.0);
+  result.maxRestingSpeed = 0; // the sliding box doesn't rest
+  return result;
+}
+
+/** Drops the given number of boxes of random sizes, which are stacked in rows, into a container and lets them settle for 15 s
+ */
+ContactBenchmarkResult Pile(int count, bool warmStarting) {
+  ContactBenchmarkResult result;
+  result.scenario = "pile";
+  result.analytic = false;
+  result.warmStarting = warmStarting;
+  result.bodies = count;
+
+  // Four times as many columns as rows, so the rows don't fall too far (the boxes are 4-9 m large)
+  const int columns = static_cast<int>(std::ceil(std::sqrt(4.0 * count)));
+  const float width = columns * 24.0f;
+  const float height = (count / columns + 1) * 24.0f + 100;
+  Wall ground(Vector(-20, height), Size(width + 40, 20));
+  Wall left(Vector(-20, 0), Size(20, height));
+  Wall right(Vector(width, 0), Size(20, height));
+  std::vector<std::unique_ptr<RigidBody>> bodies;
+  World world;
+  world.SetInput(std::make_unique<KeyboardInput>());
+  world.GetContactSolver().warmStarting = warmStarting;
+  world.AddObject(ground);
+  world.AddObject(left);
+  world.AddObject(right);
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> sizes(8, 18), angles(-15, 15), speeds(-1, 1);
+  for (int i = 0; i < count; ++i) {
+    const Size size(sizes(random), sizes(random));
+    bodies.push_back(std::make_unique<RigidBody>(size, size.width * size.height / 10));
+    RigidBody& body = *bodies.back();
+    body.pos = Vector((i % columns) * 24.0f + 12, height - 12 - (i / columns) * 24.0f) - body.Center();
+    body.rotation = angles(random);
+    body.velocity = Vector(speeds(random), speeds(random));
+    world.AddObject(body);
+  }
+  world.Initialize(Size(width, height));
+
+  RunContacts(world, bodies, static_cast<int>(15 / World::SECONDS_PER_TICK), result);
+  return result;
+}
+
+}
+
+std::vector<ContactBenchmarkResult> BenchmarkContacts(int bodies) {
+  std::vector<ContactBenchmarkResult> results;
+  for (bool warmStarting : { true, false }) {
+    results.push_back(Touchdown(warmStarting));
+    results.push_back(Slope(0.2f, warmStarting));
+    results.push_back(Slope(0.6f, warmStarting));
+    results.push_back(Pile(bodies, warmStarting));
+  }
+  return results;
+}
+
+
+namespace {
+
+const uint64_t STREAMING_SEED = 12345;
+
+/** The results of the queries of one tick of BenchmarkStreaming()
+ */
+using StreamingQueries = std::array<float, 12>; // see QueryStreamingTick()
+
+/** Queries the terrain around the box like the simulation does for the rocket and returns the number of queries
+ */
+int QueryStreamingTick(const Terrain& terrain, const Rectangle& box, Vector displacement, StreamingQueries& results) {
+  int count = 0;
+  const float width = box.bottomRight.x - box.topLeft.x;
+  for (int i = 0; i < 8; ++i) {
+    results[count++] = terrain.GetTerrainHeight(box.topLeft.x + i * width / 7);
+  }
+  results[count++] = terrain.GetTerrainSlope((box.topLeft.x + box.bottomRight.x) / 2);
+  results[count++] = terrain.Clearance(box, 100);
+  Terrain::Hit hit;
+  const Vector bottom((box.topLeft.x + box.bottomRight.x) / 2, box.bottomRight.y);
+  results[count++] = terrain.IntersectSegment(bottom, bottom + Vector(displacement.x, 300), hit) ? hit.fraction : -1;
+  results[count++] = terrain.SweepBox(box, displacement + Vector(0, 20), hit) ? hit.fraction : -1;
+  return count;
+}
+
+StreamingBenchmarkResult FlyStreaming(int chunks, float speed) {
+  using clock = std::chrono::steady_clock;
+  const Size field(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  StreamingBenchmarkResult result;
+  result.speed = speed;
+
+  Terrain terrain(Terrain::Interpolation::Linear, 1, STREAMING_SEED);
+  terrain.Initialize(field);
+  TerrainChunkCache& cache = *terrain.GetChunkCache();
+  result.capacity = cache.Capacity();
+
+  // The box flies 50 px above the surface
+  const float distance = chunks * Terrain::CHUNK_WIDTH;
+  result.ticks = static_cast<int>(distance / speed);
+  std::vector<StreamingQueries> results(result.ticks);
+  std::vector<Rectangle> boxes(result.ticks);
+  for (int tick = 0; tick < result.ticks; ++tick) {
+    const float x = tick * speed;
+    const auto start = clock::now();
+    const float y = field.height - terrain.GetTerrainHeight(x) - 50;
+    boxes[tick] = Rectangle(Vector(x - 20, y - 30), Vector(x + 20, y));
+    result.queries += 1 + QueryStreamingTick(terrain, boxes[tick], Vector(speed, 0), results[tick]);
+    const double micros = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    result.averageTickMicros += micros;
+    result.maxTickMicros = std::max(result.maxTickMicros, micros);
+    result.maxCachedChunks = std::max(result.maxCachedChunks, cache.Size());
+  }
+  result.averageTickMicros /= std::max(result.ticks, 1);
+  result.missingChunkQueries = terrain.MissingChunkQueries();
+  const auto statistics = cache.GetStatistics();
+  result.generatedChunks = statistics.generated;
+  result.evictedChunks = statistics.evicted;
+
+  // The same queries with every chunk generated before
+  Terrain reference(Terrain::Interpolation::Linear, 1, STREAMING_SEED);
+  reference.Initialize(field);
+  for (int tick = 0; tick < result.ticks; ++tick) {
+    const Rectangle& box = boxes[tick];
+    reference.Prefetch(box.topLeft.x - 100, box.bottomRight.x + speed + 100);
+    reference.GetChunkCache()->WaitIdle();
+    StreamingQueries expected{};
+    QueryStreamingTick(reference, box, Vector(speed, 0), expected);
+    if (std::memcmp(expected.data(), results[tick].data(), sizeof(expected)) != 0) {
+      ++result.mismatches;
+    }
+  }
+
+  // Chunks far away from everything generated so far
+  const int generated = 8;
+  for (int i = 0; i < generated; ++i) {
+    const float x = (chunks + 100 + 10 * i) * Terrain::CHUNK_WIDTH;
+    const auto start = clock::now();
+    reference.Prefetch(x, x); // the chunk and both neighbours
+    reference.GetChunkCache()->WaitIdle();
+    result.generateMicros += std::chrono::duration<double, std::micro>(clock::now() - start).count();
+  }
+  result.generateMicros /= 3 * generated;
+
+  // Seams: the height change between neighbouring pixels
+  for (int x = 1; x < static_cast<int>(distance); ++x) {
+    const double step = std::abs(reference.GetTerrainHeight(static_cast<float>(x)) - reference.GetTerrainHeight(static_cast<float>(x - 1)));
+    double& max = x % static_cast<int>(Terrain::CHUNK_WIDTH) == 0 ? result.maxSeamStep : result.maxStep;
+    max = std::max(max, step);
+  }
+  return result;
+}
+
+}
+
+std::vector<StreamingBenchmarkResult> BenchmarkStreaming(int chunks) {
+  std::vector<StreamingBenchmarkResult> results;
+  for (float speed : { 8.0f, 64.0f, 512.0f }) {
+    results.push_back(FlyStreaming(chunks, speed));
+  }
+  return results;
+}
+
+
+namespace {
+
+CraterBenchmarkResult CarveCraters(int craters, uint64_t seed) {
+  using clock = std::chrono::steady_clock;
+  const Size field(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  const int width = static_cast<int>(field.width);
+  Terrain terrain(Terrain::Interpolation::Linear, 1, seed);
+  terrain.Initialize(field);
+  Terrain reference(Terrain::Interpolation::Linear, 1, seed);
+  reference.Initialize(field);
+  for (Terrain* waiting : { &terrain, &reference }) {
+    if (waiting->GetChunkCache()) {
+      waiting->Prefetch(-field.width, 2 * field.width);
+      waiting->GetChunkCache()->WaitIdle();
+    }
+  }
+
+  CraterBenchmarkResult result;
+  result.seed = seed;
+  result.craters = craters;
+  const int frames = 600;
+  const int queries = 2000;
+
+  // The view scrolls by 7 px per frame across the field and back
+  auto frameX = [&](int frame) { return -width / 2 + (frame * 7) % width; };
+  auto scroll = [&]() {
+    const auto start = clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+      terrain.ColumnHeights(frameX(frame), frameX(frame) + width - 1);
+    }
+    return std::chrono::duration<double, std::micro>(clock::now() - start).count() / frames;
+  };
+  result.frameMicrosBefore = scroll();
+  result.queryNanosBefore = CheckRaycasts(terrain, field, queries, 42).segmentTreeNanos;
+
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> xs(0, field.width), radii(25, 70);
+  std::vector<float> expected(width);
+  double carveMicros = 0;
+  for (int i = 0; i < craters; ++i) {
+    const float x = xs(random);
+    const float radius = radii(random);
+    const auto start = clock::now();
+    terrain.AddCrater({ x, terrain.GetTerrainPos(x).y, radius, radius / 2 });
+    const double micros = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    carveMicros += micros;
+    result.maxCarveMicros = std::max(result.maxCarveMicros, micros);
+
+    const int firstX = frameX(i);
+    const float* columns = terrain.ColumnHeights(firstX, firstX + width - 1);
+    terrain.GetTerrainHeights(static_cast<float>(firstX), 1, expected.size(), expected.data());
+    if (!std::equal(expected.begin(), expected.end(), columns)) {
+      ++result.columnMismatches;
+    }
+  }
+  result.carveMicros = craters > 0 ? carveMicros / craters : 0;
+  result.frameMicrosAfter = scroll();
+  const auto fullStart = clock::now();
+  for (int frame = 0; frame < frames; ++frame) {
+    terrain.GetTerrainHeights(static_cast<float>(frameX(frame)), 1, expected.size(), expected.data());
+  }
+  result.fullFrameMicros = std::chrono::duration<double, std::micro>(clock::now() - fullStart).count() / frames;
+  const RaycastBenchmarkResult raycasts = CheckRaycasts(terrain, field, queries, 42);
+  result.queryNanosAfter = raycasts.segmentTreeNanos;
+  result.queryMismatches = raycasts.segmentMismatches + raycasts.boxMismatches;
+
+  // Without the craters, the terrain has to be exactly the same as before
+  terrain.RemoveCraters(0);
+  for (int x = -width; x <= 2 * width; ++x) {
+    if (terrain.GetTerrainHeight(static_cast<float>(x)) != reference.GetTerrainHeight(static_cast<float>(x))) {
+      ++result.removeMismatches;
+    }
+  }
+  std::uniform_real_distribution<float> starts(-field.width, 2 * field.width), lengths(0, 200);
+  for (int i = 0; i < queries; ++i) {
+    const float x0 = starts(random), x1 = x0 + lengths(random);
+    float minHeight = 0, maxHeight = 0, expectedMin = 0, expectedMax = 0;
+    terrain.GetTerrainHeightRange(x0, x1, minHeight, maxHeight);
+    reference.GetTerrainHeightRange(x0, x1, expectedMin, expectedMax);
+    if (minHeight != expectedMin || maxHeight != expectedMax) {
+      ++result.removeMismatches;
+    }
+  }
+  return result;
+}
+
+}
+
+std::vector<CraterBenchmarkResult> BenchmarkCraters(int craters) {
+  return { CarveCraters(craters, 0), CarveCraters(craters, 7) };
+}
+
+
+namespace {
+
+/** A gravity well of the gravity benchmarks
+ */
+struct GravityWell {
+  Vector position;
+  float mass;
+};
+
+// A planet and two moons (1.5e15 kg pull with 10 m/s^2 at 100 m)
+const GravityWell GRAVITY_WELLS[] = { { Vector(1000, 1000), 1.5e15f }, { Vector(2200, 800), 4e14f }, { Vector(600, 2100), 4e14f } };
+
+/** A body in a circular orbit around a random well of GRAVITY_WELLS
+ */
+struct OrbitingBody {
+  Vector position;
+  Vector velocity; // m/s
+  float mass;
+};
+
+/** Places the bodies (asteroids, debris and satellites) in circular orbits 40 to 400 px around the wells, more of them around the larger wells
+ */
+std::vector<OrbitingBody> OrbitingBodies(int count, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> wellChoice(0, 1), radii(40, 400), angles(0, 2 * Vector::PI), masses(1e8f, 1e10f);
+  std::vector<OrbitingBody> bodies(count);
+  for (auto& body : bodies) {
+    const float choice = wellChoice(random);
+    const GravityWell& well = GRAVITY_WELLS[choice < 0.6f ? 0 : choice < 0.8f ? 1 : 2];
+    const float radius = radii(random);
+    const float angle = angles(random);
+    const Vector direction(std::cos(angle), std::sin(angle));
+    const float speed = std::sqrt(GravitySolver::G * well.mass / (radius / PhysicsObject::PIXEL_PER_METER)); // v = sqrt(GM/r)
+    body.position = well.position + direction * radius;
+    body.velocity = Vector(-direction.y, direction.x) * speed;
+    body.mass = masses(random);
+  }
+  return bodies;
+}
+
+/** Sums up the gravity of all other points for the given points like GravitySolver::Solve() without the tree
+ */
+void DirectGravity(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& mass, float softening,
+                   const std::vector<size_t>& targets, std::vector<float>& accelerationX, std::vector<float>& accelerationY) {
+  const float massScale = GravitySolver::G * PhysicsObject::PIXEL_PER_METER * PhysicsObject::PIXEL_PER_METER;
+  const float softening2 = softening * softening;
+  for (size_t t = 0; t < targets.size(); ++t) {
+    const size_t target = targets[t];
+    float sumX = 0, sumY = 0;
+    for (size_t j = 0; j < x.size(); ++j) {
+      if (j != target) {
+        const float dx = x[j] - x[target];
+        const float dy = y[j] - y[target];
+        const float r2 = dx * dx + dy * dy + softening2;
+        const float strength = mass[j] * massScale / (r2 * std::sqrt(r2));
+        sumX += dx * strength;
+        sumY += dy * strength;
+      }
+    }
+    accelerationX[t] = sumX;
+    accelerationY[t] = sumY;
+  }
+}
+
+}
+
+std::vector<GravityBenchmarkResult> BenchmarkGravity(int bodies) {
+  using clock = std::chrono::steady_clock;
+  const size_t MAX_DIRECT_TARGETS = 1000;
+  std::vector<GravityBenchmarkResult> results;
+  for (int count : { bodies / 100, bodies / 10, bodies }) {
+    if (count < 2) {
+      continue;
+    }
+    // The wells are points as well, the bodies don't need velocities for a single pass
+    std::vector<float> x, y, mass;
+    for (auto& body : OrbitingBodies(count, 42)) {
+      x.push_back(body.position.x);
+      y.push_back(body.position.y);
+      mass.push_back(body.mass);
+    }
+    for (auto& well : GRAVITY_WELLS) {
+      x.push_back(well.position.x);
+      y.push_back(well.position.y);
+      mass.push_back(well.mass);
+    }
+
+    // The direct sum of evenly spread bodies
+    std::vector<size_t> targets;
+    const size_t step = std::max<size_t>(count / MAX_DIRECT_TARGETS, 1);
+    for (size_t i = 0; i < static_cast<size_t>(count) && targets.size() < MAX_DIRECT_TARGETS; i += step) {
+      targets.push_back(i);
+    }
+    std::vector<float> directX(targets.size()), directY(targets.size());
+    GravitySolver solver;
+    auto start = clock::now();
+    DirectGravity(x, y, mass, solver.softening, targets, directX, directY);
+    const double directSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::vector<float> accelerationX(x.size()), accelerationY(x.size());
+    for (float openingAngle : { 0.3f, 0.5f, 0.8f }) {
+      GravityBenchmarkResult result;
+      result.bodies = count;
+      result.openingAngle = openingAngle;
+      solver.openingAngle = openingAngle;
+      solver.Solve(x.data(), y.data(), mass.data(), x.size(), accelerationX.data(), accelerationY.data()); // warm up the buffers
+
+      // Repeat small passes for at least 0.2 s
+      int passes = 0;
+      clock::duration elapsed(0);
+      do {
+        start = clock::now();
+        solver.Solve(x.data(), y.data(), mass.data(), x.size(), accelerationX.data(), accelerationY.data());
+        elapsed += clock::now() - start;
+        ++passes;
+      } while (elapsed < std::chrono::milliseconds(200));
+      const double passSeconds = std::chrono::duration<double>(elapsed).count() / passes;
+
+      result.nodes = solver.NodeCount();
+      result.interactionsPerBody = static_cast<double>(solver.InteractionCount()) / x.size();
+      result.passMillis = passSeconds * 1000;
+      result.forcesPerSecond = count / passSeconds;
+      result.directForcesPerSecond = targets.size() / directSeconds;
+      double squaredErrors = 0;
+      for (size_t t = 0; t < targets.size(); ++t) {
+        const Vector exact(directX[t], directY[t]);
+        const double error = (Vector(accelerationX[targets[t]], accelerationY[targets[t]]) - exact).Length() / std::max(exact.Length(), 1e-20f);
+        squaredErrors += error * error;
+        result.maxError = std::max(result.maxError, error);
+      }
+      result.rmsError = std::sqrt(squaredErrors / targets.size());
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+GravityFieldResult SimulateGravityField(int bodies) {
+  GravityFieldResult result;
+  result.wells = static_cast<int>(std::size(GRAVITY_WELLS));
+  result.bodies = bodies;
+  result.ticks = static_cast<int>(10 / World::SECONDS_PER_TICK);
+
+  // The objects are declared before the world to outlive it
+  std::vector<std::unique_ptr<RigidBody>> rigidBodies;
+  World world;
+  world.SetInput(std::make_unique<KeyboardInput>());
+  for (auto& well : GRAVITY_WELLS) {
+    world.GetGravitySolver().AddWell(well.position, well.mass);
+  }
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> sizes(2, 8);
+  for (auto& orbit : OrbitingBodies(bodies, 7)) {
+    rigidBodies.push_back(std::make_unique<RigidBody>(Size(sizes(random), sizes(random)), orbit.mass, 0.3f, 0.5f));
+    RigidBody& body = *rigidBodies.back();
+    body.gravity = false; // only the wells and the other bodies attract it
+    body.pos = orbit.position - body.Center();
+    body.velocity = orbit.velocity;
+    world.AddObject(body);
+    world.GetGravitySolver().Add(body);
+  }
+  world.Initialize(Size(3000, 3000));
+
+  using clock = std::chrono::steady_clock;
+  size_t contacts = 0;
+  auto start = clock::now();
+  for (int tick = 0; tick < result.ticks; ++tick) {
+    world.Tick();
+    contacts += world.GetContactSolver().ContactCount();
+  }
+  result.microsPerTick = std::chrono::duration<double, std::micro>(clock::now() - start).count() / result.ticks;
+  result.averageContacts = static_cast<double>(contacts) / result.ticks;
+
+  for (auto& body : rigidBodies) {
+    const Vector center = body->pos + body->Center();
+    for (auto& well : GRAVITY_WELLS) {
+      if ((center - well.position).Length() < 800) {
+        ++result.boundBodies;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+void ExportLevel(const std::filesystem::path& file, Size levelSize, bool heights, uint32_t windSeed) {
+  LevelFile::Header header = LevelFile::DefaultHeader();
+  header.windSeed = windSeed;
+  if (!heights) {
+    LevelFile::Write(file, header);
+    return;
+  }
+
+  Terrain terrain;
+  terrain.Initialize(levelSize);
+  std::vector<float> samples(static_cast<size_t>(3 * levelSize.width) + 1);
+  terrain.GetTerrainHeights(-levelSize.width, 1, samples.size(), samples.data());
+  header.terrainKind = static_cast<uint32_t>(LevelFile::TerrainKind::Heights);
+  header.heightSpacing = 1;
+  header.firstHeightX = -levelSize.width;
+  header.heightCount = static_cast<uint32_t>(samples.size());
+  LevelFile::Write(file, header, samples.data());
+}
+
+LevelFileBenchmarkResult BenchmarkLevelFile(const std::filesystem::path& file, Size levelSize, int opens) {
+  using clock = std::chrono::steady_clock;
+  LevelFileBenchmarkResult result;
+  try {
+    result.opens = opens;
+    const auto start = clock::now();
+    for (int i = 0; i < opens; ++i) {
+      LevelFile level(file);
+    }
+    result.openMicros = std::chrono::duration<double, std::micro>(clock::now() - start).count() / opens;
+
+    const LevelFile level(file);
+    result.builds = std::min(opens, 1000);
+    const auto buildStart = clock::now();
+    for (int i = 0; i < result.builds; ++i) {
+      Simulation simulation(std::make_unique<KeyboardInput>(), levelSize, level);
+    }
+    result.buildMicros = std::chrono::duration<double, std::micro>(clock::now() - buildStart).count() / result.builds;
+  } catch (std::exception& e) {
+    result.error = e.what();
+  }
+  return result;
+}
+
+
+std::vector<std::filesystem::path> CollectReplays(const std::filesystem::path& path) {
+  std::vector<std::filesystem::path> files;
+
+  if (std::filesystem::is_directory(path)) {
+    for (auto& entry : std::filesystem::directory_iterator(path)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".sav") {
+        files.push_back(entry.path());
+      }
+    }
+    std::sort(files.begin(), files.end()); // directory order is unspecified
+  } else if (path.extension() == ".sav") {
+    files.push_back(path);
+  } else {
+    std::ifstream listFile(path);
+    if (!listFile) {
+      throw std::runtime_error("Failed to open " + path.string());
+    }
+
+    std::string line;
+    while (std::getline(listFile, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      if (!line.empty()) {
+        files.push_back(line);
+      }
+    }
+  }
+
+  return files;
+}
+
+}
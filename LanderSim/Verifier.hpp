@@ -0,0 +1,437 @@
+#pragma once
+
+#include "Rocket.hpp"
+#include "Terrain.hpp"
+#include "LevelFile.hpp"
+
+#include <chrono>
+
+namespace Lander {
+
+/** The outcome of simulating a single replay
+ */
+struct VerificationResult {
+  std::string file;
+  std::string error; // empty if the replay could be simulated
+
+  Rocket::STATE state = Rocket::STATE::UNSTARTED;
+  int ticks = 0;           // the tick, in which the simulation finished
+  float peakVelocity = 0;  // m/s
+  float fuelLeft = 0;      // 0-1
+  double simulationMillis = 0; // wall clock time it took to simulate the replay
+};
+
+/** Returns the name of the given rocket state as printed by lander-sim
+ */
+const char* OutcomeName(Rocket::STATE state);
+
+/** Simulates the given replay file headless in its own world.
+ */
+VerificationResult VerifyReplay(const std::filesystem::path& file, Size levelSize, const LevelFile& level = LevelFile::BuiltIn());
+
+/** Simulates all given replay files concurrently. Each worker thread simulates one replay at a time in its own world,
+ *  so no state is shared between the workers.
+ *
+ * @param jobs the number of worker threads (0 = one per hardware thread)
+ * @return the results in the same order as files
+ */
+std::vector<VerificationResult> VerifyReplays(const std::vector<std::filesystem::path>& files, Size levelSize, unsigned jobs = 0,
+                                              const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of simulating a replay with every tick on its own and with adaptive ticks (see Simulation::SetMaxTicksPerStep())
+ */
+struct AdaptiveResult {
+  std::string error; // empty if the replay could be simulated
+  VerificationResult fixed;
+  VerificationResult adaptive;
+  int adaptiveSteps = 0;    // number of Simulation::Tick() calls with adaptive ticks
+  float positionError = 0;  // px between the rocket's final positions
+};
+
+/** Simulates the given replay with every tick on its own and with up to the given number of ticks at once and compares the results.
+ *  Both are simulated several times and the fastest time is reported.
+ */
+AdaptiveResult VerifyAdaptive(const std::filesystem::path& file, Size levelSize, int maxTicksPerStep, const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of replaying a recording with the scalar Rocket and the RocketBatch kernel side by side
+ */
+struct LockstepResult {
+  std::string error; // empty if the replay could be simulated
+
+  size_t lanes = 0;
+  int comparedTicks = 0;   // ticks, in which the rocket was flying and all lanes have been compared
+  int mismatchedTicks = 0; // ticks, in which at least one lane differed from the rocket
+  double laneTicksPerSecond = 0;              // kernel throughput including collision checks
+  double laneTicksPerSecondNoCollisions = 0;  // kernel throughput of the pure flight physics
+  double laneTicksPerSecondNoRotation = 0;    // same without rotation, so no thrust vector has to be rotated (the flight kernel itself)
+};
+
+/** Replays the given file with the scalar Rocket and feeds the same inputs into all lanes of a RocketBatch, while the rocket
+ *  is flying. After each tick every lane is compared bit for bit with the rocket. Afterwards the recorded inputs are played
+ *  back again through a RocketBatch without collision checks to measure the kernel's raw throughput, once more without rotation
+ *  (no roll inputs and no angular velocity) to measure the flight kernel alone.
+ */
+LockstepResult VerifyLockstep(const std::filesystem::path& file, Size levelSize, size_t lanes, const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of replaying a recording with wind (see WindField)
+ */
+struct WindResult {
+  std::string error; // empty if the replay could be simulated
+
+  VerificationResult calm;   // the replay as recorded
+  VerificationResult windy;  // the same inputs with the wind
+  bool deterministic = false; // simulating the replay with the wind again ended in the bit-identical state
+  LockstepResult lockstep;   // the replay with the wind in the RocketBatch lanes
+  double calmLaneTicksPerSecond = 0; // kernel throughput of the replay as recorded
+  double sampleNanos = 0;    // time of a single WindField::At()
+};
+
+/** Writes the inputs of the given replay into a temporary replay with the wind of the given seed, simulates it twice and checks
+ *  that both runs end identically, replays it with the scalar rocket and the given number of RocketBatch lanes side by side
+ *  (see VerifyLockstep()) and measures the time to sample the wind field.
+ */
+WindResult VerifyWind(const std::filesystem::path& file, Size levelSize, uint32_t seed, size_t lanes, const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of checking snapshots of a replay
+ */
+struct SnapshotResult {
+  std::string error; // empty if the replay could be simulated
+
+  int snapshots = 0;        // number of snapshots taken (one per tick)
+  int checkedSnapshots = 0; // number of snapshots, from which the replay has been re-simulated to its end
+  int mismatches = 0;       // re-simulations, which didn't end in the same state as the original run
+  double takeNanos = 0;     // average time to take a snapshot
+  double restoreNanos = 0;  // average time to restore a snapshot
+};
+
+/** Simulates the given replay while taking a snapshot of the simulation on every tick. Afterwards a sample of the
+ *  snapshots is restored in random order and the replay is re-simulated from there to check that it always ends in
+ *  exactly the same state.
+ *
+ * @param samples how many snapshots to re-simulate from
+ */
+SnapshotResult VerifySnapshots(const std::filesystem::path& file, Size levelSize, int samples, const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of seeking in a replay
+ */
+struct SeekResult {
+  std::string error; // empty if the replay could be simulated
+
+  int ticks = 0;          // length of the replay
+  int seeks = 0;
+  int mismatches = 0;     // seeks, which didn't end up in the same state as simulating the replay from the start
+  double indexMillis = 0; // time it took to create the ReplayIndex
+  double averageSeekMicros = 0;
+  double maxSeekMicros = 0;
+};
+
+/** Creates a ReplayIndex for the given replay, jumps to random ticks and compares the resulting state with the state
+ *  of simulating the replay tick by tick from the start.
+ */
+SeekResult VerifySeeking(const std::filesystem::path& file, Size levelSize, int seeks, int interval, const LevelFile& level = LevelFile::BuiltIn());
+
+/** The outcome of playing a replay on the SimulationThread
+ */
+struct ThreadedResult {
+  std::string error; // empty if the replay could be simulated
+
+  bool identical = false; // true if the last frame shows the same outcome as VerifyReplay()
+  int frames = 0;         // number of frames the reader consumed
+  int ticks = 0;          // tick of the last frame
+  double seconds = 0;     // wall clock time of the playback
+  double clockSeconds = 0; // time of the game's clock at the end of the playback (since its epoch)
+};
+
+/** The clocks the threaded playback can run on (see Clock)
+ */
+enum class ClockType { REAL, FIXED, FAST };
+
+/** The step of the FixedStepClock per frame of the threaded playback (60 frames per second)
+ */
+constexpr std::chrono::nanoseconds FRAME_STEP = std::chrono::microseconds(16667);
+
+/** Plays the given replay on a SimulationThread with the given replay speed and clock, consumes its frames like the game's
+ *  render loop and checks that the replay ends with the same outcome as when simulating it with VerifyReplay().
+ */
+ThreadedResult VerifyThreaded(const std::filesystem::path& file, Size levelSize, int replaySpeedExponent, ClockType clockType = ClockType::REAL,
+                              const LevelFile& level = LevelFile::BuiltIn());
+
+/** Speed and accuracy of one DeterministicMath function compared with the platform's libm
+ */
+struct MathBenchmarkResult {
+  std::string function;
+  double libmNanos = 0;          // average time per call of the libm function
+  double deterministicNanos = 0; // average time per call of the DeterministicMath function
+  double maxUlps = 0;            // largest difference to libm in units in the last place
+  double differentResults = 0;   // fraction of the arguments, for which the results aren't bit-identical to libm
+};
+
+/** Calls the DeterministicMath functions and their libm counterparts with the given number of arguments in the ranges the
+ *  simulation uses (rotations and the terrain's curves for sine and cosine) and compares their speed and results.
+ */
+std::vector<MathBenchmarkResult> BenchmarkMath(int samples);
+
+/** Speed of one vector operation with the old out-of-line Vector (see LegacyVector.hpp) and the header-only one
+ */
+struct VectorBenchmarkResult {
+  std::string operation;
+  double legacyNanos = 0; // average time per point with the out-of-line Vector
+  double inlineNanos = 0; // average time per point with the header-only Vector
+  double batchNanos = 0;  // average time per point with the batch function (0 if there is none)
+  bool identical = false; // whether all variants produced bit-identical results
+};
+
+/** Runs the vector operations of the physics and collision code (arithmetic, rotating and transforming points) on the
+ *  given number of random points with the old and the new Vector and the batch functions, and compares their speed and results.
+ */
+std::vector<VectorBenchmarkResult> BenchmarkVectors(int points);
+
+/** Speed of the collision checks of many moving colliders with the Broadphase compared with checking every collider
+ */
+struct BroadphaseBenchmarkResult {
+  int ticks = 0;                // ticks simulated with the broadphase
+  double broadphaseMillis = 0;  // average time per tick with the broadphase
+  int bruteForceTicks = 0;      // ticks simulated with checking every collider (fewer for many colliders)
+  double bruteForceMillis = 0;  // average time per tick checking every collider
+  double averageCandidates = 0; // average number of other colliders the broadphase returned per query
+  size_t candidatePairs = 0;    // number of pairs returned by Broadphase::CandidatePairs() after the last tick
+  double candidatePairsMillis = 0;
+  bool identical = false;       // whether both ran the same collisions in the same order during the brute force ticks
+};
+
+/** Simulates the given number of small boxes, which move through a field and check for collisions on every tick,
+ *  once with the world's broadphase and once checking every collider, and compares their speed and collisions.
+ */
+BroadphaseBenchmarkResult BenchmarkBroadphase(int colliders, int ticks);
+
+/** Accuracy and speed of the separating axis test (see OrientedBox::Collide()) compared with the former narrowphase, which
+ *  tested 8 points of one rectangle to be inside the other
+ */
+struct NarrowphaseBenchmarkResult {
+  int pairs = 0;
+  int overlapping = 0;        // pairs, which overlap according to an exact polygon intersection test
+  int separatingAxisHits = 0; // pairs, which overlap according to the separating axis test
+  int pointTestHits = 0;      // pairs, which overlap according to the 8 point test
+  int separatingAxisWrong = 0; // pairs, for which the separating axis test differs from the polygon intersection test
+  int invalidContacts = 0;    // contacts without a unit normal, with a negative depth or with points deeper than the depth outside of a rectangle
+  double separatingAxisNanos = 0; // average time per pair
+  double pointTestNanos = 0;
+};
+
+/** Tests the given number of random pairs of rotated rectangles (including thin ones like the platforms) for overlap
+ */
+NarrowphaseBenchmarkResult BenchmarkNarrowphase(int pairs);
+
+/** Touchdown times of boxes falling onto a platform, checked at the end of each tick like before (discrete) and along
+ *  their movement (swept, see Collider::CheckCollisions(const Motion&)), compared with the exact time of impact
+ */
+struct SweepBenchmarkResult {
+  int millisPerTick = 0;
+  int drops = 0;
+  int discreteTunneled = 0;      // drops, which passed through the platform without a collision
+  int sweptTunneled = 0;
+  double discreteMeanError = 0;  // average difference between the detected and the exact time of impact (ms)
+  double discreteMaxError = 0;
+  double sweptMeanError = 0;
+  double sweptMaxError = 0;
+  double discreteNanos = 0;      // average time per tick including the collision check
+  double sweptNanos = 0;
+};
+
+/** Drops the given number of boxes with random heights and speeds (up to 800 m/s) onto a platform with 5, 20 and 50 ms ticks
+ */
+std::vector<SweepBenchmarkResult> BenchmarkSweep(int drops);
+
+/** Accuracy and speed of the sampled terrain (see Terrain::GetTerrainHeight()) compared with the exact terrain profile
+ */
+struct TerrainBenchmarkResult {
+  Terrain::Interpolation interpolation = Terrain::Interpolation::Linear;
+  float sampleSpacing = 0;
+  double meanHeightError = 0; // px
+  double maxHeightError = 0;
+  double meanSlopeError = 0;  // px per px
+  double maxSlopeError = 0;
+  double exactNanos = 0;      // average time per height of the exact profile
+  double sampledNanos = 0;    // average time per height of GetTerrainHeight()
+  double batchNanos = 0;      // average time per height of GetTerrainHeights()
+  double slopeNanos = 0;      // average time per slope of GetTerrainSlope()
+  bool batchIdentical = false; // whether GetTerrainHeights() returns the same heights as GetTerrainHeight()
+};
+
+/** Queries the given number of random positions of the terrain with linear and cubic interpolation and several sample spacings
+ */
+std::vector<TerrainBenchmarkResult> BenchmarkTerrain(int queries);
+
+/** Results of the terrain's segment and box queries (see Terrain::IntersectSegment() and Terrain::SweepBox()) compared with
+ *  stepping along the segment or the displacement in small steps and checking the heights
+ */
+struct RaycastBenchmarkResult {
+  int segments = 0;
+  int segmentHits = 0;
+  int segmentMismatches = 0; // hits, which aren't on the surface or come after the first stepped point below it, or missing hits
+  double segmentMaxDistance = 0; // px between the hit and the first stepped point below the surface
+  double segmentTreeNanos = 0;    // average time per segment
+  double segmentSteppedNanos = 0;
+  int boxes = 0;
+  int boxHits = 0;
+  int boxMismatches = 0;
+  double boxMaxDistance = 0;
+  double boxTreeNanos = 0;
+  double boxSteppedNanos = 0;
+};
+
+/** Casts the given number of random segments (up to 600 px) and a twentieth as many random boxes (up to 400 px) against the terrain
+ */
+RaycastBenchmarkResult BenchmarkRaycast(int queries);
+
+/** Accuracy and cost of an integrator (see PhysicsObject::integrator) for a given tick duration
+ */
+struct IntegratorBenchmarkResult {
+  std::string error; // empty if the rocket stayed in the air during the whole flight
+  Integrator integrator = Integrator::AverageVelocity;
+  int tickMicros = 0;
+  double maxPositionError = 0; // m, compared with the reference every 0.5 s
+  double maxVelocityError = 0; // m/s
+  double microsPerSecond = 0;  // CPU time of the rocket's updates per simulated second
+};
+
+/** Flies the rocket with full thrust and a few rolls for 6 s with every integrator and tick durations from 5 to 50 ms and compares it with
+ *  a double precision Runge-Kutta integration of the same forces with 10 us steps. The flights are repeated the given number of times to measure the time.
+ */
+std::vector<IntegratorBenchmarkResult> BenchmarkIntegrators(int repetitions);
+
+/** Returns the name of the integrator's enumerator
+ */
+const char* IntegratorName(Integrator integrator);
+
+/** Results of a scenario of the ContactSolver
+ */
+struct ContactBenchmarkResult {
+  std::string scenario;
+  bool warmStarting = false;
+  int bodies = 0;
+  bool analytic = true;       // whether the scenario has an exact result (measured and expected are set)
+  double measured = 0;        // bounce: rebound / impact speed, slope: acceleration along the slope (m/s^2)
+  double expected = 0;        // the restitution or the acceleration with Coulomb friction
+  double maxRestingSpeed = 0; // m/s of the fastest body during the last second
+  double maxDepth = 0;        // px of the deepest penetration at the end
+  double averageContacts = 0; // per tick
+  double warmStartedShare = 0; // of the contacts, which started with the impulses of the last tick
+  double microsPerTick = 0;
+};
+
+/** Bounces a box off the ground, puts boxes with a low and a high friction on a ramp and lets the given number of boxes
+ *  settle in a container, with and without warm starting
+ */
+std::vector<ContactBenchmarkResult> BenchmarkContacts(int bodies);
+
+/** A flight along a seeded terrain, which streams its chunks (see Terrain and TerrainChunkCache)
+ */
+struct StreamingBenchmarkResult {
+  float speed = 0;                  // px per tick
+  int ticks = 0;
+  uint64_t queries = 0;
+  uint64_t missingChunkQueries = 0; // queries, which calculated their samples, because the chunk hadn't been generated yet
+  int mismatches = 0;               // ticks, whose query results differ from a terrain, which waited for every chunk
+  size_t maxCachedChunks = 0;       // the most chunks cached at once
+  size_t capacity = 0;
+  uint64_t generatedChunks = 0;
+  uint64_t evictedChunks = 0;
+  double averageTickMicros = 0;     // time of the terrain queries per tick
+  double maxTickMicros = 0;
+  double generateMicros = 0;        // time to generate one chunk, which a tick would wait for without the background thread
+  double maxSeamStep = 0;           // px, the largest height change between neighbouring pixels across a chunk seam
+  double maxStep = 0;               // px, the same anywhere else
+};
+
+/** Flies a box across the given number of chunks of a seeded terrain at several speeds, querying heights, the slope, the clearance,
+ *  a ray and a sweep each tick like the simulation does
+ */
+std::vector<StreamingBenchmarkResult> BenchmarkStreaming(int chunks);
+
+/** Craters carved into a terrain (see Terrain::AddCrater())
+ */
+struct CraterBenchmarkResult {
+  uint64_t seed = 0;
+  int craters = 0;
+  double carveMicros = 0;       // average time to carve a crater
+  double maxCarveMicros = 0;
+  int columnMismatches = 0;     // frames, whose kept columns differ from calculating all columns
+  double frameMicrosBefore = 0; // time of the columns of a scrolling frame without craters
+  double frameMicrosAfter = 0;  // the same with all craters
+  double fullFrameMicros = 0;   // time to calculate all columns of a frame with all craters (without keeping them)
+  double queryNanosBefore = 0;  // time of a segment query without craters
+  double queryNanosAfter = 0;
+  int queryMismatches = 0;      // segments and boxes, whose hits don't match stepping along them, with all craters
+  int removeMismatches = 0;     // px and ranges, whose heights differ from the terrain without craters after removing all craters
+};
+
+/** Carves the given number of random craters into the classic and a seeded terrain, drawing a scrolling frame after each one,
+ *  and compares the queries and frames with and without the craters
+ */
+std::vector<CraterBenchmarkResult> BenchmarkCraters(int craters);
+
+/** A pass of the GravitySolver over bodies around a few gravity wells
+ */
+struct GravityBenchmarkResult {
+  int bodies = 0;
+  float openingAngle = 0;
+  size_t nodes = 0;
+  double interactionsPerBody = 0;
+  double passMillis = 0;            // time to build the tree and calculate the accelerations of all bodies
+  double forcesPerSecond = 0;       // accelerations of bodies per second
+  double directForcesPerSecond = 0; // the same by summing up all other bodies (O(n^2)), measured for up to 1000 of the bodies
+  double rmsError = 0;              // relative to the direct sum, of the same bodies
+  double maxError = 0;
+};
+
+/** Free bodies orbiting gravity wells in a world, which attract each other and collide (see World::GetGravitySolver())
+ */
+struct GravityFieldResult {
+  int wells = 0;
+  int bodies = 0;
+  int ticks = 0;
+  double microsPerTick = 0;
+  double averageContacts = 0; // per tick
+  int boundBodies = 0;        // bodies, which are still close to a well at the end
+};
+
+/** Calculates the gravity of a tenth, a hundredth and all of the given number of bodies with several opening angles and compares
+ *  the speed and the accelerations with the direct sum
+ */
+std::vector<GravityBenchmarkResult> BenchmarkGravity(int bodies);
+
+/** Lets the given number of bodies orbit three gravity wells in a world for 10 s
+ */
+GravityFieldResult SimulateGravityField(int bodies);
+
+/** Writes the built-in level as level file
+ *
+ * @param heights whether to store the terrain as heights (every px from -width to 2*width) instead of its profile
+ * @param windSeed the seed of the level's wind (0 for no atmosphere, see WindField)
+ * @throws std::runtime_error if the file can't be written
+ */
+void ExportLevel(const std::filesystem::path& file, Size levelSize, bool heights, uint32_t windSeed = 0);
+
+/** Time to open a level file and to build a level from it
+ */
+struct LevelFileBenchmarkResult {
+  std::string error; // empty if the level file could be opened
+  int opens = 0;
+  double openMicros = 0;  // average time to map the file and check it
+  int builds = 0;
+  double buildMicros = 0; // average time to build the level from the opened file and initialize its world
+};
+
+/** Opens the level file the given number of times and builds the level from it up to 1000 times
+ */
+LevelFileBenchmarkResult BenchmarkLevelFile(const std::filesystem::path& file, Size levelSize, int opens);
+
+/** Collects the replays to verify from the given path. Directories are searched for .sav files (not recursively),
+ *  .sav files are returned as is and any other file is read as a list file containing one replay path per line.
+ *
+ * @throws std::runtime_error if the path doesn't exist
+ */
+std::vector<std::filesystem::path> CollectReplays(const std::filesystem::path& path);
+
+}
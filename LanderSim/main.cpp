@@ -0,0 +1,676 @@
+#include "stdafx.h"
+#include "Verifier.hpp"
+#include "Simulation.hpp"
+#include "ReplayIndex.hpp"
+#include "RocketBatch.hpp"
+#include "World.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+using namespace Lander;
+
+namespace {
+
+const size_t WIND_LANES = 16; // RocketBatch lanes of --wind
+
+void PrintUsage() {
+  std::cerr << "Usage: lander-sim [--size <width>x<height>] [--level <file.lvl>] <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] [--jobs <n>] [--output <results.csv>] --batch <saves dir|list file>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] --lockstep <lanes> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] --wind <seed> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] --snapshots <samples> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] --adaptive <max ticks per step> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] [--interval <ticks>] --seek <seeks> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--level <file.lvl>] [--clock real|fixed|fast] --threaded <speed exponent> <replay.sav>..." << std::endl;
+  std::cerr << "       lander-sim --math <samples>" << std::endl;
+  std::cerr << "       lander-sim --vectors <points>" << std::endl;
+  std::cerr << "       lander-sim [--ticks <ticks>] --broadphase <colliders>" << std::endl;
+  std::cerr << "       lander-sim --narrowphase <pairs>" << std::endl;
+  std::cerr << "       lander-sim --sweep <drops>" << std::endl;
+  std::cerr << "       lander-sim --terrain <queries>" << std::endl;
+  std::cerr << "       lander-sim --raycast <queries>" << std::endl;
+  std::cerr << "       lander-sim --integrators <repetitions>" << std::endl;
+  std::cerr << "       lander-sim --contacts <bodies>" << std::endl;
+  std::cerr << "       lander-sim --streaming <chunks>" << std::endl;
+  std::cerr << "       lander-sim --craters <craters>" << std::endl;
+  std::cerr << "       lander-sim --gravity <bodies>" << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] [--wind <seed>] --export-level <file.lvl> | --export-heights <file.lvl>" << std::endl;
+  std::cerr << "       lander-sim [--size <width>x<height>] --level <file.lvl> --open-level <opens>" << std::endl;
+  std::cerr << "  Simulates each replay without a window as fast as possible and prints the outcome." << std::endl;
+  std::cerr << "  --size    size of the game field the replays were recorded with (default: "
+            << World::WINDOW_WIDTH << "x" << World::WINDOW_HEIGHT << ")" << std::endl;
+  std::cerr << "  --batch   simulate all .sav files of the given directories/list files concurrently and write one CSV row per file" << std::endl;
+  std::cerr << "  --jobs    number of worker threads for --batch (default: one per hardware thread)" << std::endl;
+  std::cerr << "  --level   simulate the replays in the level of the given level file instead of the built-in level" << std::endl;
+  std::cerr << "  --lockstep  replay each file with the scalar rocket and the given number of RocketBatch lanes side by side," << std::endl;
+  std::cerr << "              check that all lanes stay bit-identical to the rocket and measure the kernel's throughput" << std::endl;
+  std::cerr << "  --wind      replay each file with the wind of the given seed (1 to 4294967295), check that it is deterministic and" << std::endl;
+  std::cerr << "              that " << WIND_LANES << " RocketBatch lanes stay bit-identical to the rocket and measure the time of a wind sample." << std::endl;
+  std::cerr << "              With --export-level/--export-heights: the wind of the written level" << std::endl;
+  std::cerr << "  --snapshots take a snapshot of the simulation on every tick, re-simulate each replay from the given number of" << std::endl;
+  std::cerr << "              randomly picked snapshots, check that it always ends in the same state and measure snapshot/restore times" << std::endl;
+  std::cerr << "  --adaptive  simulate each replay with every tick on its own and with up to the given number of ticks at once while" << std::endl;
+  std::cerr << "              the rocket is far from the colliders and compare the outcomes and times" << std::endl;
+  std::cerr << "  --seek      index each replay with keyframes, jump to the given number of random ticks and compare the state" << std::endl;
+  std::cerr << "              with simulating the replay from the start" << std::endl;
+  std::cerr << "  --interval  number of ticks between two keyframes for --seek (default: " << ReplayIndex::DEFAULT_INTERVAL << ")" << std::endl;
+  std::cerr << "  --threaded  play each replay in real time on the simulation thread with a replay speed of 2^exponent (-3 to 6)" << std::endl;
+  std::cerr << "              and check that the published frames end with the same outcome" << std::endl;
+  std::cerr << "  --clock     the clock of --threaded: real time (default), a fixed step of 1/60 s per frame or as fast as possible" << std::endl;
+  std::cerr << "  --math      compare speed and results of the deterministic math functions with libm for the given number of arguments" << std::endl;
+  std::cerr << "  --vectors   compare speed and results of the header-only vector math and its batch functions with the old" << std::endl;
+  std::cerr << "              out-of-line vector math for the given number of points" << std::endl;
+  std::cerr << "  --broadphase  simulate the given number of moving colliders, which check for collisions on every tick, with the" << std::endl;
+  std::cerr << "                broadphase and by checking every collider and compare their speed and collisions" << std::endl;
+  std::cerr << "  --ticks     number of ticks for --broadphase (default: 200, one second)" << std::endl;
+  std::cerr << "  --narrowphase  test the given number of random pairs of rotated rectangles with the separating axis test and" << std::endl;
+  std::cerr << "                 the former 8 point test and compare both with an exact polygon intersection" << std::endl;
+  std::cerr << "  --sweep     drop the given number of fast boxes onto a platform with 5, 20 and 50 ms ticks and compare the" << std::endl;
+  std::cerr << "              detected touchdowns of checking the end of each tick and checking the movement with the exact ones" << std::endl;
+  std::cerr << "  --terrain   compare the heights and slopes of the sampled terrain with the exact terrain profile at the given" << std::endl;
+  std::cerr << "              number of random positions for linear and cubic interpolation and several sample spacings" << std::endl;
+  std::cerr << "  --raycast   intersect the given number of random segments and a twentieth as many moving boxes with the terrain" << std::endl;
+  std::cerr << "              and compare the hits with stepping along them" << std::endl;
+  std::cerr << "  --integrators  fly the rocket with every integrator and tick durations from 5 to 50 ms, compare it with a high" << std::endl;
+  std::cerr << "                 resolution reference and measure the time of the given number of repeated flights" << std::endl;
+  std::cerr << "  --contacts  bounce a box off the ground, put boxes on a ramp and let the given number of boxes settle in a pile" << std::endl;
+  std::cerr << "              with the contact solver with and without warm starting" << std::endl;
+  std::cerr << "  --streaming  fly across the given number of chunks of a seeded terrain at several speeds, compare the queries with" << std::endl;
+  std::cerr << "               a terrain, which waited for every chunk, and report the cached chunks and the time per tick" << std::endl;
+  std::cerr << "  --craters  carve the given number of random craters into the classic and a seeded terrain, check the kept columns of" << std::endl;
+  std::cerr << "              a scrolling view after each one and compare the frame and query times with and without them" << std::endl;
+  std::cerr << "  --gravity  calculate the gravity of a hundredth, a tenth and all of the given number of bodies around three gravity" << std::endl;
+  std::cerr << "             wells with the Barnes-Hut solver, compare speed and accelerations with the direct sum and let a hundredth" << std::endl;
+  std::cerr << "             of the bodies orbit the wells in a world for 10 s" << std::endl;
+  std::cerr << "  --export-level    write the built-in level as level file" << std::endl;
+  std::cerr << "  --export-heights  write the built-in level as level file, which stores the terrain as heights (one per px)" << std::endl;
+  std::cerr << "  --open-level  open the level file of --level the given number of times and build the level from it and" << std::endl;
+  std::cerr << "                measure the time of both" << std::endl;
+  std::cerr << "  --output  write the CSV rows into the given file instead of stdout" << std::endl;
+}
+
+/** Writes the results as CSV: file,outcome,ticks,peak_velocity,fuel_left,error
+ */
+void WriteCSV(std::ostream& out, const std::vector<VerificationResult>& results) {
+  out << "file,outcome,ticks,peak_velocity,fuel_left,error" << std::endl;
+  out << std::fixed;
+  for (auto& result : results) {
+    out << '"' << result.file << "\",";
+    if (result.error.empty()) {
+      out << OutcomeName(result.state) << ',' << result.ticks << ','
+          << std::setprecision(3) << result.peakVelocity << ',' << std::setprecision(4) << result.fuelLeft << ",\n";
+    } else {
+      out << "ERROR,,,,\"" << result.error << "\"\n";
+    }
+  }
+}
+
+}
+
+
+/** Headless replay verifier, which runs the physics of the game without any window or rendering.
+ */
+int main(int argc, char* argv[]) {
+  Size levelSize(World::WINDOW_WIDTH, World::WINDOW_HEIGHT);
+  std::vector<std::string> paths;
+  bool batch = false;
+  unsigned jobs = 0;
+  size_t lockstepLanes = 0;
+  uint32_t windSeed = 0;
+  int adaptiveTicks = 0;
+  int snapshotSamples = 0;
+  int seeks = 0;
+  int keyframeInterval = ReplayIndex::DEFAULT_INTERVAL;
+  bool threaded = false;
+  int replaySpeedExponent = 0;
+  ClockType clockType = ClockType::REAL;
+  int mathSamples = 0;
+  int vectorPoints = 0;
+  int broadphaseColliders = 0;
+  int narrowphasePairs = 0;
+  int sweepDrops = 0;
+  int terrainQueries = 0;
+  int raycastQueries = 0;
+  int integratorRepetitions = 0;
+  int contactBodies = 0;
+  int streamingChunks = 0;
+  int craterCount = 0;
+  int gravityBodies = 0;
+  int benchmarkTicks = 200;
+  std::string outputFile;
+  std::string levelPath;
+  std::string exportLevelPath;
+  bool exportHeights = false;
+  int levelOpens = 0;
+
+  std::string arg;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      arg = argv[i];
+      bool hasValue = i + 1 < argc;
+      if (arg == "--size" && hasValue) {
+        float width = 0, height = 0;
+        char separator = 0;
+        std::istringstream sizeStream(argv[++i]);
+        if (!(sizeStream >> width >> separator >> height) || separator != 'x') {
+          PrintUsage();
+          return 2;
+        }
+        levelSize = Size(width, height);
+      } else if (arg == "--jobs" && hasValue) {
+        jobs = static_cast<unsigned>(std::stoul(argv[++i]));
+      } else if (arg == "--lockstep" && hasValue) {
+        lockstepLanes = std::stoul(argv[++i]);
+      } else if (arg == "--wind" && hasValue) {
+        windSeed = static_cast<uint32_t>(std::stoul(argv[++i]));
+      } else if (arg == "--adaptive" && hasValue) {
+        adaptiveTicks = std::stoi(argv[++i]);
+      } else if (arg == "--snapshots" && hasValue) {
+        snapshotSamples = std::stoi(argv[++i]);
+      } else if (arg == "--seek" && hasValue) {
+        seeks = std::stoi(argv[++i]);
+      } else if (arg == "--interval" && hasValue) {
+        keyframeInterval = std::max(1, std::stoi(argv[++i]));
+      } else if (arg == "--threaded" && hasValue) {
+        threaded = true;
+        replaySpeedExponent = std::stoi(argv[++i]);
+      } else if (arg == "--clock" && hasValue) {
+        std::string name = argv[++i];
+        if (name == "real") {
+          clockType = ClockType::REAL;
+        } else if (name == "fixed") {
+          clockType = ClockType::FIXED;
+        } else if (name == "fast") {
+          clockType = ClockType::FAST;
+        } else {
+          PrintUsage();
+          return 2;
+        }
+      } else if (arg == "--math" && hasValue) {
+        mathSamples = std::stoi(argv[++i]);
+      } else if (arg == "--vectors" && hasValue) {
+        vectorPoints = std::stoi(argv[++i]);
+      } else if (arg == "--broadphase" && hasValue) {
+        broadphaseColliders = std::stoi(argv[++i]);
+      } else if (arg == "--narrowphase" && hasValue) {
+        narrowphasePairs = std::stoi(argv[++i]);
+      } else if (arg == "--sweep" && hasValue) {
+        sweepDrops = std::stoi(argv[++i]);
+      } else if (arg == "--terrain" && hasValue) {
+        terrainQueries = std::stoi(argv[++i]);
+      } else if (arg == "--raycast" && hasValue) {
+        raycastQueries = std::stoi(argv[++i]);
+      } else if (arg == "--integrators" && hasValue) {
+        integratorRepetitions = std::stoi(argv[++i]);
+      } else if (arg == "--contacts" && hasValue) {
+        contactBodies = std::stoi(argv[++i]);
+      } else if (arg == "--streaming" && hasValue) {
+        streamingChunks = std::stoi(argv[++i]);
+      } else if (arg == "--craters" && hasValue) {
+        craterCount = std::stoi(argv[++i]);
+      } else if (arg == "--gravity" && hasValue) {
+        gravityBodies = std::stoi(argv[++i]);
+      } else if (arg == "--ticks" && hasValue) {
+        benchmarkTicks = std::max(1, std::stoi(argv[++i]));
+      } else if (arg == "--level" && hasValue) {
+        levelPath = argv[++i];
+      } else if ((arg == "--export-level" || arg == "--export-heights") && hasValue) {
+        exportHeights = arg == "--export-heights";
+        exportLevelPath = argv[++i];
+      } else if (arg == "--open-level" && hasValue) {
+        levelOpens = std::stoi(argv[++i]);
+      } else if (arg == "--output" && hasValue) {
+        outputFile = argv[++i];
+      } else if (arg == "--batch") {
+        batch = true;
+      } else if (arg.rfind("--", 0) == 0) {
+        PrintUsage();
+        return 2;
+      } else {
+        paths.push_back(arg);
+      }
+    }
+  } catch (std::logic_error&) { // std::stoi()/std::stoul() throw std::invalid_argument or std::out_of_range
+    std::cerr << "invalid value for " << arg << std::endl;
+    PrintUsage();
+    return 2;
+  }
+
+  // The benchmarks build their own worlds, only the replays and --open-level use the level file
+  const bool benchmark = mathSamples > 0 || vectorPoints > 0 || broadphaseColliders > 0 || narrowphasePairs > 0 || sweepDrops > 0 || terrainQueries > 0
+                      || raycastQueries > 0 || integratorRepetitions > 0 || contactBodies > 0 || streamingChunks > 0 || craterCount > 0
+                      || gravityBodies > 0 || !exportLevelPath.empty();
+  if (benchmark && !levelPath.empty()) {
+    std::cerr << "--level can't be combined with the benchmarks or --export-level/--export-heights" << std::endl;
+    PrintUsage();
+    return 2;
+  }
+
+  if (mathSamples > 0) {
+#ifdef LANDER_DETERMINISTIC_MATH
+    std::cout << "simulation math: deterministic" << std::endl;
+#else
+    std::cout << "simulation math: libm" << std::endl;
+#endif
+    for (auto& result : BenchmarkMath(mathSamples)) {
+      std::cout << std::left << std::setw(16) << result.function << std::right << std::fixed << std::setprecision(2)
+                << ": libm " << result.libmNanos << " ns, deterministic " << result.deterministicNanos << " ns ("
+                << result.deterministicNanos / result.libmNanos << "x), " << std::setprecision(1) << result.differentResults * 100
+                << "% different, max " << std::setprecision(0) << result.maxUlps << " ulp" << std::endl;
+    }
+    return 0;
+  }
+
+  if (vectorPoints > 0) {
+#if defined(LANDER_SIMD_SSE2)
+    std::cout << "batch functions: SSE2" << std::endl;
+#elif defined(LANDER_SIMD_NEON)
+    std::cout << "batch functions: NEON" << std::endl;
+#else
+    std::cout << "batch functions: scalar" << std::endl;
+#endif
+    bool allIdentical = true;
+    for (auto& result : BenchmarkVectors(vectorPoints)) {
+      std::cout << std::left << std::setw(16) << result.operation << std::right << std::fixed << std::setprecision(2)
+                << ": out-of-line " << result.legacyNanos << " ns, inline " << result.inlineNanos << " ns ("
+                << result.inlineNanos / result.legacyNanos << "x)";
+      if (result.batchNanos > 0) {
+        std::cout << ", batch " << result.batchNanos << " ns (" << result.batchNanos / result.legacyNanos << "x)";
+      }
+      std::cout << ", " << (result.identical ? "bit-identical" : "MISMATCH") << std::endl;
+      allIdentical = allIdentical && result.identical;
+    }
+    return allIdentical ? 0 : 1;
+  }
+
+  if (broadphaseColliders > 0) {
+    auto result = BenchmarkBroadphase(broadphaseColliders, benchmarkTicks);
+    std::cout << std::fixed << std::setprecision(3)
+              << broadphaseColliders << " colliders: broadphase " << result.broadphaseMillis << " ms/tick ("
+              << std::setprecision(0) << 1000 / result.broadphaseMillis << " ticks/s over " << result.ticks << " ticks, "
+              << std::setprecision(1) << result.averageCandidates << " candidates per query), every collider "
+              << std::setprecision(3) << result.bruteForceMillis << " ms/tick (" << result.bruteForceTicks << " ticks), "
+              << (result.identical ? "identical collisions" : "MISMATCH") << std::endl;
+    std::cout << result.candidatePairs << " candidate pairs in " << result.candidatePairsMillis << " ms" << std::endl;
+    return result.identical ? 0 : 1;
+  }
+
+  if (narrowphasePairs > 0) {
+    auto result = BenchmarkNarrowphase(narrowphasePairs);
+    std::cout << result.pairs << " pairs, " << result.overlapping << " overlapping" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "separating axes: " << result.separatingAxisNanos << " ns/pair, " << result.separatingAxisHits << " hits, "
+              << result.separatingAxisWrong << " wrong, " << result.invalidContacts << " invalid contacts" << std::endl;
+    std::cout << "8 points:        " << result.pointTestNanos << " ns/pair, " << result.pointTestHits << " hits, "
+              << result.overlapping - result.pointTestHits << " missed" << std::endl;
+    return (result.separatingAxisWrong == 0 && result.invalidContacts == 0) ? 0 : 1;
+  }
+
+  if (sweepDrops > 0) {
+    bool noneTunneled = true;
+    for (auto& result : BenchmarkSweep(sweepDrops)) {
+      std::cout << std::fixed << std::setprecision(3) << result.millisPerTick << " ms ticks:" << std::endl;
+      std::cout << "  discrete: " << result.discreteTunneled << "/" << result.drops << " tunneled, error avg " << result.discreteMeanError
+                << " ms, max " << result.discreteMaxError << " ms, " << std::setprecision(1) << result.discreteNanos << " ns/tick" << std::endl;
+      std::cout << std::setprecision(3) << "  swept:    " << result.sweptTunneled << "/" << result.drops << " tunneled, error avg " << result.sweptMeanError
+                << " ms, max " << result.sweptMaxError << " ms, " << std::setprecision(1) << result.sweptNanos << " ns/tick" << std::endl;
+      noneTunneled = noneTunneled && result.sweptTunneled == 0;
+    }
+    return noneTunneled ? 0 : 1;
+  }
+
+  if (terrainQueries > 0) {
+    bool identical = true;
+    std::cout << "interpolation spacing   height error (avg/max px)   slope error (avg/max)   exact   sampled   batch   slope (ns)" << std::endl;
+    for (auto& result : BenchmarkTerrain(terrainQueries)) {
+      std::cout << std::left << std::setw(14) << (result.interpolation == Terrain::Interpolation::Linear ? "linear" : "cubic") << std::right
+                << std::fixed << std::setprecision(0) << std::setw(7) << result.sampleSpacing
+                << std::scientific << std::setprecision(2) << std::setw(14) << result.meanHeightError << std::setw(10) << result.maxHeightError
+                << std::setw(14) << result.meanSlopeError << std::setw(10) << result.maxSlopeError
+                << std::fixed << std::setprecision(1) << std::setw(8) << result.exactNanos << std::setw(10) << result.sampledNanos
+                << std::setw(8) << result.batchNanos << std::setw(8) << result.slopeNanos
+                << (result.batchIdentical ? "" : "  batch MISMATCH") << std::endl;
+      identical = identical && result.batchIdentical;
+    }
+    return identical ? 0 : 1;
+  }
+
+  if (raycastQueries > 0) {
+    RaycastBenchmarkResult result = BenchmarkRaycast(raycastQueries);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "segments: " << result.segmentHits << "/" << result.segments << " hit, " << result.segmentMismatches << " mismatches, max "
+              << result.segmentMaxDistance << " px before the stepped hit, " << std::setprecision(1) << result.segmentTreeNanos
+              << " ns (min/max tree) vs. " << result.segmentSteppedNanos << " ns (0.25 px steps)" << std::endl;
+    std::cout << std::setprecision(3) << "boxes:    " << result.boxHits << "/" << result.boxes << " hit, " << result.boxMismatches << " mismatches, max "
+              << result.boxMaxDistance << " px before the stepped hit, " << std::setprecision(1) << result.boxTreeNanos
+              << " ns (min/max tree) vs. " << result.boxSteppedNanos << " ns (0.5 px steps)" << std::endl;
+    return (result.segmentMismatches == 0 && result.boxMismatches == 0) ? 0 : 1;
+  }
+
+  if (integratorRepetitions > 0) {
+    bool flown = true;
+    std::cout << "integrator         tick (ms)   position error (m)   velocity error (m/s)   CPU (us per simulated s)" << std::endl;
+    for (auto& result : BenchmarkIntegrators(integratorRepetitions)) {
+      std::cout << std::left << std::setw(19) << IntegratorName(result.integrator) << std::right << std::fixed << std::setprecision(0)
+                << std::setw(9) << result.tickMicros / 1000.0 << std::scientific << std::setprecision(2) << std::setw(21) << result.maxPositionError
+                << std::setw(23) << result.maxVelocityError << std::fixed << std::setprecision(1) << std::setw(27) << result.microsPerSecond
+                << (result.error.empty() ? "" : "  " + result.error) << std::endl;
+      flown = flown && result.error.empty();
+    }
+    return flown ? 0 : 1;
+  }
+
+  if (contactBodies > 0) {
+    // The analytic scenarios have to match their exact result, the warm started bodies have to come to rest without sinking in.
+    // Without warm starting the pile is only shown for comparison.
+    const double MEASURED_TOLERANCE = 0.01;              // relative (at least 0.01 absolute)
+    const double MAX_RESTING_SPEED = 0.05;               // m/s
+    const double MAX_DEPTH = 2 * ContactSolver::SLOP;    // px
+    bool passed = true;
+    std::cout << "scenario              warm start  bodies   measured   expected   resting speed (m/s)   depth (px)   contacts   warm started   us per tick" << std::endl;
+    for (auto& result : BenchmarkContacts(contactBodies)) {
+      bool ok = !result.analytic || std::abs(result.measured - result.expected) <= MEASURED_TOLERANCE * std::max(std::abs(result.expected), 1.0);
+      if (result.warmStarting) {
+        ok = ok && result.maxRestingSpeed <= MAX_RESTING_SPEED && result.maxDepth <= MAX_DEPTH;
+      }
+      passed = passed && ok;
+      std::cout << std::left << std::setw(22) << result.scenario << std::setw(12) << (result.warmStarting ? "on" : "off") << std::right << std::setw(6)
+                << result.bodies << std::fixed << std::setprecision(3);
+      if (result.analytic) {
+        std::cout << std::setw(11) << result.measured << std::setw(11) << result.expected;
+      } else {
+        std::cout << std::setw(11) << "-" << std::setw(11) << "-";
+      }
+      std::cout << std::setw(22) << result.maxRestingSpeed << std::setw(13) << result.maxDepth << std::setprecision(1) << std::setw(11)
+                << result.averageContacts << std::setw(14) << result.warmStartedShare * 100 << "%" << std::setw(13) << result.microsPerTick
+                << (ok ? "" : "  FAIL") << std::defaultfloat << std::endl;
+    }
+    return passed ? 0 : 1;
+  }
+
+  if (streamingChunks > 0) {
+    bool identical = true;
+    std::cout << "speed (px/tick)   ticks   calculated queries   mismatches   cached chunks   generated   evicted   us per tick (avg/max)"
+              << "   us per chunk   seam step (px)   max step (px)" << std::endl;
+    for (auto& result : BenchmarkStreaming(streamingChunks)) {
+      std::cout << std::fixed << std::setprecision(0) << std::setw(15) << result.speed << std::setw(8) << result.ticks << std::setw(12)
+                << result.missingChunkQueries << " / " << std::left << std::setw(8) << result.queries << std::right << std::setw(11) << result.mismatches
+                << std::setw(11) << result.maxCachedChunks << " / " << std::left << std::setw(2) << result.capacity << std::right << std::setw(12)
+                << result.generatedChunks << std::setw(10) << result.evictedChunks << std::setprecision(2) << std::setw(15) << result.averageTickMicros
+                << " / " << std::left << std::setw(8) << result.maxTickMicros << std::right << std::setprecision(1) << std::setw(12) << result.generateMicros
+                << std::setprecision(3) << std::setw(17) << result.maxSeamStep << std::setw(16) << result.maxStep << std::endl;
+      identical = identical && result.mismatches == 0;
+    }
+    return identical ? 0 : 1;
+  }
+
+  if (craterCount > 0) {
+    bool identical = true;
+    std::cout << "terrain    craters   carve (us avg/max)   column mismatches   frame (us before/after/all columns)   segment (ns before/after)"
+              << "   query mismatches   mismatches without craters" << std::endl;
+    for (auto& result : BenchmarkCraters(craterCount)) {
+      std::cout << std::left << std::setw(10) << (result.seed == 0 ? "classic" : "seeded") << std::right << std::setw(8) << result.craters
+                << std::fixed << std::setprecision(2) << std::setw(12) << result.carveMicros << " / " << std::left << std::setw(7)
+                << result.maxCarveMicros << std::right << std::setw(18) << result.columnMismatches << std::setw(18) << result.frameMicrosBefore
+                << " / " << result.frameMicrosAfter << " / " << std::left << std::setw(8) << result.fullFrameMicros << std::right << std::setprecision(1) << std::setw(18)
+                << result.queryNanosBefore << " / " << std::left << std::setw(8) << result.queryNanosAfter << std::right << std::setw(17)
+                << result.queryMismatches << std::setw(29) << result.removeMismatches << std::endl;
+      identical = identical && result.columnMismatches == 0 && result.queryMismatches == 0 && result.removeMismatches == 0;
+    }
+    return identical ? 0 : 1;
+  }
+
+  if (gravityBodies > 0) {
+    // The error of the monopole approximation grows with the square of the opening angle
+    const double RMS_TOLERANCE = 0.02; // times the opening angle squared, relative to the direct sum
+    const double MAX_TOLERANCE = 0.15;
+    bool accurate = true;
+    std::cout << "bodies   opening angle   nodes   interactions per body   ms per pass   forces/s   direct forces/s   speedup   error (rms/max)" << std::endl;
+    for (auto& result : BenchmarkGravity(gravityBodies)) {
+      const double angle2 = static_cast<double>(result.openingAngle) * result.openingAngle;
+      const bool ok = result.rmsError <= RMS_TOLERANCE * angle2 && result.maxError <= MAX_TOLERANCE * angle2;
+      accurate = accurate && ok;
+      std::cout << std::setw(6) << result.bodies << std::fixed << std::setprecision(1) << std::setw(16) << result.openingAngle << std::setw(8)
+                << result.nodes << std::setw(24) << result.interactionsPerBody << std::setprecision(2) << std::setw(14) << result.passMillis
+                << std::scientific << std::setw(11) << result.forcesPerSecond << std::setw(18) << result.directForcesPerSecond << std::fixed
+                << std::setprecision(1) << std::setw(9) << result.forcesPerSecond / result.directForcesPerSecond << "x" << std::scientific
+                << std::setprecision(1) << std::setw(11) << result.rmsError << " / " << result.maxError << (ok ? "" : "  FAIL")
+                << std::defaultfloat << std::endl;
+    }
+    const int fieldBodies = std::max(gravityBodies / 100, 1);
+    auto field = SimulateGravityField(fieldBodies);
+    std::cout << "field: " << field.bodies << " bodies around " << field.wells << " wells for " << field.ticks << " ticks, " << std::fixed
+              << std::setprecision(1) << field.microsPerTick << " us per tick, " << field.averageContacts << " contacts per tick, "
+              << field.boundBodies << " still bound" << std::defaultfloat << std::endl;
+    return accurate ? 0 : 1;
+  }
+
+  if (!exportLevelPath.empty()) {
+    try {
+      ExportLevel(exportLevelPath, levelSize, exportHeights, windSeed);
+    } catch (std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::cout << "wrote " << exportLevelPath << " (" << std::filesystem::file_size(exportLevelPath) << " bytes)" << std::endl;
+    return 0;
+  }
+
+  if (levelOpens > 0) {
+    if (levelPath.empty()) {
+      PrintUsage();
+      return 2;
+    }
+    auto result = BenchmarkLevelFile(levelPath, levelSize, levelOpens);
+    if (!result.error.empty()) {
+      std::cerr << levelPath << ": " << result.error << std::endl;
+      return 1;
+    }
+    std::cout << levelPath << ": " << std::fixed << std::setprecision(2) << result.openMicros << " us per open (" << result.opens
+              << " opens), " << result.buildMicros << " us per level built from it (" << result.builds << " builds)" << std::endl;
+    return 0;
+  }
+
+  if (paths.empty()) {
+    PrintUsage();
+    return 2;
+  }
+
+  std::unique_ptr<LevelFile> levelFile;
+  if (!levelPath.empty()) {
+    try {
+      levelFile = std::make_unique<LevelFile>(levelPath);
+    } catch (std::exception& e) {
+      std::cerr << levelPath << ": " << e.what() << std::endl;
+      return 1;
+    }
+  }
+  const LevelFile& level = levelFile ? *levelFile : LevelFile::BuiltIn();
+
+  if (batch) {
+    std::vector<std::filesystem::path> files;
+    try {
+      for (auto& path : paths) {
+        auto collected = CollectReplays(path);
+        files.insert(files.end(), collected.begin(), collected.end());
+      }
+    } catch (std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = VerifyReplays(files, levelSize, jobs, level);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (outputFile.empty()) {
+      WriteCSV(std::cout, results);
+    } else {
+      std::ofstream out(outputFile);
+      WriteCSV(out, results);
+    }
+    std::cerr << "Verified " << results.size() << " replays in " << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+
+    bool anyError = std::any_of(results.begin(), results.end(), [](const VerificationResult& result) { return !result.error.empty(); });
+    return anyError ? 1 : 0;
+  }
+
+  int exitCode = 0;
+  if (lockstepLanes > 0) {
+    for (auto& file : paths) {
+      auto result = VerifyLockstep(file, levelSize, lockstepLanes, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      bool identical = result.mismatchedTicks == 0;
+      std::cout << file << ": " << (identical ? "bit-identical" : "MISMATCH") << " in " << result.comparedTicks - result.mismatchedTicks
+                << "/" << result.comparedTicks << " flight ticks x " << result.lanes << " lanes"
+                << std::scientific << std::setprecision(2)
+                << ", " << result.laneTicksPerSecond << " lane-ticks/s (" << result.laneTicksPerSecondNoCollisions << " without collisions, "
+                << result.laneTicksPerSecondNoRotation << " " << RocketBatch::KernelName() << " flight kernel)"
+                << std::defaultfloat << std::endl;
+      if (!identical) {
+        exitCode = 1;
+      }
+    }
+    return exitCode;
+  }
+
+  if (windSeed != 0) {
+    for (auto& file : paths) {
+      auto result = VerifyWind(file, levelSize, windSeed, WIND_LANES, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      const LockstepResult& lockstep = result.lockstep;
+      const bool identical = result.deterministic && lockstep.mismatchedTicks == 0;
+      std::cout << file << ": " << (result.deterministic ? "deterministic" : "NOT deterministic") << ", "
+                << (lockstep.mismatchedTicks == 0 ? "bit-identical" : "MISMATCH") << " in " << lockstep.comparedTicks - lockstep.mismatchedTicks
+                << "/" << lockstep.comparedTicks << " flight ticks x " << lockstep.lanes << " lanes, "
+                << OutcomeName(result.calm.state) << " after " << result.calm.ticks << " ticks -> " << OutcomeName(result.windy.state)
+                << " after " << result.windy.ticks << " ticks, " << std::scientific << std::setprecision(2) << result.calmLaneTicksPerSecond
+                << " -> " << lockstep.laneTicksPerSecond << " lane-ticks/s, " << std::fixed << std::setprecision(1) << result.sampleNanos
+                << " ns per sample" << std::defaultfloat << std::endl;
+      if (!identical) {
+        exitCode = 1;
+      }
+    }
+    return exitCode;
+  }
+
+  if (adaptiveTicks > 0) {
+    double fixedMillis = 0, adaptiveMillis = 0;
+    for (auto& file : paths) {
+      auto result = VerifyAdaptive(file, levelSize, adaptiveTicks, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      const bool same = result.fixed.state == result.adaptive.state;
+      std::cout << file << ": " << (same ? "same outcome" : "DIFFERENT outcome") << " (" << OutcomeName(result.adaptive.state) << " after "
+                << result.adaptive.ticks << " ticks in " << result.adaptiveSteps << " steps, " << result.adaptive.ticks - result.fixed.ticks
+                << " ticks apart), final position " << std::fixed << std::setprecision(3)
+                << result.positionError << " px, peak velocity " << result.adaptive.peakVelocity - result.fixed.peakVelocity << " m/s apart, "
+                << result.fixed.simulationMillis << " -> " << result.adaptive.simulationMillis << " ms" << std::defaultfloat << std::endl;
+      fixedMillis += result.fixed.simulationMillis;
+      adaptiveMillis += result.adaptive.simulationMillis;
+      if (!same) {
+        exitCode = 1;
+      }
+    }
+    std::cout << "total " << std::fixed << std::setprecision(3) << fixedMillis << " -> " << adaptiveMillis << " ms ("
+              << std::setprecision(1) << fixedMillis / adaptiveMillis << "x)" << std::defaultfloat << std::endl;
+    return exitCode;
+  }
+
+  if (snapshotSamples > 0) {
+    std::cout << "snapshot size: " << sizeof(Simulation::Snapshot) << " bytes" << std::endl;
+    for (auto& file : paths) {
+      auto result = VerifySnapshots(file, levelSize, snapshotSamples, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      bool identical = result.mismatches == 0;
+      std::cout << file << ": " << (identical ? "deterministic" : "MISMATCH") << " in " << result.checkedSnapshots - result.mismatches
+                << "/" << result.checkedSnapshots << " re-simulations from " << result.snapshots << " snapshots"
+                << std::fixed << std::setprecision(1)
+                << ", take " << result.takeNanos << " ns, restore " << result.restoreNanos << " ns" << std::endl;
+      if (!identical) {
+        exitCode = 1;
+      }
+    }
+    return exitCode;
+  }
+
+  if (seeks > 0) {
+    for (auto& file : paths) {
+      auto result = VerifySeeking(file, levelSize, seeks, keyframeInterval, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      bool identical = result.mismatches == 0;
+      std::cout << file << ": " << (identical ? "exact" : "MISMATCH") << " in " << result.seeks - result.mismatches << "/" << result.seeks
+                << " seeks within " << result.ticks << " ticks" << std::fixed << std::setprecision(3)
+                << ", index built in " << result.indexMillis << " ms, seek avg " << result.averageSeekMicros << " us, max "
+                << result.maxSeekMicros << " us" << std::endl;
+      if (!identical) {
+        exitCode = 1;
+      }
+    }
+    return exitCode;
+  }
+
+  if (threaded) {
+    for (auto& file : paths) {
+      auto result = VerifyThreaded(file, levelSize, replaySpeedExponent, clockType, level);
+      if (!result.error.empty()) {
+        std::cerr << file << ": " << result.error << std::endl;
+        exitCode = 1;
+        continue;
+      }
+
+      std::cout << file << ": " << (result.identical ? "identical" : "MISMATCH") << " after " << result.ticks << " ticks, "
+                << result.frames << " frames in " << std::fixed << std::setprecision(3) << result.seconds << " s";
+      if (clockType != ClockType::REAL) {
+        std::cout << " (" << result.clockSeconds << " s of clock time)";
+      }
+      std::cout << std::endl;
+      if (!result.identical) {
+        exitCode = 1;
+      }
+    }
+    return exitCode;
+  }
+
+  for (auto& file : paths) {
+    auto result = VerifyReplay(file, levelSize, level);
+    if (!result.error.empty()) {
+      std::cerr << file << ": " << result.error << std::endl;
+      exitCode = 1;
+      continue;
+    }
+
+    std::cout << file << ": " << OutcomeName(result.state)
+              << " after " << result.ticks << " ticks (" << std::fixed << std::setprecision(3) << result.ticks * World::SECONDS_PER_TICK << " s)"
+              << ", fuel left " << std::setprecision(1) << result.fuelLeft * 100 << "%"
+              << " [simulated in " << std::setprecision(3) << result.simulationMillis << " ms]" << std::endl;
+  }
+
+  return exitCode;
+}